@@ -2,8 +2,10 @@
 #
 # SPDX-License-Identifier: Apache-2.0
 
+# Compiles SOURCES to OUT_DIR/<name>.spv. With BUNDLE, the SPIR-V files are also packed into that
+# file by the pack_shaders tool (tools/pack_shaders.cpp), which the application loads at startup.
 function(compile_glsl_shaders target)
-  cmake_parse_arguments(ARG "" "OUT_DIR" "SOURCES" ${ARGN})
+  cmake_parse_arguments(ARG "" "OUT_DIR;BUNDLE" "SOURCES" ${ARGN})
   if (NOT ARG_OUT_DIR)
     message(FATAL_ERROR "compile_glsl_shaders requires OUT_DIR")
   endif()
@@ -22,14 +24,27 @@ function(compile_glsl_shaders target)
       COMMAND "${GLSLC}"
         -O
         -I "${CMAKE_CURRENT_SOURCE_DIR}/shaders"
+        -MD -MF "${OUT_SPV}.d"
         -o "${OUT_SPV}"
         "${SHADER}"
       DEPENDS "${SHADER}"
+      DEPFILE "${OUT_SPV}.d"
       VERBATIM
     )
     list(APPEND OUT_SPV_FILES "${OUT_SPV}")
   endforeach()
 
-  add_custom_target(${target}_shaders ALL DEPENDS ${OUT_SPV_FILES})
+  set(OUTPUTS ${OUT_SPV_FILES})
+  if (ARG_BUNDLE)
+    add_custom_command(
+      OUTPUT "${ARG_BUNDLE}"
+      COMMAND pack_shaders "${ARG_BUNDLE}" ${OUT_SPV_FILES}
+      DEPENDS pack_shaders ${OUT_SPV_FILES}
+      VERBATIM
+    )
+    set(OUTPUTS "${ARG_BUNDLE}")
+  endif()
+
+  add_custom_target(${target}_shaders ALL DEPENDS ${OUTPUTS})
   add_dependencies(${target} ${target}_shaders)
 endfunction()
@@ -0,0 +1,278 @@
+# Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Field registry: scans shaders/fields/*.glsl for metadata comments and generates
+#  - OUT_DIR/field_<key><suffix>.frag: fragment shaders whose field_eval() calls only that field,
+#    with its parameters read from FIELD_PARAMS (GpuParams::field_params, or the thumbnail's in the
+#    parameter atlas, see field_interface.glsl); one per entry of _FIELD_SHADER_SUFFIXES,
+#  - OUT_DIR/field_table.inc: the C++ table of fields and parameters (src/app/field_registry.cpp).
+#
+# Metadata lines at the top of a field file:
+#   // @field <UI name>
+#   // @id <n>                                  GpuParams::render1[1] value, ids are 0..N-1
+#   // @call <function>(p, <arg>, ...)          arguments: p, iterations or a parameter name
+#   // @normal <function>(p, <arg>, ...)        optional: gradient of the field at p, same arguments
+#   // @lipschitz <L>                           optional: bound on the distance's slope, default 1
+#   // @bound sphere|box <r>|<function>(<arg>, ...)  optional: origin-centred sphere radius or cube
+#                                                     half-size containing the surface
+#   // @param <name> float <default> <min> <max>
+#   // @param <name> vec3 <x>,<y>,<z> <min> <max>
+# Parameters are packed in declaration order into the 8 floats of GpuParams::field_params.
+# The files are re-scanned whenever one of them changes or a field is added.
+
+set(FIELD_PARAM_SLOTS 8)
+set(_FIELD_LANES x y z w)
+
+# Shader variants generated per field, in FieldShader order (src/app/field_registry.hpp). Each
+# defines its macro before including raymarch.glsl.
+set(_FIELD_SHADER_SUFFIXES "" "_shadow" "_upsample" "_interleave" "_gbuffer" "_deferred" "_atlas" "_gbuffer_stereo")
+set(_FIELD_SHADER_DEFINES "" "RAYMARCH_SHADOW_PASS" "RAYMARCH_SHADOW_UPSAMPLE" "RAYMARCH_INTERLEAVE" "RAYMARCH_GBUFFER"
+    "RAYMARCH_DEFERRED" "RAYMARCH_ATLAS" "RAYMARCH_GBUFFER_STEREO")
+
+# Substitutes the arguments of a @call or @normal line. Reads param_names and expr_<name> of the
+# caller; `iterations` stays the name of the generated function's argument.
+function(_field_call call field_file out_fn out_args out_uses_iterations)
+  if (NOT call MATCHES "^([A-Za-z_][A-Za-z0-9_]*)\\((.*)\\)$")
+    message(FATAL_ERROR "${field_file}: malformed call '${call}'")
+  endif()
+  set(fn "${CMAKE_MATCH_1}")
+  string(REPLACE "," ";" call_args "${CMAKE_MATCH_2}")
+  set(args "")
+  set(uses_iterations false)
+  foreach(arg ${call_args})
+    string(STRIP "${arg}" arg)
+    if (arg STREQUAL "p" OR arg STREQUAL "iterations")
+      list(APPEND args "${arg}")
+      if (arg STREQUAL "iterations")
+        set(uses_iterations true)
+      endif()
+    elseif (arg IN_LIST param_names)
+      list(APPEND args "${expr_${arg}}")
+    else()
+      message(FATAL_ERROR "${field_file}: argument '${arg}' of ${fn} is not p, iterations or a @param")
+    endif()
+  endforeach()
+  list(JOIN args ", " args)
+  set(${out_fn} "${fn}" PARENT_SCOPE)
+  set(${out_args} "${args}" PARENT_SCOPE)
+  set(${out_uses_iterations} ${uses_iterations} PARENT_SCOPE)
+endfunction()
+
+# "8" -> "8.0" so the value is a float literal in GLSL and C++.
+function(_field_float_literal value out_var)
+  if (NOT value MATCHES "[.eE]")
+    set(value "${value}.0")
+  endif()
+  set(${out_var} "${value}" PARENT_SCOPE)
+endfunction()
+
+# GLSL expression reading float `slot` of GpuParams::field_params.
+function(_field_slot_expr slot out_var)
+  math(EXPR vec "${slot} / 4")
+  math(EXPR lane "${slot} % 4")
+  list(GET _FIELD_LANES ${lane} lane_name)
+  set(${out_var} "FIELD_PARAMS[${vec}].${lane_name}" PARENT_SCOPE)
+endfunction()
+
+function(generate_field_registry)
+  cmake_parse_arguments(ARG "" "FIELD_DIR;OUT_DIR;SHADERS_VAR" "" ${ARGN})
+
+  file(GLOB field_files CONFIGURE_DEPENDS "${ARG_FIELD_DIR}/*.glsl")
+  file(MAKE_DIRECTORY "${ARG_OUT_DIR}")
+
+  set(ids "")
+  foreach(field_file ${field_files})
+    get_filename_component(key "${field_file}" NAME_WE)
+    file(STRINGS "${field_file}" meta_lines REGEX "^// @")
+
+    set(name "")
+    set(id "")
+    set(call "")
+    set(normal "")
+    set(lipschitz "1.0")
+    set(bound "")
+    set(params "")
+    foreach(line ${meta_lines})
+      if (line MATCHES "^// @field (.+)$")
+        set(name "${CMAKE_MATCH_1}")
+      elseif (line MATCHES "^// @id ([0-9]+)$")
+        set(id "${CMAKE_MATCH_1}")
+      elseif (line MATCHES "^// @call (.+)$")
+        set(call "${CMAKE_MATCH_1}")
+      elseif (line MATCHES "^// @normal (.+)$")
+        set(normal "${CMAKE_MATCH_1}")
+      elseif (line MATCHES "^// @lipschitz ([0-9.]+)$")
+        _field_float_literal("${CMAKE_MATCH_1}" lipschitz)
+      elseif (line MATCHES "^// @bound (sphere|box) (.+)$")
+        set(bound_kind "${CMAKE_MATCH_1}")
+        set(bound "${CMAKE_MATCH_2}")
+      elseif (line MATCHES "^// @param (.+)$")
+        list(APPEND params "${CMAKE_MATCH_1}")
+      endif()
+    endforeach()
+
+    if (name STREQUAL "" OR id STREQUAL "" OR call STREQUAL "")
+      message(FATAL_ERROR "${field_file}: missing @field, @id or @call metadata")
+    endif()
+    if (id IN_LIST ids)
+      message(FATAL_ERROR "${field_file}: duplicate field @id ${id}")
+    endif()
+    list(APPEND ids ${id})
+
+    # Parameters: slot assignment, GLSL accessors and C++ table rows.
+    set(slot 0)
+    set(param_names "")
+    set(cpp_params "")
+    foreach(param ${params})
+      separate_arguments(parts UNIX_COMMAND "${param}")
+      list(LENGTH parts n)
+      if (NOT n EQUAL 5)
+        message(FATAL_ERROR "${field_file}: expected '@param <name> <type> <default> <min> <max>': ${param}")
+      endif()
+      list(GET parts 0 pname)
+      list(GET parts 1 ptype)
+      list(GET parts 2 pdefault)
+      list(GET parts 3 pmin)
+      list(GET parts 4 pmax)
+      _field_float_literal("${pmin}" pmin)
+      _field_float_literal("${pmax}" pmax)
+
+      if (ptype STREQUAL "float")
+        set(width 1)
+        _field_float_literal("${pdefault}" d0)
+        set(defaults "${d0}f, 0.0f, 0.0f")
+        _field_slot_expr(${slot} expr)
+        set(expr "clamp(${expr}, ${pmin}, ${pmax})")
+        set(cpp_type "FieldParamType::Float")
+      elseif (ptype STREQUAL "vec3")
+        set(width 3)
+        string(REPLACE "," ";" dlist "${pdefault}")
+        set(defaults "")
+        set(lanes "")
+        foreach(i RANGE 2)
+          list(GET dlist ${i} d)
+          _field_float_literal("${d}" d)
+          list(APPEND defaults "${d}f")
+          math(EXPR s "${slot} + ${i}")
+          _field_slot_expr(${s} lane_expr)
+          list(APPEND lanes "${lane_expr}")
+        endforeach()
+        list(JOIN defaults ", " defaults)
+        list(JOIN lanes ", " lanes)
+        set(expr "clamp(vec3(${lanes}), ${pmin}, ${pmax})")
+        set(cpp_type "FieldParamType::Vec3")
+      else()
+        message(FATAL_ERROR "${field_file}: unsupported @param type '${ptype}' (float, vec3)")
+      endif()
+
+      math(EXPR end "${slot} + ${width}")
+      if (end GREATER FIELD_PARAM_SLOTS)
+        message(FATAL_ERROR "${field_file}: parameters need more than ${FIELD_PARAM_SLOTS} floats")
+      endif()
+
+      list(APPEND param_names "${pname}")
+      set(expr_${pname} "${expr}")
+      string(APPEND cpp_params
+             "    {\"${pname}\", ${cpp_type}, ${slot}, {${defaults}}, ${pmin}f, ${pmax}f},\n")
+      set(slot ${end})
+    endforeach()
+
+    _field_call("${call}" "${field_file}" fn args uses_iterations)
+    set(normal_glsl "")
+    set(has_normal false)
+    if (NOT normal STREQUAL "")
+      _field_call("${normal}" "${field_file}" normal_fn normal_args unused)
+      set(has_normal true)
+      set(normal_glsl "
+#define FIELD_HAS_NORMAL 1
+vec3 field_normal(vec3 p) {
+    int iterations = max(U.render1.z, 1);
+    field_evals++;
+    return ${normal_fn}(${normal_args});
+}
+")
+    endif()
+
+    set(bound_glsl "")
+    if (NOT bound STREQUAL "")
+      if (bound MATCHES "^[0-9.]+$")
+        _field_float_literal("${bound}" bound_expr)
+      else()
+        _field_call("${bound}" "${field_file}" bound_fn bound_args unused)
+        set(bound_expr "${bound_fn}(${bound_args})")
+      endif()
+      set(bound_glsl "
+#define FIELD_HAS_BOUND 1
+vec2 field_bound(vec3 ro, vec3 rd) { return bound_${bound_kind}(ro, rd, ${bound_expr}); }
+")
+    endif()
+
+    set(field_${id}_frags "")
+    set(shader_names "")
+    foreach(suffix define IN ZIP_LISTS _FIELD_SHADER_SUFFIXES _FIELD_SHADER_DEFINES)
+      set(frag "${ARG_OUT_DIR}/field_${key}${suffix}.frag")
+      set(define_line "")
+      if (define)
+        set(define_line "#define ${define} 1\n")
+      endif()
+      file(CONFIGURE OUTPUT "${frag}" CONTENT "// Generated by cmake/field_registry.cmake from shaders/fields/${key}.glsl. Do not edit.
+
+#version 460
+${define_line}
+#include \"params.glsl\"
+
+#include \"field_interface.glsl\"
+#include \"fields/${key}.glsl\"
+
+FieldSample field_eval_iterations(vec3 p, int iterations) {
+    field_evals++;
+    return ${fn}(${args});
+}
+
+FieldSample field_eval(vec3 p) { return field_eval_iterations(p, max(U.render1.z, 1)); }
+${normal_glsl}${bound_glsl}
+#include \"raymarch.glsl\"
+" @ONLY)
+      list(APPEND field_${id}_frags "${frag}")
+      list(APPEND shader_names "\"field_${key}${suffix}.frag.spv\"")
+    endforeach()
+    list(JOIN shader_names ", " shader_names)
+
+    set(field_${id}_cpp "    {\"${name}\", \"${key}\", {${shader_names}}, ${uses_iterations}, ${has_normal}, ${lipschitz}f, ")
+    if (cpp_params STREQUAL "")
+      string(APPEND field_${id}_cpp "nullptr, 0},\n")
+      set(field_${id}_params "")
+    else()
+      list(LENGTH params count)
+      string(APPEND field_${id}_cpp "kParams_${key}, ${count}},\n")
+      set(field_${id}_params "static const FieldParamInfo kParams_${key}[] = {\n${cpp_params}};\n\n")
+    endif()
+  endforeach()
+
+  list(LENGTH ids field_count)
+  if (field_count EQUAL 0)
+    message(FATAL_ERROR "No fields in ${ARG_FIELD_DIR}")
+  endif()
+
+  set(frags "")
+  set(params_cpp "")
+  set(table_cpp "")
+  math(EXPR last "${field_count} - 1")
+  foreach(id RANGE ${last})
+    if (NOT DEFINED field_${id}_frags)
+      message(FATAL_ERROR "Field @id values must be 0..${last}; ${id} is missing")
+    endif()
+    list(APPEND frags ${field_${id}_frags})
+    string(APPEND params_cpp "${field_${id}_params}")
+    string(APPEND table_cpp "${field_${id}_cpp}")
+  endforeach()
+
+  file(CONFIGURE OUTPUT "${ARG_OUT_DIR}/field_table.inc" CONTENT "// Generated by cmake/field_registry.cmake from shaders/fields/*.glsl. Do not edit.
+
+${params_cpp}static const FieldInfo kFieldTable[] = {
+${table_cpp}};
+" @ONLY)
+
+  set(${ARG_SHADERS_VAR} ${frags} PARENT_SCOPE)
+endfunction()
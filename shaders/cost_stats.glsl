@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VKF_COST_STATS_GLSL
+#define VKF_COST_STATS_GLSL
+
+// Per-frame cost statistics, mirrored by CostStats::Gpu in src/gfx/cost_stats.hpp.
+// Define COST_STATS_BINDING before including.
+
+const uint STAT_MARCH_STEPS = 0u;
+const uint STAT_FIELD_ITERATIONS = 1u;
+const uint STAT_REFINE_STEPS = 2u;
+const uint STAT_SHADING_EVALS = 3u;
+const uint STAT_COUNTERS = 4u;
+const uint STAT_BUCKETS = 256u;
+
+layout(std430, set = 0, binding = COST_STATS_BINDING) buffer CostStatsBuffer {
+    uint pixels;
+    uint hits; // pixels whose ray hit the surface
+    uint pad0[2];
+    uint max_value[STAT_COUNTERS];
+    // Written by cost_stats.comp from the histograms:
+    uint p50[STAT_COUNTERS];
+    uint p90[STAT_COUNTERS];
+    uint p99[STAT_COUNTERS];
+    float mean[STAT_COUNTERS];
+    uint hist[STAT_COUNTERS * STAT_BUCKETS];
+}
+S;
+
+// Log-linear buckets: 0..15 exact, then 8 buckets per power of two (at most 12.5% wide), so one
+// layout covers march steps as well as fractal iterations summed over a whole ray.
+uint stat_bucket(uint v) {
+    if (v < 16u) {
+        return v;
+    }
+    uint e = uint(findMSB(v)); // >= 4
+    return 16u + (e - 4u) * 8u + ((v >> (e - 3u)) & 7u);
+}
+
+// Smallest value that falls into bucket b.
+uint stat_bucket_value(uint b) {
+    if (b < 16u) {
+        return b;
+    }
+    uint e = (b - 16u) / 8u + 4u;
+    uint m = (b - 16u) % 8u;
+    return (8u + m) << (e - 3u);
+}
+
+// Midpoint of bucket b, for means.
+float stat_bucket_mid(uint b) {
+    if (b < 16u) {
+        return float(b);
+    }
+    uint e = (b - 16u) / 8u + 4u;
+    return float(stat_bucket_value(b)) + 0.5 * float((1u << (e - 3u)) - 1u);
+}
+
+#endif /* VKF_COST_STATS_GLSL */
@@ -12,6 +12,53 @@ struct FieldSample {
     float aux; // optional: trap/iter/density
 };
 
+// Parameters the generated field_eval() reads: the UBO's, or in the parameter atlas those of the
+// fragment's thumbnail, which raymarch.glsl copies here before marching.
+#ifdef RAYMARCH_ATLAS
+vec4 atlas_field_params[2];
+#define FIELD_PARAMS atlas_field_params
+#else
+#define FIELD_PARAMS U.field_params
+#endif
+
 FieldSample field_eval(vec3 p);
+// field_eval() with an explicit iteration count, for probes that tolerate a coarser field.
+FieldSample field_eval_iterations(vec3 p, int iterations);
+
+// Field evaluations (march, refine and shading) and the fractal iterations they ran in this
+// invocation, for the cost statistics.
+int field_evals = 0;
+int field_iterations = 0;
+
+// Ray intervals [x, y] inside the bounding volumes of field_bound(), for a unit rd. x > y when
+// the ray misses the volume.
+vec2 bound_sphere(vec3 ro, vec3 rd, float radius) {
+    float b = dot(ro, rd);
+    float h = b * b - (dot(ro, ro) - radius * radius);
+    if (h < 0.0) {
+        return vec2(1.0, -1.0);
+    }
+    h = sqrt(h);
+    return vec2(-b - h, -b + h);
+}
+
+vec2 bound_box(vec3 ro, vec3 rd, float half_size) {
+    vec3 inv = 1.0 / mix(rd, vec3(1e-20), lessThan(abs(rd), vec3(1e-20)));
+    vec3 t0 = (-half_size - ro) * inv;
+    vec3 t1 = (half_size - ro) * inv;
+    vec3 t_near = min(t0, t1);
+    vec3 t_far = max(t0, t1);
+    return vec2(max(max(t_near.x, t_near.y), t_near.z), min(min(t_far.x, t_far.y), t_far.z));
+}
+
+// Analytic normals carry the Jacobian dz/dp through the iteration and only need its direction.
+// Rescales J before it overflows; `unit` is the factor for identity terms added to it later.
+void jacobian_rescale(inout mat3 J, inout float unit) {
+    float m = max(max(dot(J[0], J[0]), dot(J[1], J[1])), dot(J[2], J[2]));
+    if (m > 1e24) {
+        J *= 1e-12;
+        unit *= 1e-12;
+    }
+}
 
 #endif /* VKF_FIELD_INTERFACE_GLSL */
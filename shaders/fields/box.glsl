@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// @field Box
+// @id 1
+// @call field_box(p)
+// @normal field_box_normal(p)
+// @bound box 1.05
+
+#include "field_interface.glsl"
+
+// Axis-aligned box with half-size 1, for debugging the raymarcher.
+FieldSample field_box(vec3 p) {
+    vec3 q = abs(p) - vec3(1.0);
+    return FieldSample(length(max(q, 0.0)) + min(max(q.x, max(q.y, q.z)), 0.0), 0.0);
+}
+
+// Outside: toward the closest point of the box. Inside: the nearest face.
+vec3 field_box_normal(vec3 p) {
+    vec3 q = abs(p) - vec3(1.0);
+    float m = max(q.x, max(q.y, q.z));
+    if (m > 0.0) {
+        return sign(p) * max(q, 0.0);
+    }
+    return sign(p) * step(vec3(m), q);
+}
@@ -4,7 +4,24 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+// @field Julia
+// @id 4
+// @call field_julia(p, c, iterations, power, bailout)
+// @normal field_julia_normal(p, c, iterations, power, bailout)
+// @bound sphere field_julia_bound(c, power)
+// @lipschitz 1.33
+// @param c vec3 0.3,0.5,-0.2 -2.0 2.0
+// @param power float 8.0 2.0 32.0
+// @param bailout float 32.0 2.0 200.0
+
 #include "field_interface.glsl"
+#include "triplex.glsl"
+
+// Outside max(|c|, 2^(1/(power-1))) every point escapes, as for the Mandelbulb. The margin
+// covers the thicker surface of low iteration counts.
+float field_julia_bound(vec3 c, float power) {
+    return 1.5 * max(length(c), pow(2.0, 1.0 / max(power - 1.0, 1.0)));
+}
 
 // Params:
 //  - p: position
@@ -38,6 +55,7 @@ FieldSample field_julia(vec3 p, vec3 c, int iterations, float power, float bailo
 
         z = zr * vec3(sin(theta_p) * cos(phi_p), sin(theta_p) * sin(phi_p), cos(theta_p)) + c;
     }
+    field_iterations += i;
 
     float r_safe = max(r, 1e-6);
     float dr_safe = max(abs(dr), 1e-6);
@@ -53,3 +71,23 @@ FieldSample field_julia(vec3 p, vec3 c, int iterations, float power, float bailo
 
     return FieldSample(dist, aux);
 }
+
+// Normal of the Julia set: the gradient of |z| after the same iterations as the distance
+// estimator. c is constant, so only the start z = p contributes to dz/dp.
+vec3 field_julia_normal(vec3 p, vec3 c, int iterations, float power, float bailout) {
+    vec3 z = p;
+    mat3 J = mat3(1.0);
+    float unit = 1.0;
+    int i = 0;
+
+    for (i = 0; i < iterations; ++i) {
+        if (length(z) > bailout) {
+            break;
+        }
+        z = triplex_pow_jacobian(z, power, J) + c;
+        jacobian_rescale(J, unit);
+    }
+    field_iterations += i;
+
+    return transpose(J) * (z / max(length(z), 1e-8));
+}
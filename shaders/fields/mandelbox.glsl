@@ -4,8 +4,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+// @field Mandelbox
+// @id 3
+// @call field_mandelbox(p, iterations, bailout)
+// @normal field_mandelbox_normal(p, iterations, bailout)
+// @bound box 1.2
+// @lipschitz 1.33
+// @param bailout float 32.0 2.0 200.0
+
 #include "field_interface.glsl"
 
+// Scale 2 keeps the box within |x| <= 2 * (scale + 1) / (scale - 1) = 6, which globalScale maps
+// to the unit cube (@bound box, with margin).
 float globalScale = 1.0f / 6.0f;
 
 // --- Mandelbox helpers ---
@@ -50,6 +60,8 @@ FieldSample field_mandelbox(vec3 p, int iterations, float bailout) {
     float trap = 1e20; // orbit trap for coloring (min radius)
 
     for (int i = 0; i < iterations; ++i) {
+        field_iterations++;
+
         // Box fold
         z = box_fold(z, foldLimit);
 
@@ -78,3 +90,47 @@ FieldSample field_mandelbox(vec3 p, int iterations, float bailout) {
 
     return FieldSample(d, trap);
 }
+
+// Normal of the Mandelbox: the gradient of |z| after the same iterations as the distance
+// estimator. The folds are piecewise linear, so their Jacobians are exact: -1 on the components
+// the box fold reflects, and the scaling or inversion of the sphere fold.
+vec3 field_mandelbox_normal(vec3 p, int iterations, float bailout) {
+    const float scale = 2.0;
+    const float foldLimit = 1.0;
+    const float minR2 = 0.25;
+    const float fixR2 = 1.0;
+
+    p /= globalScale;
+
+    vec3 z = p;
+    mat3 J = mat3(1.0);
+    float unit = 1.0;
+
+    for (int i = 0; i < iterations; ++i) {
+        field_iterations++;
+
+        vec3 s = mix(vec3(1.0), vec3(-1.0), greaterThan(abs(z), vec3(foldLimit)));
+        J = mat3(s.x, 0.0, 0.0, 0.0, s.y, 0.0, 0.0, 0.0, s.z) * J;
+        z = box_fold(z, foldLimit);
+
+        float r2 = dot(z, z);
+        if (r2 < minR2) {
+            float t = fixR2 / minR2;
+            z *= t;
+            J *= t;
+        } else if (r2 < fixR2) {
+            float t = fixR2 / r2;
+            J = t * (mat3(1.0) - outerProduct(z, z) * (2.0 / r2)) * J;
+            z *= t;
+        }
+
+        z = z * scale + p;
+        J = J * scale + mat3(unit);
+        jacobian_rescale(J, unit);
+
+        if (dot(z, z) > bailout * bailout)
+            break;
+    }
+
+    return transpose(J) * (z / max(length(z), 1e-8));
+}
@@ -4,7 +4,21 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+// @field Mandelbulb
+// @id 2
+// @call field_mandelbulb(p, iterations, power, bailout)
+// @normal field_mandelbulb_normal(p, iterations, power, bailout)
+// @bound sphere field_mandelbulb_bound(power)
+// @lipschitz 1.33
+// @param power float 8.0 2.0 32.0
+// @param bailout float 32.0 2.0 200.0
+
 #include "field_interface.glsl"
+#include "triplex.glsl"
+
+// Outside radius 2^(1/(power-1)) every point escapes: |z|^power - |p| > |z| there. The margin
+// covers the thicker surface of low iteration counts.
+float field_mandelbulb_bound(float power) { return 1.5 * pow(2.0, 1.0 / max(power - 1.0, 1.0)); }
 
 // Mandelbulb distance estimator.
 // Params:
@@ -41,6 +55,7 @@ FieldSample field_mandelbulb(vec3 p, int iterations, float power, float bailout)
 
         z = zr * vec3(sin(theta_p) * cos(phi_p), sin(theta_p) * sin(phi_p), cos(theta_p)) + p;
     }
+    field_iterations += i;
 
     // Robust DE tail
     float r_safe = max(r, 1e-6);
@@ -59,3 +74,24 @@ FieldSample field_mandelbulb(vec3 p, int iterations, float power, float bailout)
 
     return FieldSample(dist, aux);
 }
+
+// Normal of the Mandelbulb: the gradient of |z| after the same iterations as the distance
+// estimator, from the Jacobian dz/dp carried through them.
+vec3 field_mandelbulb_normal(vec3 p, int iterations, float power, float bailout) {
+    vec3 z = p;
+    mat3 J = mat3(1.0);
+    float unit = 1.0;
+    int i = 0;
+
+    for (i = 0; i < iterations; ++i) {
+        if (length(z) > bailout) {
+            break;
+        }
+        z = triplex_pow_jacobian(z, power, J) + p;
+        J += mat3(unit);
+        jacobian_rescale(J, unit);
+    }
+    field_iterations += i;
+
+    return transpose(J) * (z / max(length(z), 1e-8));
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// @field Sphere
+// @id 0
+// @call field_sphere(p)
+// @normal field_sphere_normal(p)
+// @bound sphere 1.05
+
+#include "field_interface.glsl"
+
+// Unit sphere, for debugging the raymarcher.
+FieldSample field_sphere(vec3 p) { return FieldSample(length(p) - 1.0, 0.0); }
+
+vec3 field_sphere_normal(vec3 p) { return p; }
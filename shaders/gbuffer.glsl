@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VKF_GBUFFER_GLSL
+#define VKF_GBUFFER_GLSL
+
+// G-buffer of deferred shading, written by the RAYMARCH_GBUFFER variant of the field shaders and
+// read by their RAYMARCH_DEFERRED variant, one RGBA32_UINT texel per pixel:
+//  x = hit t as float bits, or for a miss -(1 + t) with t where the march stopped,
+//  y = octahedral normal, packSnorm2x16,
+//  z = orbit trap (FieldSample::aux) as float bits,
+//  w = march steps.
+// Integer texels keep the float bits exact; a float attachment could flush or canonicalize them.
+
+struct GBufferSample {
+    bool hit;
+    float t; // hit distance, or where the march of a miss stopped
+    vec3 n;
+    float aux;
+    int steps;
+};
+
+vec2 oct_wrap(vec2 v) { return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0); }
+
+uvec4 gbuffer_encode(bool hit, float t, vec3 n, float aux, int steps) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z) + 1e-20;
+    vec2 e = (n.z >= 0.0) ? n.xy : oct_wrap(n.xy);
+    return uvec4(floatBitsToUint(hit ? t : -1.0 - t), packSnorm2x16(e), floatBitsToUint(aux), uint(steps));
+}
+
+// Distance along the ray before which it has no surface: the hit, or where a miss stopped.
+float gbuffer_stop_t(uvec4 g) {
+    float t = uintBitsToFloat(g.x);
+    return (t >= 0.0) ? t : -1.0 - t;
+}
+
+GBufferSample gbuffer_decode(uvec4 g) {
+    GBufferSample s;
+    s.hit = uintBitsToFloat(g.x) >= 0.0;
+    s.t = gbuffer_stop_t(g);
+    vec2 e = unpackSnorm2x16(g.y);
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = oct_wrap(n.xy);
+    }
+    s.n = normalize(n);
+    s.aux = uintBitsToFloat(g.z);
+    s.steps = int(g.w);
+    return s;
+}
+
+#endif /* VKF_GBUFFER_GLSL */
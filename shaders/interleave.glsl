@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Interleaved rendering: which full-resolution pixels are marched in a frame, and the camera
+// model needed to reproject the others from the previous frame. Shared by the field shaders'
+// RAYMARCH_INTERLEAVE variant, which writes the marched pixels into a compact sample image, and
+// reconstruct.frag, which rebuilds the full frame from it.
+
+#ifndef VKF_INTERLEAVE_GLSL
+#define VKF_INTERLEAVE_GLSL
+
+// Pixel of each 2x2 block marched in phase 0..3 of INTERLEAVE_QUARTER. Consecutive phases are
+// diagonal to each other, so any two frames in a row cover both rows and both columns.
+ivec2 quarter_offset(int phase) {
+    int k = phase & 3;
+    return ivec2((k == 1 || k == 2) ? 1 : 0, (k == 1 || k == 3) ? 1 : 0);
+}
+
+// Full-resolution pixel covered by texel `s` of the sample image.
+ivec2 interleave_pixel(ivec2 s, int mode, int phase) {
+    if (mode == INTERLEAVE_CHECKERBOARD) {
+        return ivec2(2 * s.x + ((s.y + phase) & 1), s.y);
+    }
+    if (mode == INTERLEAVE_QUARTER) {
+        return 2 * s + quarter_offset(phase);
+    }
+    return s;
+}
+
+// Whether full-resolution pixel p is marched this frame, and its texel in the sample image.
+bool interleave_sampled(ivec2 p, int mode, int phase, out ivec2 s) {
+    if (mode == INTERLEAVE_CHECKERBOARD) {
+        s = ivec2(p.x >> 1, p.y);
+        return (p.x & 1) == ((p.y + phase) & 1);
+    }
+    if (mode == INTERLEAVE_QUARTER) {
+        s = p >> 1;
+        return all(equal(p & 1, quarter_offset(phase)));
+    }
+    s = p;
+    return true;
+}
+
+// Orthonormal camera basis, re-orthonormalized like the raymarcher's.
+mat3 camera_basis(vec3 fw, vec3 rt) {
+    fw = normalize(fw);
+    rt = normalize(rt - fw * dot(rt, fw));
+    return mat3(rt, normalize(cross(rt, fw)), fw);
+}
+
+// Primary ray direction through uv (0..1) for a mono camera with the given basis.
+vec3 camera_ray(vec2 uv, mat3 basis, float fov, float aspect) {
+    vec2 xy = uv * 2.0 - 1.0;
+    xy.x *= aspect;
+    return normalize(basis[2] + (xy.x * basis[0] + xy.y * basis[1]) * fov);
+}
+
+// Inverse of camera_ray(): uv of world point q seen from ro, and its distance along the ray.
+// Returns false for points behind the camera.
+bool camera_project(vec3 q, vec3 ro, mat3 basis, float fov, float aspect, out vec2 uv, out float dist) {
+    vec3 d = q - ro;
+    float z = dot(d, basis[2]);
+    if (z <= 1e-6) {
+        return false;
+    }
+    vec2 xy = vec2(dot(d, basis[0]), dot(d, basis[1])) / (z * fov);
+    xy.x /= aspect;
+    uv = xy * 0.5 + 0.5;
+    dist = length(d);
+    return true;
+}
+
+#endif /* VKF_INTERLEAVE_GLSL */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VKF_PARAMS_GLSL
+#define VKF_PARAMS_GLSL
+
+// texelFetch on the half-resolution shadow image and the G-buffer (raymarch.glsl) without a sampler.
+#extension GL_EXT_samplerless_texture_functions : require
+
+// Keep the UBO std140-friendly: use vec4/ivec4 groups. Mirrored by GpuParams in src/app/gpu_params.hpp.
+layout(std140, set = 0, binding = 0) uniform Params {
+    vec4 cam_pos; // xyz: position
+    vec4 cam_fw;  // xyz: forward
+    vec4 cam_rt;  // xyz: right
+    vec4 cam_up;  // xyz: up
+
+    vec4 render0;  // x=max_dist, y=hit_eps, z=normal_eps, w=fov_scale
+    ivec4 render1; // x=max_steps, y=field_id, z=iterations, w=debug_flags (DEBUG_*)
+
+    vec4 field_params[2]; // per-field parameters, layout generated from the field's @param metadata
+    vec4 misc0;           // x=time, y=aspect, z=pixel size (1 / framebuffer height), w unused
+
+    ivec4 render2; // x=stereo_mode (0 = mono, 1 = side-by-side), y,z,w unused
+    vec4 stereo0;  // x=ipd, y=convergence distance (0 = parallel), z,w unused
+
+    ivec4 render3; // x=shadow_mode (SHADOW_*), y=shadow_steps, z=normal_mode (NORMALS_*), w=ao_iterations
+    vec4 shadow0;  // x=penumbra sharpness (k), y=shadow max_dist, z,w unused
+
+    vec4 march0;  // x=Lipschitz bound of the field, y=over-relaxation (1 = off), z=max step, w=LOD aggressiveness
+    ivec4 march1; // x=refine steps cap, y=clip rays to the field's bounding volume (0 = off), z,w unused
+
+    ivec4 interleave0; // x=interleave mode (INTERLEAVE_*), y=phase, z,w=full-resolution width, height
+    vec4 prev_cam_pos; // camera the history image was rendered with, for reprojection
+    vec4 prev_cam_fw;
+    vec4 prev_cam_rt;
+
+    ivec4 vrs0; // x=variable-rate shading (0 = off), y,z=tile size in pixels, w=tiles per row
+    vec4 vrs1;  // x=max normal spread of a 2x2 tile, y=max steps / max_steps of a 2x2 tile, z,w unused
+    ivec4 vrs2; // x=refresh phase, y=refresh period in frames, z,w unused
+
+    vec4 palette0; // rgb: surface colour at orbit trap 0, w unused
+    vec4 palette1; // rgb: surface colour at orbit trap 4 and above, w unused
+
+    ivec4 atlas0; // x,y=parameter atlas columns, rows (0 = off), z,w=thumbnail width, height in pixels
+}
+U;
+
+// render1.w debug flags, mirrored in src/app/gpu_params.hpp.
+const int DEBUG_COST_STATS = 1;    // accumulate per-pixel cost counters into the stats buffer
+const int DEBUG_HEATMAP_SHIFT = 1; // bits 1..3: heatmap overlay, 0 = off, else 1 + STAT_* counter
+const int DEBUG_HEATMAP_MASK = 7;
+const int DEBUG_NORMAL_ERROR = 16; // angle between the analytic and tetrahedral normals
+
+// render3.x shadow modes, mirrored in src/app/gpu_params.hpp.
+const int SHADOW_OFF = 0;
+const int SHADOW_FULL = 1; // one shadow ray per pixel
+const int SHADOW_HALF = 2; // one per 2x2 pixels in a separate pass, upsampled by depth
+
+// render3.z normal modes, mirrored in src/app/gpu_params.hpp.
+const int NORMALS_TETRAHEDRAL = 0; // finite difference, four field evaluations
+const int NORMALS_ANALYTIC = 1;    // the field's gradient (@normal), one evaluation
+
+// interleave0.x modes, mirrored in src/app/gpu_params.hpp.
+const int INTERLEAVE_FULL = 0;         // every pixel
+const int INTERLEAVE_CHECKERBOARD = 1; // half of the pixels, alternating checkerboard
+const int INTERLEAVE_QUARTER = 2;      // one pixel of each 2x2 block, rotating over four frames
+
+#endif /* VKF_PARAMS_GLSL */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Copies an offscreen colour image of the framebuffer's size to the swapchain image.
+
+#version 460
+
+#extension GL_EXT_samplerless_texture_functions : require
+
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 o_color;
+
+layout(set = 0, binding = 5) uniform texture2D image;
+
+void main() { o_color = vec4(texelFetch(image, ivec2(gl_FragCoord.xy), 0).rgb, 1.0); }
@@ -0,0 +1,680 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Raymarcher and shading shared by every field shader. Included last by the fragment shaders that
+// cmake/field_registry.cmake generates, after params.glsl, the field's field_eval() and, when it has
+// one, its field_normal() (FIELD_HAS_NORMAL).
+//
+// Variants, selected by a define in the generated shader:
+//  - none: march and shade; shadows off or traced per pixel (SHADOW_FULL),
+//  - RAYMARCH_SHADOW_PASS: half-resolution pass writing (hit t, shadow) for SHADOW_HALF,
+//  - RAYMARCH_SHADOW_UPSAMPLE: march and shade, shadows upsampled from that pass,
+//  - RAYMARCH_INTERLEAVE: march and shade this frame's share of the pixels (interleave.glsl) into
+//    a compact sample image, alpha = hit t (< 0: miss); shadows are traced per pixel,
+//  - RAYMARCH_GBUFFER: march only, writing hit t, normal, orbit trap and steps (gbuffer.glsl),
+//  - RAYMARCH_GBUFFER_STEREO: RAYMARCH_GBUFFER for side-by-side stereo after a pass that marched
+//    the left eye into stereo_left: copies the left eye and warm-starts the right eye from it,
+//  - RAYMARCH_DEFERRED: shade from that G-buffer without marching; shadows are traced per pixel,
+//  - RAYMARCH_ATLAS: march and shade a grid of thumbnails, each with its own field parameters;
+//    shadows are traced per pixel.
+// The full-resolution marching variants (none, RAYMARCH_SHADOW_UPSAMPLE, RAYMARCH_GBUFFER) also
+// collect the tile statistics that the next frame's shading rate image is built from
+// (tile_stats.glsl).
+
+#ifndef VKF_RAYMARCH_GLSL
+#define VKF_RAYMARCH_GLSL
+
+#ifdef RAYMARCH_GBUFFER_STEREO
+#define RAYMARCH_GBUFFER 1
+#endif
+
+#define COST_STATS_BINDING 1
+#include "cost_stats.glsl"
+
+layout(location = 0) in vec2 v_uv;
+#ifdef RAYMARCH_GBUFFER
+layout(location = 0) out uvec4 o_gbuffer;
+#else
+layout(location = 0) out vec4 o_color;
+#endif
+
+#ifdef RAYMARCH_INTERLEAVE
+#include "interleave.glsl"
+#endif
+
+#if defined(RAYMARCH_GBUFFER) || defined(RAYMARCH_DEFERRED)
+#include "gbuffer.glsl"
+#endif
+
+#ifdef RAYMARCH_DEFERRED
+layout(set = 0, binding = 6) uniform utexture2D gbuffer;
+#endif
+
+#ifdef RAYMARCH_GBUFFER_STEREO
+// The left eye's G-buffer, full framebuffer size with only the left half written. Interleaved
+// rendering, the binding's other user, is off in stereo.
+layout(set = 0, binding = 3) uniform utexture2D stereo_left;
+#endif
+
+#ifdef RAYMARCH_ATLAS
+// Field parameters of every thumbnail, row-major from the top left; mirrors ParamAtlas::Tile.
+layout(std430, set = 0, binding = 9) readonly buffer AtlasBuffer {
+    vec4 field_params[]; // 2 per thumbnail
+}
+A;
+#endif
+
+#if !defined(RAYMARCH_SHADOW_PASS) && !defined(RAYMARCH_INTERLEAVE) && !defined(RAYMARCH_DEFERRED) &&                  \
+    !defined(RAYMARCH_ATLAS)
+#define RAYMARCH_TILE_STATS
+#define TILE_STATS_BINDING 7
+#include "tile_stats.glsl"
+#endif
+
+#ifdef RAYMARCH_SHADOW_UPSAMPLE
+layout(set = 0, binding = 2) uniform texture2D half_shadow; // x = hit t (< 0: miss), y = shadow
+#endif
+
+const vec3 LIGHT_DIR = vec3(0.5414, 0.6316, 0.1805); // normalize(0.6, 0.7, 0.2)
+const float AO_STEP = 0.02;
+const int SHADOW_STEPS_CAP = 256;
+const int REFINE_STEPS_CAP = 64;
+const float LOD_MIN_ITERATIONS = 4.0;
+const float LOD_BLEND = 0.25; // fraction of each iteration step over which two counts are blended
+const float NORMAL_ERROR_DEGREES = 10.0; // drawn as full red by DEBUG_NORMAL_ERROR
+
+vec3 tetrahedral_normal(vec3 p, float t) {
+    float e0 = max(U.render0.z, 1e-5);
+    float e = max(e0, 5e-4 * t);
+
+    vec2 k = vec2(1.0, -1.0);
+    float d1 = field_eval(p + k.xyy * e).d;
+    float d2 = field_eval(p + k.yyx * e).d;
+    float d3 = field_eval(p + k.yxy * e).d;
+    float d4 = field_eval(p + k.xxx * e).d;
+
+    vec3 n = k.xyy * d1 + k.yyx * d2 + k.yxy * d3 + k.xxx * d4;
+    return normalize(n);
+}
+
+// Level of detail for the primary ray: detail below the pixel footprint is invisible, so beyond
+// the distance where a pixel covers hit_eps the fractal iterations drop by march0.w per doubling
+// of the footprint. Returns a fractional count for field_eval_lod().
+float lod_iterations(float t, float pixel_angle, float hit_eps) {
+    float full = float(max(U.render1.z, 1));
+    float drop = max(U.march0.w, 0.0) * log2(max(t * pixel_angle / hit_eps, 1.0));
+    return max(full - drop, min(full, LOD_MIN_ITERATIONS));
+}
+
+// Second evaluations of field_eval_lod(), kept out of the shading counter.
+int lod_blend_evals = 0;
+
+// Field sample at a fractional iteration count. Over the last LOD_BLEND of each step between two
+// counts both are evaluated and their distances blended, so as the camera moves surfaces morph
+// from one count to the next instead of popping at a fixed distance.
+FieldSample field_eval_lod(vec3 p, float iterations) {
+    float n0 = floor(iterations);
+    float blend = smoothstep(1.0 - LOD_BLEND, 1.0, iterations - n0);
+    FieldSample s = field_eval_iterations(p, int(n0));
+    if (blend > 0.0) {
+        FieldSample s1 = field_eval_iterations(p, int(n0) + 1);
+        lod_blend_evals++;
+        s.d = mix(s.d, s1.d, blend);
+        s.aux = mix(s.aux, s1.aux, blend);
+    }
+    return s;
+}
+
+#ifdef FIELD_HAS_NORMAL
+// False where the gradient vanishes or overflows (e.g. deep inside the set).
+bool analytic_normal(vec3 p, out vec3 n) {
+    vec3 g = field_normal(p);
+    float g2 = dot(g, g);
+    n = g * inversesqrt(max(g2, 1e-30));
+    return g2 > 1e-30 && !isinf(g2);
+}
+#endif
+
+// One field evaluation with NORMALS_ANALYTIC when the field has a gradient, else four.
+vec3 estimate_normal(vec3 p, float t) {
+#ifdef FIELD_HAS_NORMAL
+    vec3 n;
+    if (U.render3.z == NORMALS_ANALYTIC && analytic_normal(p, n)) {
+        return n;
+    }
+#endif
+    return tetrahedral_normal(p, t);
+}
+
+// d_first: field distance at p + n * AO_STEP, reused as the first step of the shadow ray.
+// The probes run at most render3.w iterations: a few hundredths off the surface the coarser field
+// is close enough. Its set contains the full one, so d_first never overshoots as a shadow step.
+float ambient_occlusion(vec3 p, vec3 n, out float d_first) {
+    float occ = 0.0;
+    float sca = 1.0;
+    d_first = -1.0;
+
+    int iterations = max(U.render1.z, 1);
+    if (U.render3.w > 0) {
+        iterations = min(iterations, U.render3.w);
+    }
+
+    for (int i = 1; i <= 5; ++i) {
+        float h = AO_STEP * float(i);
+        float d = field_eval_iterations(p + n * h, iterations).d;
+        if (i == 1) {
+            d_first = d;
+        }
+        occ += (h - d) * sca;
+        sca *= 0.6;
+    }
+    return clamp(1.0 - 2.0 * occ, 0.0, 1.0);
+}
+
+// Soft shadow along l from ro, with the penumbra estimate that uses the previous step's distance
+// to find the closest approach between samples. h0 >= 0 is the already known field distance at
+// ro and saves the first evaluation. The march stops once the ray is fully occluded, when it
+// leaves the shadow distance or the field's bounding volume, or after its step budget; the budget
+// bounds the cost per pixel.
+float soft_shadow(vec3 ro, vec3 l, float h0) {
+    float k = max(U.shadow0.x, 1.0);
+    float t_max = max(U.shadow0.y, 0.0);
+    int budget = clamp(U.render3.y, 1, SHADOW_STEPS_CAP);
+#ifdef FIELD_HAS_BOUND
+    if (U.march1.y != 0) {
+        t_max = min(t_max, field_bound(ro, l).y);
+    }
+#endif
+
+    float res = 1.0;
+    float t = 0.0;
+    float h_prev = 1e20;
+    for (int i = 0; i < SHADOW_STEPS_CAP; i++) {
+        if (i >= budget || t > t_max) {
+            break;
+        }
+        float h = (i == 0 && h0 >= 0.0) ? h0 : field_eval(ro + l * t).d;
+        if (isnan(h)) {
+            h = 0.0;
+        }
+
+        float y = h * h / (2.0 * h_prev);
+        float d = sqrt(max(h * h - y * y, 0.0));
+        res = min(res, k * d / max(t - y, 1e-4));
+        if (res < 0.01) {
+            return 0.0;
+        }
+        h_prev = h;
+        t += clamp(h, 1e-3, 0.5);
+    }
+    return smoothstep(0.0, 1.0, res);
+}
+
+#ifdef RAYMARCH_SHADOW_UPSAMPLE
+// Joint bilateral upsampling of the half-resolution shadows: the four nearest half-resolution
+// samples are weighted bilinearly and by how close their hit distance is to this pixel's, so
+// shadows do not bleed across silhouettes. Pixels with no sample on their surface (thin features,
+// edges) trace their own ray.
+float upsampled_shadow(float t, vec3 ro, vec3 l, float h0) {
+    ivec2 size = textureSize(half_shadow, 0);
+    vec2 hp = gl_FragCoord.xy * 0.5 - 0.5;
+    ivec2 base = ivec2(floor(hp));
+    vec2 f = hp - vec2(base);
+
+    float sum = 0.0;
+    float wsum = 0.0;
+    for (int j = 0; j < 4; j++) {
+        ivec2 o = ivec2(j & 1, j >> 1);
+        vec2 s = texelFetch(half_shadow, clamp(base + o, ivec2(0), size - 1), 0).xy;
+        if (s.x < 0.0) {
+            continue;
+        }
+        vec2 wb2 = mix(1.0 - f, f, vec2(o));
+        float wb = max(wb2.x * wb2.y, 1e-3);
+        float wd = exp(-abs(s.x - t) / (0.02 * t + 1e-4));
+        sum += s.y * wb * wd;
+        wsum += wb * wd;
+    }
+    if (wsum < 0.05) {
+        return soft_shadow(ro, l, h0);
+    }
+    return sum / wsum;
+}
+#endif
+
+#ifdef RAYMARCH_GBUFFER_STEREO
+const int STEREO_WARM_MAX_TEXELS = 64;
+
+// Left-eye column (fractional pixel index) through which the left eye sees p, or -1e9 behind it.
+// Inverts the ray setup of main(), including the off-axis shear of a convergence distance.
+float stereo_left_column(vec3 p, vec3 ro_left, vec3 fw, vec3 rt, float fov, float eye_aspect, float width) {
+    vec3 v = p - ro_left;
+    float z = dot(v, fw);
+    if (z <= 0.0) {
+        return -1e9;
+    }
+    float x = dot(v, rt) / (z * fov);
+    if (U.stereo0.y > 0.0) {
+        x -= 0.5 * U.stereo0.x / (fov * U.stereo0.y);
+    }
+    float eye_u = (x / eye_aspect + 1.0) * 0.5;
+    return eye_u * 0.5 * width - 0.5;
+}
+
+// Where the march of the right-eye ray (ro, rd) may start, from the left eye in stereo_left.
+// A surface point at distance t on this ray is at most t + IPD from the left eye, on the left-eye
+// ray of the same row through the column it projects to, and that ray stopped no later than at
+// the point. So no surface lies closer than the smallest stop distance over those columns minus
+// the IPD. The columns are bounded on the near side by the sphere the distance estimate clears
+// around the eye. Returns 0 when they leave the left eye's image or span more than
+// STEREO_WARM_MAX_TEXELS.
+float stereo_warm_start(vec3 ro, vec3 rd, vec3 fw, vec3 rt, float fov, float eye_aspect, float t_end) {
+    float ipd = max(U.stereo0.x, 0.0);
+    float d0 = field_eval(ro).d;
+    float t_near = isnan(d0) ? 0.0 : max(d0, 0.0) / max(U.march0.x, 0.25);
+    if (t_near <= 0.0 || t_end <= t_near) {
+        return 0.0;
+    }
+
+    ivec2 size = textureSize(stereo_left, 0);
+    vec3 ro_left = ro - rt * ipd;
+    float c0 = stereo_left_column(ro + rd * t_near, ro_left, fw, rt, fov, eye_aspect, float(size.x));
+    float c1 = stereo_left_column(ro + rd * t_end, ro_left, fw, rt, fov, eye_aspect, float(size.x));
+    // One column of margin on each side: the left-eye rays pass through pixel centres.
+    int lo = int(floor(min(c0, c1))) - 1;
+    int hi = int(ceil(max(c0, c1))) + 1;
+    if (lo < 0 || hi >= size.x / 2 || hi - lo >= STEREO_WARM_MAX_TEXELS) {
+        return 0.0;
+    }
+
+    int y = int(gl_FragCoord.y);
+    float t_min = t_end;
+    for (int c = lo; c <= hi; c++) {
+        t_min = min(t_min, gbuffer_stop_t(texelFetch(stereo_left, ivec2(c, y), 0)));
+    }
+    // The hit tolerance grows with distance; keep that much short of the bound as well.
+    return max(t_min - ipd - max(U.render0.y, 1e-3 * t_min), 0.0);
+}
+#endif
+
+// Blue (cheap) to red (expensive) ramp for the heatmap overlay.
+vec3 heat_color(float h) {
+    h = clamp(h, 0.0, 1.0);
+    return clamp(vec3(1.5 - abs(4.0 * h - 3.0), 1.5 - abs(4.0 * h - 2.0), 1.5 - abs(4.0 * h - 1.0)), 0.0, 1.0);
+}
+
+// Adds this pixel's counters to the frame statistics and, when a heatmap is selected, overlays the
+// selected counter on col (log scale, `scale` = value drawn as full red).
+vec3 apply_cost_debug(vec3 col, bool hit, uint counters[STAT_COUNTERS], uint scale[STAT_COUNTERS]) {
+    int flags = U.render1.w;
+
+    if ((flags & DEBUG_COST_STATS) != 0) {
+        atomicAdd(S.pixels, 1u);
+        if (hit) {
+            atomicAdd(S.hits, 1u);
+        }
+        for (uint c = 0u; c < STAT_COUNTERS; c++) {
+            atomicMax(S.max_value[c], counters[c]);
+            atomicAdd(S.hist[c * STAT_BUCKETS + stat_bucket(counters[c])], 1u);
+        }
+    }
+
+    int heat = (flags >> DEBUG_HEATMAP_SHIFT) & DEBUG_HEATMAP_MASK;
+    if (heat > 0 && uint(heat) <= STAT_COUNTERS) {
+        uint c = uint(heat - 1);
+        float h = log2(1.0 + float(counters[c])) / log2(1.0 + float(max(scale[c], 1u)));
+        col = mix(col, heat_color(h), 0.8);
+    }
+    return col;
+}
+
+void main() {
+    // Always-visible background
+#ifdef RAYMARCH_INTERLEAVE
+    // The target holds only the pixels marched this frame; each shades its full-resolution pixel.
+    ivec2 full_px = interleave_pixel(ivec2(gl_FragCoord.xy), U.interleave0.x, U.interleave0.y);
+    vec2 uv01 = (vec2(full_px) + 0.5) / vec2(max(U.interleave0.zw, ivec2(1)));
+#elif defined(RAYMARCH_ATLAS)
+    // Each thumbnail is a small frame of its own, marched with its tile's field parameters.
+    ivec2 thumb_size = max(U.atlas0.zw, ivec2(1));
+    ivec2 thumb = ivec2(gl_FragCoord.xy) / thumb_size;
+    if (any(greaterThanEqual(thumb, U.atlas0.xy))) {
+        o_color = vec4(0.0, 0.0, 0.0, 1.0); // framebuffer beyond the last full thumbnail
+        return;
+    }
+    int thumb_index = thumb.y * U.atlas0.x + thumb.x;
+    atlas_field_params[0] = A.field_params[2 * thumb_index];
+    atlas_field_params[1] = A.field_params[2 * thumb_index + 1];
+    ivec2 thumb_px = ivec2(gl_FragCoord.xy) - thumb * thumb_size;
+    vec2 uv01 = (vec2(thumb_px) + 0.5) / vec2(thumb_size);
+#else
+    vec2 uv01 = v_uv; // should already be 0..1
+#endif
+
+    // Side-by-side stereo: left half of the framebuffer is the left eye, right half the right eye.
+    // Each eye gets its own 0..1 uv range and half of the horizontal aspect.
+#ifdef RAYMARCH_ATLAS
+    bool stereo = false; // thumbnails are mono
+#else
+    bool stereo = U.render2.x == 1;
+#endif
+    float eye = 0.0; // -1 = left, +1 = right, 0 = mono
+    vec2 eye_uv = uv01;
+    if (stereo) {
+        eye = (uv01.x < 0.5) ? -1.0 : 1.0;
+        eye_uv.x = fract(uv01.x * 2.0);
+    }
+
+#ifdef RAYMARCH_GBUFFER_STEREO
+    // The previous pass marched the left eye; it is only copied.
+    if (eye < 0.0) {
+        o_gbuffer = texelFetch(stereo_left, ivec2(gl_FragCoord.xy), 0);
+        return;
+    }
+#endif
+
+    vec2 xy = eye_uv * 2.0 - 1.0; // -1..1
+
+    // Background gradient
+    vec3 bg = vec3(0.08 + 0.35 * eye_uv.x, 0.08 + 0.35 * eye_uv.y, 0.20);
+
+    // If UBO is clearly broken, show bright red
+    if (any(isnan(U.cam_pos)) || any(isnan(U.cam_fw)) || U.render1.x <= 0) {
+#ifdef RAYMARCH_GBUFFER
+        o_gbuffer = gbuffer_encode(false, 0.0, vec3(0.0, 0.0, 1.0), 0.0, 0);
+#else
+        o_color = vec4(1.0, 0.0, 0.0, 1.0);
+#endif
+        return;
+    }
+
+    // Aspect correction (expects CPU to write aspect = width/height into misc0.y)
+    float aspect = (U.misc0.y > 0.0) ? U.misc0.y : 1.0;
+#ifdef RAYMARCH_ATLAS
+    aspect = float(thumb_size.x) / float(thumb_size.y);
+#endif
+    if (stereo) {
+        aspect *= 0.5;
+    }
+    xy.x *= aspect;
+
+    vec3 ro = U.cam_pos.xyz;
+
+    // Use basis from CPU (supports roll)
+    vec3 fw = U.cam_fw.xyz;
+    vec3 rt = U.cam_rt.xyz;
+    vec3 up = U.cam_up.xyz;
+
+    // Normalize
+    fw = normalize(fw);
+    rt = normalize(rt);
+    up = normalize(up);
+
+    // Optional: re-orthonormalize to fight drift if CPU basis isn’t perfect
+    // (Keeps rt perpendicular to fw, then recompute up)
+    rt = normalize(rt - fw * dot(rt, fw));
+    up = normalize(cross(rt, fw));
+
+    float fov = (U.render0.w > 0.0) ? U.render0.w : 1.2; // default if unset
+
+    vec3 rd = normalize(fw + xy.x * rt * fov + xy.y * up * fov);
+
+    if (stereo) {
+        // Eyes are offset along the camera's right axis by half the IPD. With a convergence distance
+        // the frusta are sheared (off-axis) so both eyes agree on the plane at that distance,
+        // otherwise the eyes look parallel.
+        vec3 eye_offset = rt * (0.5 * U.stereo0.x * eye);
+        float conv = U.stereo0.y;
+        if (conv > 0.0) {
+            vec3 p_conv = ro + rd * (conv / max(dot(rd, fw), 1e-4));
+            ro += eye_offset;
+            rd = normalize(p_conv - ro);
+        } else {
+            ro += eye_offset;
+        }
+    }
+
+#ifdef RAYMARCH_DEFERRED
+    // The march pass left everything shading needs in the G-buffer.
+    GBufferSample g = gbuffer_decode(texelFetch(gbuffer, ivec2(gl_FragCoord.xy), 0));
+    bool hit = g.hit;
+    float t = g.t;
+    float aux = g.aux;
+    int steps = g.steps;
+#else
+    float max_dist = max(U.render0.x, 0.01);
+    float hit_eps = max(U.render0.y, 1e-6);
+
+    int max_steps_u = U.render1.x;
+    const int MAX_STEPS_CAP = 2048;
+
+    // Over-relaxed sphere tracing: the field distance divided by the field's Lipschitz bound is a
+    // radius the ray can safely advance, and each step goes omega times further. A step that
+    // overshot is detected when the spheres at both ends no longer overlap; the ray then goes
+    // back to the safe step and continues without relaxation.
+    float lipschitz = max(U.march0.x, 0.25);
+    float omega = clamp(U.march0.y, 1.0, 1.95);
+    float max_step = max(U.march0.z, 1e-3);
+
+    // Angle covered by one pixel, so the hit refinement stops at the pixel footprint.
+    float pixel_angle = 2.0 * fov * max(U.misc0.z, 1e-5);
+#ifdef RAYMARCH_ATLAS
+    // Thumbnail pixels are larger, so refinement and level of detail stop earlier.
+    pixel_angle = 2.0 * fov / float(thumb_size.y);
+#endif
+    int refine_cap = clamp(U.march1.x, 0, REFINE_STEPS_CAP);
+
+    float t = 0.0;
+    float t_end = max_dist;
+#ifdef FIELD_HAS_BOUND
+    // Only the part of the ray inside the field's bounding volume is marched; rays that miss it
+    // cost the intersection test alone.
+    if (U.march1.y != 0) {
+        vec2 span = field_bound(ro, rd);
+        t = max(span.x, 0.0);
+        t_end = min(t_end, span.y);
+    }
+#endif
+#ifdef RAYMARCH_GBUFFER_STEREO
+    if (eye > 0.0) {
+        t = max(t, stereo_warm_start(ro, rd, fw, rt, fov, aspect, t_end));
+    }
+#endif
+
+    float t_prev = t;
+    float f_prev = 0.0; // d - eps at t_prev
+    float r_prev = 0.0;
+    float step = 0.0;
+    bool hit = false;
+    float aux = 0.0;
+    int steps = 0;
+    int refine_steps = 0;
+
+    for (int i = 0; i < MAX_STEPS_CAP; i++) {
+        if (i >= max_steps_u || t > t_end) {
+            break;
+        }
+        steps++;
+
+        vec3 p = ro + t * rd;
+        FieldSample s = field_eval_lod(p, lod_iterations(t, pixel_angle, hit_eps));
+        aux = s.aux;
+
+        float d = s.d;
+        if (isnan(d))
+            d = 1e-3;
+
+        float r = d / lipschitz;
+        if (omega > 1.0 && abs(r) + r_prev < step) {
+            t = t_prev + r_prev;
+            step = r_prev;
+            omega = 1.0;
+            continue;
+        }
+
+        float eps = max(hit_eps, 1e-3 * t); // grows with distance
+        if (d < eps) {
+            // Regula falsi (Illinois variant) on d - eps between the last sample outside (lo) and
+            // this one (hi). It stops once the bracket is narrower than a pixel at that distance.
+            float lo = t_prev;
+            float hi = t;
+            float f_lo = f_prev;
+            float f_hi = d - eps;
+            int side = 0;
+            for (int j = 0; j < REFINE_STEPS_CAP; ++j) {
+                if (j >= refine_cap || hi - lo <= pixel_angle * hi) {
+                    break;
+                }
+                refine_steps++;
+
+                float w = hi - lo;
+                float mid = clamp((lo * f_hi - hi * f_lo) / (f_hi - f_lo), lo + 0.01 * w, hi - 0.01 * w);
+                float dm = field_eval_lod(ro + mid * rd, lod_iterations(mid, pixel_angle, hit_eps)).d;
+                float fm = (isnan(dm) ? 0.0 : dm) - max(hit_eps, 1e-3 * mid);
+                if (fm < 0.0) {
+                    hi = mid;
+                    f_hi = fm;
+                    if (side == -1) {
+                        f_lo *= 0.5;
+                    }
+                    side = -1;
+                } else {
+                    lo = mid;
+                    f_lo = fm;
+                    if (side == 1) {
+                        f_hi *= 0.5;
+                    }
+                    side = 1;
+                }
+            }
+            t = hi;
+            hit = true;
+            break;
+        }
+
+        t_prev = t;
+        f_prev = d - eps;
+        r_prev = r;
+
+        // Clamp step to avoid stalls / negative weirdness
+        step = clamp(r * omega, 1e-5, max_step);
+        t += step;
+    }
+#endif
+
+#ifdef RAYMARCH_SHADOW_PASS
+    // Only the hit distance (for the depth-aware upsampling) and the shadow are needed here.
+    vec2 shadow_out = vec2(-1.0, 1.0);
+    if (hit) {
+        vec3 p = ro + t * rd;
+        vec3 n = estimate_normal(p, t);
+        float shadow = 1.0;
+        if (dot(n, LIGHT_DIR) > 0.0) {
+            shadow = soft_shadow(p + n * AO_STEP, LIGHT_DIR, -1.0);
+        }
+        shadow_out = vec2(t, shadow);
+    }
+    o_color = vec4(shadow_out, 0.0, 1.0);
+#elif defined(RAYMARCH_GBUFFER)
+    // Shading, and so the colour, is left to the RAYMARCH_DEFERRED pass.
+    vec3 n = vec3(0.0, 0.0, 1.0);
+    if (hit) {
+        n = estimate_normal(ro + t * rd, t);
+    }
+    if (U.vrs0.x != 0) {
+        tile_stats_add(ivec2(gl_FragCoord.xy), hit, steps, n);
+    }
+    o_gbuffer = gbuffer_encode(hit, t, n, aux, steps);
+#else
+    vec3 col = bg;
+    vec3 n = vec3(0.0);
+    if (hit) {
+        vec3 p = ro + t * rd;
+#ifdef RAYMARCH_DEFERRED
+        n = g.n;
+#else
+        n = estimate_normal(p, t);
+#endif
+
+        float ndotl = max(dot(n, LIGHT_DIR), 0.0);
+
+        float c = clamp(aux * 0.25, 0.0, 1.0);
+
+        vec3 base = mix(U.palette0.rgb, U.palette1.rgb, c);
+
+        float d_first;
+        float ao = ambient_occlusion(p, n, d_first);
+
+        // Surfaces facing away from the light get no direct light to shadow.
+        float shadow = 1.0;
+        if (ndotl > 0.0) {
+#if defined(RAYMARCH_SHADOW_UPSAMPLE)
+            shadow = upsampled_shadow(t, p + n * AO_STEP, LIGHT_DIR, d_first);
+#elif defined(RAYMARCH_INTERLEAVE) || defined(RAYMARCH_DEFERRED) || defined(RAYMARCH_ATLAS)
+            if (U.render3.x != SHADOW_OFF) {
+                shadow = soft_shadow(p + n * AO_STEP, LIGHT_DIR, d_first);
+            }
+#else
+            if (U.render3.x == SHADOW_FULL) {
+                shadow = soft_shadow(p + n * AO_STEP, LIGHT_DIR, d_first);
+            }
+#endif
+        }
+        col = base * (0.10 + 0.90 * ndotl * shadow) * ao;
+    }
+
+#ifdef RAYMARCH_DEFERRED
+    // The G-buffer keeps only the march steps; the app renders the other debug views forward.
+    if (((U.render1.w >> DEBUG_HEATMAP_SHIFT) & DEBUG_HEATMAP_MASK) == 1 + int(STAT_MARCH_STEPS)) {
+        float h = log2(1.0 + float(steps)) / log2(1.0 + float(max(U.render1.x, 1)));
+        col = mix(col, heat_color(h), 0.8);
+    }
+#else
+    if (U.render1.w != 0) {
+        uint iters = uint(max(U.render1.z, 1));
+        uint shading_scale = 9u + ((U.render3.x != SHADOW_OFF) ? uint(max(U.render3.y, 0)) : 0u);
+        uint counters[STAT_COUNTERS] = uint[](uint(steps), uint(field_iterations), uint(refine_steps),
+                                              uint(field_evals - lod_blend_evals - steps - refine_steps));
+        uint scale[STAT_COUNTERS] = uint[](uint(max_steps_u), uint(max_steps_u) * iters, uint(max(refine_cap, 1)),
+                                           shading_scale);
+        col = apply_cost_debug(col, hit, counters, scale);
+    }
+#endif
+
+#ifdef RAYMARCH_TILE_STATS
+    if (U.vrs0.x != 0) {
+        tile_stats_add(ivec2(gl_FragCoord.xy), hit, steps, n);
+    }
+#endif
+
+#if defined(FIELD_HAS_NORMAL) && !defined(RAYMARCH_DEFERRED)
+    if (hit && (U.render1.w & DEBUG_NORMAL_ERROR) != 0) {
+        vec3 p = ro + t * rd;
+        vec3 n;
+        float err = NORMAL_ERROR_DEGREES; // no analytic normal here: drawn as full error
+        if (analytic_normal(p, n)) {
+            err = degrees(acos(clamp(dot(n, tetrahedral_normal(p, t)), -1.0, 1.0)));
+        }
+        col = heat_color(err / NORMAL_ERROR_DEGREES);
+    }
+#endif
+
+#ifdef RAYMARCH_ATLAS
+    // One-pixel frame between thumbnails.
+    if (thumb_px.x == 0 || thumb_px.y == 0) {
+        col = vec3(0.0);
+    }
+#endif
+
+#ifdef RAYMARCH_INTERLEAVE
+    o_color = vec4(col, hit ? t : -1.0);
+#else
+    o_color = vec4(col, 1.0);
+#endif
+#endif
+}
+
+#endif /* VKF_RAYMARCH_GLSL */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Rebuilds the full-resolution frame of interleaved rendering into the history image. Pixels
+// marched this frame are copied from the sample image. The others are reprojected from the
+// previous frame: each neighbour marched this frame proposes its hit distance as this pixel's,
+// the point at that distance is projected into the previous camera, and the history pixel there
+// is accepted when its own hit distance agrees. Pixels with no agreeing history (disocclusions,
+// silhouettes, background) get the mean of their marched neighbours.
+
+#version 460
+
+#include "params.glsl"
+
+#include "interleave.glsl"
+
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 o_color;
+
+layout(set = 0, binding = 3) uniform texture2D samples; // this frame's pixels: rgb colour, a = hit t (< 0: miss)
+layout(set = 0, binding = 4) uniform texture2D history; // previous frame at full resolution, same encoding
+
+const float DEPTH_TOLERANCE = 0.05; // accepted relative difference between the proposed and stored hit t
+
+void main() {
+    int mode = U.interleave0.x;
+    int phase = U.interleave0.y;
+    ivec2 size = max(U.interleave0.zw, ivec2(1));
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    ivec2 s;
+    if (interleave_sampled(p, mode, phase, s)) {
+        o_color = texelFetch(samples, s, 0);
+        return;
+    }
+
+    float fov = (U.render0.w > 0.0) ? U.render0.w : 1.2;
+    float aspect = (U.misc0.y > 0.0) ? U.misc0.y : 1.0;
+    vec3 rd = camera_ray((vec2(p) + 0.5) / vec2(size), camera_basis(U.cam_fw.xyz, U.cam_rt.xyz), fov, aspect);
+    mat3 prev_basis = camera_basis(U.prev_cam_fw.xyz, U.prev_cam_rt.xyz);
+
+    vec3 spatial = vec3(0.0);
+    float count = 0.0;
+    float t_sum = 0.0;
+    float hits = 0.0;
+
+    vec4 best = vec4(0.0);
+    float best_err = DEPTH_TOLERANCE;
+
+    for (int j = 0; j < 9; j++) {
+        ivec2 q = p + ivec2(j % 3 - 1, j / 3 - 1);
+        if (j == 4 || any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size)) ||
+            !interleave_sampled(q, mode, phase, s)) {
+            continue;
+        }
+        vec4 c = texelFetch(samples, s, 0);
+        spatial += c.rgb;
+        count += 1.0;
+        if (c.a < 0.0) {
+            continue; // the background is smooth; the spatial mean reproduces it
+        }
+        t_sum += c.a;
+        hits += 1.0;
+
+        vec2 uv;
+        float dist;
+        if (!camera_project(U.cam_pos.xyz + rd * c.a, U.prev_cam_pos.xyz, prev_basis, fov, aspect, uv, dist) ||
+            any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0)))) {
+            continue;
+        }
+        vec4 h = texelFetch(history, ivec2(uv * vec2(size)), 0);
+        float err = (h.a < 0.0) ? 1.0 : abs(h.a - dist) / dist;
+        if (err < best_err) {
+            best_err = err;
+            best = vec4(h.rgb, c.a);
+        }
+    }
+
+    if (best_err < DEPTH_TOLERANCE) {
+        o_color = best;
+    } else {
+        o_color = vec4(spatial / max(count, 1.0), (hits > 0.0) ? t_sum / hits : -1.0);
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Shading rate image for the fractal pass, one fragment per screen tile, from the tile statistics
+// the previous frame's fractal pass collected:
+//  - no data (first frame, resize): 1x1,
+//  - the tile's refresh frame (every vrs2.y frames, staggered across tiles by vrs2.x): 1x1, so a
+//    thin filament that the 16 rays of a 4x4 tile missed cannot keep it "background only",
+//  - background only: 4x4, the gradient behind the fractal is smooth,
+//  - surface only, nearly flat (normal spread below vrs1.x) and cheap to march (max steps below
+//    vrs1.y of max_steps): 2x2,
+//  - anything else, in particular silhouettes and detailed or expensive surface: 1x1.
+
+#version 460
+
+#include "params.glsl"
+
+#define TILE_STATS_BINDING 8
+#include "tile_stats.glsl"
+
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out uint o_rate;
+
+void main() {
+    ivec2 tile = ivec2(gl_FragCoord.xy);
+    TileStats s = T.tiles[tile_index(tile)];
+    bool refresh = (tile.x + 3 * tile.y + U.vrs2.x) % max(U.vrs2.y, 1) == 0;
+
+    uint rate = SHADING_RATE_1X1;
+    if (!refresh && s.fragments > 0u && s.hits == 0u) {
+        rate = SHADING_RATE_4X4;
+    } else if (!refresh && s.fragments > 0u && s.hits == s.fragments) {
+        vec3 mean = vec3(s.normal_sum[0], s.normal_sum[1], s.normal_sum[2]) / (TILE_NORMAL_SCALE * float(s.hits));
+        float spread = 1.0 - length(mean); // 0 when every normal agrees
+        float cost = float(s.max_steps) / float(max(U.render1.x, 1));
+        if (spread < U.vrs1.x && cost < U.vrs1.y) {
+            rate = SHADING_RATE_2X2;
+        }
+    }
+    o_rate = rate;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VKF_TILE_STATS_GLSL
+#define VKF_TILE_STATS_GLSL
+
+// Per-tile statistics for variable-rate shading, mirrored by ShadingRate::Tile in
+// src/gfx/shading_rate.hpp. Define TILE_STATS_BINDING before including; U.vrs0 gives the tile
+// size and the tiles per row.
+
+const float TILE_NORMAL_SCALE = 256.0;
+
+// Shading rates of the rate image: (log2(width) << 2) | log2(height).
+const uint SHADING_RATE_1X1 = 0u;
+const uint SHADING_RATE_2X2 = 5u;
+const uint SHADING_RATE_4X4 = 10u;
+
+struct TileStats {
+    uint fragments;
+    uint hits;         // fragments whose ray hit the surface
+    uint max_steps;    // march steps of the most expensive fragment
+    int normal_sum[3]; // hit normals, scaled by TILE_NORMAL_SCALE
+};
+
+layout(std430, set = 0, binding = TILE_STATS_BINDING) buffer TileStatsBuffer {
+    TileStats tiles[]; // U.vrs0.w tiles per row
+}
+T;
+
+uint tile_index(ivec2 tile) { return uint(tile.y * U.vrs0.w + tile.x); }
+
+// Adds the fragment at framebuffer pixel px to its tile.
+void tile_stats_add(ivec2 px, bool hit, int steps, vec3 n) {
+    uint i = tile_index(px / max(U.vrs0.yz, ivec2(1)));
+    atomicAdd(T.tiles[i].fragments, 1u);
+    atomicMax(T.tiles[i].max_steps, uint(steps));
+    if (hit) {
+        ivec3 q = ivec3(round(n * TILE_NORMAL_SCALE));
+        atomicAdd(T.tiles[i].hits, 1u);
+        atomicAdd(T.tiles[i].normal_sum[0], q.x);
+        atomicAdd(T.tiles[i].normal_sum[1], q.y);
+        atomicAdd(T.tiles[i].normal_sum[2], q.z);
+    }
+}
+
+#endif /* VKF_TILE_STATS_GLSL */
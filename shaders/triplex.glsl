@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VKF_TRIPLEX_GLSL
+#define VKF_TRIPLEX_GLSL
+
+// Triplex power z^n in spherical coordinates, as iterated by the Mandelbulb and Julia fields.
+// Returns z^n and replaces J with (dz^n/dz) * J, the chain rule step of the analytic normals.
+vec3 triplex_pow_jacobian(vec3 z, float power, inout mat3 J) {
+    float r2 = max(dot(z, z), 1e-16);
+    float r = sqrt(r2);
+    float rho2 = max(dot(z.xy, z.xy), 1e-16);
+    float rho = sqrt(rho2);
+
+    float theta = acos(clamp(z.z / r, -1.0, 1.0));
+    float phi = atan(z.y, z.x);
+    float rn = pow(r, power);
+
+    float st = sin(theta * power);
+    float ct = cos(theta * power);
+    float sp = sin(phi * power);
+    float cp = cos(phi * power);
+
+    // z^n = r^n * e_r, and its derivatives along n*theta and n*phi.
+    vec3 e_r = vec3(st * cp, st * sp, ct);
+    vec3 e_theta = vec3(ct * cp, ct * sp, -st);
+    vec3 e_phi = vec3(-st * sp, st * cp, 0.0);
+
+    // Gradients of r, theta and phi with respect to z.
+    vec3 dr = z / r;
+    vec3 dtheta = vec3(z.x * z.z / rho, z.y * z.z / rho, -rho) / r2;
+    vec3 dphi = vec3(-z.y, z.x, 0.0) / rho2;
+
+    float k = power * rn;
+    J = (outerProduct(e_r, dr * (k / r)) + outerProduct(e_theta, dtheta * k) + outerProduct(e_phi, dphi * k)) * J;
+    return rn * e_r;
+}
+
+#endif /* VKF_TRIPLEX_GLSL */
@@ -5,35 +5,45 @@
  */
 
 #include <imgui.h>
-#include <unistd.h>
+#include <sys/resource.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstring>
-#include <filesystem>
+#include <exception>
+#include <format>
+#include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "app/app.hpp"
 #include "util/checks.hpp"
+#include "util/read_file.hpp"
 
 namespace {
 
-std::string shader_dir_from_exe() {
-    std::vector<char> buf(4096);
-    ssize_t n = readlink("/proc/self/exe", buf.data(), buf.size() - 1);
-    if (n > 0) {
-        buf[n] = '\0';
-        std::filesystem::path exe_path(buf.data());
-        return (exe_path.parent_path() / "shaders").string();
+// Process CPU time (user + system) in seconds.
+double process_cpu_seconds() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+}
+
+void request_redraw(GLFWwindow *w) {
+    auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
+    if (app) {
+        app->request_redraw();
     }
-    return (std::filesystem::current_path() / "shaders").string();
 }
 
 void framebuffer_resize_cb(GLFWwindow *w, int width, int height) {
     auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
     if (app) {
         app->on_framebuffer_resize(width, height);
+        app->request_redraw();
     }
 }
 
@@ -41,6 +51,28 @@ static void cursor_pos_cb(GLFWwindow *w, double x, double y) {
     auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
     if (app) {
         app->on_mouse_move(x, y);
+        app->request_redraw();
+    }
+}
+
+static void mouse_button_cb(GLFWwindow *w, int button, int action, int /*mods*/) {
+    auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
+    if (app) {
+        app->on_mouse_button(button, action == GLFW_PRESS);
+        app->request_redraw();
+    }
+}
+
+// The callbacks below exist only to wake the on-demand loop; ImGui installs its own handlers
+// for them and chains to these.
+static void scroll_cb(GLFWwindow *w, double /*dx*/, double /*dy*/) { request_redraw(w); }
+static void char_cb(GLFWwindow *w, unsigned int /*codepoint*/) { request_redraw(w); }
+static void window_refresh_cb(GLFWwindow *w) { request_redraw(w); }
+static void window_focus_cb(GLFWwindow *w, int focused) {
+    auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
+    if (app) {
+        app->on_focus(focused == GLFW_TRUE);
+        app->request_redraw();
     }
 }
 
@@ -49,6 +81,12 @@ static void key_cb(GLFWwindow *w, int key, int scancode, int action, int mods) {
     (void)mods;
 
     auto *app = reinterpret_cast<App *>(glfwGetWindowUserPointer(w));
+    if (app) {
+        app->request_redraw();
+        if (action != GLFW_REPEAT) {
+            app->on_key(key, action == GLFW_PRESS);
+        }
+    }
 
     if (app && action == GLFW_PRESS) {
         switch (key) {
@@ -89,7 +127,36 @@ void App::on_mouse_move(double xpos, double ypos) {
     last_x_ = xpos;
     last_y_ = ypos;
 
-    camera_.processMouse(dx, dy);
+    sim_.add_mouse_delta(dx, dy);
+}
+
+void App::on_mouse_button(int button, bool down) {
+    // Clicking a thumbnail of the parameter atlas adopts its parameters and leaves the atlas.
+    if (!atlas_enabled_ || params_.atlas0[0] == 0 || mouse_locked_ || button != GLFW_MOUSE_BUTTON_LEFT || !down ||
+        ImGui::GetIO().WantCaptureMouse) {
+        return;
+    }
+
+    double x = 0.0, y = 0.0;
+    int win_w = 0, win_h = 0, fb_w = 0, fb_h = 0;
+    glfwGetCursorPos(window_, &x, &y);
+    glfwGetWindowSize(window_, &win_w, &win_h);
+    glfwGetFramebufferSize(window_, &fb_w, &fb_h);
+    if (win_w <= 0 || win_h <= 0 || x < 0.0 || y < 0.0) {
+        return;
+    }
+
+    // Window coordinates to framebuffer pixels, then to the thumbnail under them.
+    const int px = static_cast<int>(x * fb_w / win_w);
+    const int py = static_cast<int>(y * fb_h / win_h);
+    const int col = px / std::max(params_.atlas0[2], 1);
+    const int row = py / std::max(params_.atlas0[3], 1);
+    if (col >= params_.atlas0[0] || row >= params_.atlas0[1]) {
+        return;
+    }
+    atlas_.tile_params(
+        static_cast<uint32_t>(col), static_cast<uint32_t>(row), params_.field_params, params_.field_params);
+    atlas_enabled_ = false;
 }
 
 void App::on_framebuffer_resize(int width, int height) {
@@ -102,7 +169,37 @@ void App::on_framebuffer_resize(int width, int height) {
     }
 }
 
-void App::on_field_change(int d) { params_.render1[1] += d; }
+void App::on_field_change(int d) { select_field(params_.render1[1] + d); }
+
+void App::on_key(int key, bool down) {
+    switch (key) {
+    case GLFW_KEY_W:
+        sim_.set_key(kSimKeyForward, down);
+        break;
+    case GLFW_KEY_S:
+        sim_.set_key(kSimKeyBackward, down);
+        break;
+    case GLFW_KEY_A:
+        sim_.set_key(kSimKeyLeft, down);
+        break;
+    case GLFW_KEY_D:
+        sim_.set_key(kSimKeyRight, down);
+        break;
+    case GLFW_KEY_Q:
+        sim_.set_key(kSimKeyRollLeft, down);
+        break;
+    case GLFW_KEY_E:
+        sim_.set_key(kSimKeyRollRight, down);
+        break;
+    }
+}
+
+void App::on_focus(bool focused) {
+    // Release events are not delivered to an unfocused window, so drop the held keys.
+    if (!focused) {
+        sim_.release_all_keys();
+    }
+}
 
 void App::init_window() {
     if (!glfwInit()) {
@@ -120,20 +217,24 @@ void App::init_window() {
     glfwSetFramebufferSizeCallback(window_, framebuffer_resize_cb);
     glfwSetCursorPosCallback(window_, cursor_pos_cb);
     glfwSetKeyCallback(window_, key_cb);
+    glfwSetMouseButtonCallback(window_, mouse_button_cb);
+    glfwSetScrollCallback(window_, scroll_cb);
+    glfwSetCharCallback(window_, char_cb);
+    glfwSetWindowRefreshCallback(window_, window_refresh_cb);
+    glfwSetWindowFocusCallback(window_, window_focus_cb);
     glfwSetInputMode(window_, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     clear_.color = {{0.15f, 0.15f, 0.18f, 1.0f}};
 }
 
 void App::init_vulkan() {
-    params_.render1[1] = 2;      // field_id
+    select_field(2);             // mandelbulb
     params_.render1[2] = 256;    // iterations
-    params_.fractal0[0] = 32.0f; // bailout
-    params_.fractal0[1] = 8.0f;  // power
     params_.render0[0] = 50.0f;  // max_dist (mandelbulb is “dense”)
     params_.render1[0] = 256;    // max_steps
     params_.render0[1] = 1e-3f;  // hit_eps
 
+    const auto t0 = std::chrono::steady_clock::now();
     ctx_.init(window_);
 
     int fb_w = 0, fb_h = 0;
@@ -144,14 +245,58 @@ void App::init_vulkan() {
     }
 
     sw_.init(ctx_, static_cast<uint32_t>(fb_w), static_cast<uint32_t>(fb_h));
-    frames_.init(ctx_);
-
-    const std::string shader_dir = shader_dir_from_exe();
-    fsq_.init(ctx_, sw_, shader_dir);
-
-    ctx_.init_imgui(window_, sw_.render_pass(), sw_.image_count());
-
-    // Update each descriptor set to point at the matching frame's UBO.
+    frames_.init(ctx_, record_pool_.thread_count());
+
+    // Shader modules and pipelines dominate startup as the variant count grows; report them.
+    const auto t_shaders = std::chrono::steady_clock::now();
+    ctx_.init_shaders(shader_dir_from_exe() + "/shaders.bundle");
+    // Fractal pipelines: every shader kind for every field, kind-major (see fractal_variant()).
+    std::vector<FullscreenPipeline::Variant> variants;
+    for (uint32_t kind = 0; kind < kFieldShaderCount; kind++) {
+        VkFormat format = sw_.format();
+        if (kind == kFieldShaderShadow) {
+            format = kHalfShadowFormat;
+        } else if (kind == kFieldShaderInterleave) {
+            format = kHistoryFormat;
+        } else if (kind == kFieldShaderGBuffer || kind == kFieldShaderGBufferStereo) {
+            format = GBuffer::kFormat;
+        }
+        // The full-resolution marching passes may run with a shading rate image.
+        const bool shading_rate = ctx_.shading_rate_supported() &&
+                                  (kind == kFieldShaderMain || kind == kFieldShaderShadowUpsample ||
+                                   kind == kFieldShaderGBuffer || kind == kFieldShaderGBufferStereo);
+        for (const std::string &shader : field_shaders(static_cast<FieldShader>(kind))) {
+            variants.push_back({shader, format, shading_rate});
+        }
+    }
+    // Interleaved rendering's reconstruction into the history image and its copy to the swapchain.
+    reconstruct_variant_ = static_cast<uint32_t>(variants.size());
+    variants.push_back({"reconstruct.frag.spv", kHistoryFormat});
+    present_variant_ = static_cast<uint32_t>(variants.size());
+    variants.push_back({"present.frag.spv", sw_.format()});
+    // Variable-rate shading's rate image from the previous frame's tile statistics.
+    shading_rate_variant_ = static_cast<uint32_t>(variants.size());
+    variants.push_back({"shading_rate.frag.spv", kShadingRateFormat});
+    fsq_.init(ctx_, variants);
+    compute_.init(ctx_);
+    // The statistics of each frame are reduced on the compute queue.
+    cost_.init(ctx_, FrameRing::kMaxFrames, &compute_);
+    atlas_.init(ctx_, FrameRing::kMaxFrames);
+    // Without the extension the buffers are still bound: the fractal shaders declare them.
+    shading_rate_.init(ctx_,
+                       &deletion_,
+                       FrameRing::kMaxFrames,
+                       ctx_.shading_rate_supported() ? ctx_.shading_rate_texel_size() : VkExtent2D{16, 16});
+    const auto t_pipelines = std::chrono::steady_clock::now();
+
+    ctx_.init_imgui(window_, sw_.format(), sw_.image_count());
+    graph_.init(ctx_, deletion_);
+    history_.init(ctx_, deletion_, kHistoryFormat);
+    gbuffer_.init(ctx_, deletion_);
+    pacing_.init(ctx_, FrameRing::kMaxFrames);
+
+    // Update each descriptor set to point at the matching frame's UBO, cost statistics and
+    // parameter atlas.
     VkBuffer ubos[FrameRing::kMaxFrames]{};
 
     for (uint32_t i = 0; i < FrameRing::kMaxFrames; i++) {
@@ -166,20 +311,63 @@ void App::init_vulkan() {
         bi.offset = 0;
         bi.range = sizeof(GpuParams);
 
-        VkWriteDescriptorSet wds{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        wds.dstSet = fsq_.ds(i);
-        wds.dstBinding = 0;
-        wds.descriptorCount = 1;
-        wds.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        wds.pBufferInfo = &bi;
-
-        vkUpdateDescriptorSets(ctx_.device(), 1, &wds, 0, nullptr);
+        VkDescriptorBufferInfo sbi{};
+        sbi.buffer = cost_.buffer(i);
+        sbi.offset = 0;
+        sbi.range = CostStats::kBufferSize;
+
+        VkDescriptorBufferInfo abi{};
+        abi.buffer = atlas_.buffer(i);
+        abi.offset = 0;
+        abi.range = ParamAtlas::buffer_size();
+
+        VkWriteDescriptorSet wds[3]{};
+        wds[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wds[0].dstSet = fsq_.ds(i);
+        wds[0].dstBinding = 0;
+        wds[0].descriptorCount = 1;
+        wds[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        wds[0].pBufferInfo = &bi;
+
+        wds[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wds[1].dstSet = fsq_.ds(i);
+        wds[1].dstBinding = 1;
+        wds[1].descriptorCount = 1;
+        wds[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        wds[1].pBufferInfo = &sbi;
+
+        wds[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wds[2].dstSet = fsq_.ds(i);
+        wds[2].dstBinding = FullscreenPipeline::kAtlasBinding;
+        wds[2].descriptorCount = 1;
+        wds[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        wds[2].pBufferInfo = &abi;
+
+        vkUpdateDescriptorSets(ctx_.device(), 3, wds, 0, nullptr);
     }
+
+    const auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << std::format("Startup: {:.1f} ms, shaders and pipelines {:.1f} ms ({} fractal variants)\n",
+                             ms(std::chrono::steady_clock::now() - t0),
+                             ms(t_pipelines - t_shaders),
+                             fsq_.variant_count());
 }
 
 void App::shutdown() {
+    sim_.stop();
+    stop_mesh_export();
+
     if (ctx_.device()) {
         vkDeviceWaitIdle(ctx_.device());
+        deletion_.flush();
+        shading_rate_.shutdown(ctx_.device());
+        cost_.shutdown(ctx_.device());
+        atlas_.shutdown(ctx_.device());
+        pacing_.shutdown(ctx_.device());
+        compute_.shutdown();
+        history_.shutdown(ctx_.device());
+        gbuffer_.shutdown(ctx_.device());
+        graph_.shutdown();
         fsq_.shutdown(ctx_.device());
         frames_.shutdown(ctx_.device());
         sw_.shutdown(ctx_.device());
@@ -199,47 +387,20 @@ void App::recreate_swapchain_if_needed() {
         return; // minimized
     }
 
-    vkDeviceWaitIdle(ctx_.device());
-    sw_.recreate(ctx_, static_cast<uint32_t>(w), static_cast<uint32_t>(h));
-    fsq_.recreate_framebuffers(ctx_.device(), sw_);
+    // Frames already submitted keep using the old swapchain; it is destroyed once they and their
+    // presents have finished.
+    sw_.recreate(ctx_, static_cast<uint32_t>(w), static_cast<uint32_t>(h), deletion_, frames_.last_submitted());
+    params_tracker_.invalidate();
 
     framebuffer_resized_ = false;
 }
 
-void App::draw_frame(float time_seconds) {
-    auto &f = frames_.current();
-
-    vk_check(vkWaitForFences(ctx_.device(), 1, &f.in_flight, VK_TRUE, UINT64_MAX), "vkWaitForFences");
-    vk_check(vkResetFences(ctx_.device(), 1, &f.in_flight), "vkResetFences");
-
-    uint32_t img_idx = 0;
-    VkResult acq =
-        vkAcquireNextImageKHR(ctx_.device(), sw_.handle(), UINT64_MAX, f.image_acquired, VK_NULL_HANDLE, &img_idx);
-
-    if (acq == VK_ERROR_OUT_OF_DATE_KHR || acq == VK_SUBOPTIMAL_KHR) {
-        recreate_swapchain_if_needed();
-        return;
-    }
-    vk_check(acq, "vkAcquireNextImageKHR");
-
-    // --- ImGui ---
-    ctx_.imgui_new_frame();
-    build_ui();
-
-    // --- Update UBO ---
-    params_.misc0[0] = time_seconds;
+void App::update_params(float time_seconds, const SimFrame &sim) {
     params_.misc0[1] = static_cast<float>(sw_.extent().width) / static_cast<float>(sw_.extent().height); // aspect
+    params_.misc0[2] = 1.0f / static_cast<float>(sw_.extent().height);                                   // pixel size
 
-    glm::vec3 pos;
-    pos.x = cam_radius_ * cos(cam_pitch_) * sin(cam_yaw_);
-    pos.y = cam_radius_ * sin(cam_pitch_);
-    pos.z = cam_radius_ * cos(cam_pitch_) * cos(cam_yaw_);
-
-    pos += cam_target_;
-
-    params_.cam_pos[0] = pos.x;
-    params_.cam_pos[1] = pos.y;
-    params_.cam_pos[2] = pos.z;
+    camera_.position = sim.position;
+    camera_.orientation = sim.orientation;
 
     glm::vec3 fw, rt, up;
     camera_.getBasis(fw, rt, up);
@@ -260,98 +421,534 @@ void App::draw_frame(float time_seconds) {
     params_.cam_up[1] = up.y;
     params_.cam_up[2] = up.z;
 
-    switch (animated_param_) {
-    case 0:
-        break;
-    case 1: // Julia C.x
-        params_.julia_c[0] = std::fmod(time_seconds / 4.0f, 4.0f) - 2.0f;
-        break;
-    case 2: // Julia C.y
-        params_.julia_c[1] = std::fmod(time_seconds / 4.0f, 4.0f) - 2.0f;
-        break;
-    case 3: // Julia C.z
-        params_.julia_c[2] = std::fmod(time_seconds / 4.0f, 4.0f) - 2.0f;
-        break;
-    case 4: // Julia C.xy
-    {
-        float t = std::fmod(time_seconds / 4.0f, 2 * std::numbers::pi_v<float>);
-        params_.julia_c[0] = std::sin(t);
-        params_.julia_c[1] = std::cos(t);
-    } break;
-    case 5: // Julia C.xy
-    {
-        float t = std::fmod(time_seconds / 4.0f, 2 * std::numbers::pi_v<float>);
-        params_.julia_c[1] = std::sin(t);
-        params_.julia_c[2] = std::cos(t);
-    } break;
-    case 6: // Julia C.xy
-    {
-        float t = std::fmod(time_seconds / 4.0f, 2 * std::numbers::pi_v<float>);
-        params_.julia_c[0] = std::sin(t);
-        params_.julia_c[2] = std::cos(t);
-    } break;
+    if (sim.julia_mask == 0) {
+        // Nothing reads the time unless a parameter is animated; leaving it untouched keeps
+        // static frames free of changes.
+        return;
     }
 
-    std::memcpy(f.ubo_mapped, &params_, sizeof(params_));
+    params_.misc0[0] = time_seconds;
+    const FieldParamInfo *c = find_field_param(params_.render1[1], "c");
+    if (!c) {
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (sim.julia_mask & (1u << i)) {
+            params_.field_params[c->slot + i] = sim.julia_c[i];
+        }
+    }
+}
 
-    // --- Record command buffer ---
-    vk_check(vkResetCommandBuffer(f.cmd, 0), "vkResetCommandBuffer");
+void App::update_atlas() {
+    if (!atlas_enabled_) {
+        params_.atlas0[0] = 0;
+        params_.atlas0[1] = 0;
+        return;
+    }
+    if (atlas_field_ != params_.render1[1]) {
+        atlas_.reset_axes(params_.render1[1]);
+        atlas_field_ = params_.render1[1];
+    }
 
-    VkCommandBufferBeginInfo cbi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    vk_check(vkBeginCommandBuffer(f.cmd, &cbi), "vkBeginCommandBuffer");
+    atlas_.grid = std::clamp(atlas_.grid, 2, static_cast<int>(ParamAtlas::kMaxGrid));
+    const VkExtent2D extent = sw_.extent();
+    params_.atlas0[0] = atlas_.grid;
+    params_.atlas0[1] = atlas_.grid;
+    params_.atlas0[2] = static_cast<int>(extent.width) / atlas_.grid;
+    params_.atlas0[3] = static_cast<int>(extent.height) / atlas_.grid;
+    // The slot's previous frame has completed, so its buffer can be rewritten.
+    atlas_.upload(frames_.index(), params_.field_params);
+}
+
+void App::update_interleave(uint32_t dirty) {
+    const bool was_active = interleave_active_;
+    interleave_active_ = interleave_mode_ != kInterleaveFull && params_.render2[0] == 0 && !atlas_enabled_;
+    if (!interleave_active_) {
+        if (interleave_mode_ == kInterleaveFull) {
+            interleave_status_ = "off";
+        } else {
+            interleave_status_ = atlas_enabled_ ? "off in the atlas" : "off in stereo";
+        }
+        history_valid_ = false;
+        return;
+    }
+
+    const VkExtent2D extent = sw_.extent();
+    if (history_.ensure(extent, frames_.last_submitted()) || !was_active) {
+        history_valid_ = false;
+    }
 
-    VkRenderPassBeginInfo rpbi{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    rpbi.renderPass = fsq_.render_pass();
-    rpbi.framebuffer = fsq_.framebuffer(img_idx);
-    rpbi.renderArea.offset = {0, 0};
-    rpbi.renderArea.extent = sw_.extent();
-    rpbi.clearValueCount = 1;
-    rpbi.pClearValues = &clear_;
+    const glm::vec3 pos(params_.cam_pos[0], params_.cam_pos[1], params_.cam_pos[2]);
+    const glm::vec3 fw(params_.cam_fw[0], params_.cam_fw[1], params_.cam_fw[2]);
+    const glm::vec3 rt(params_.cam_rt[0], params_.cam_rt[1], params_.cam_rt[2]);
+
+    // Camera motion since the history frame: the larger rotation of the forward and right axes,
+    // plus the translation relative to the distance from the origin, where the fields are.
+    const auto angle = [](const glm::vec3 &a, const glm::vec3 &b) {
+        return std::acos(std::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.0f, 1.0f));
+    };
+    const float motion = std::max(angle(fw, history_cam_[1]), angle(rt, history_cam_[2])) +
+                         glm::length(pos - history_cam_[0]) / std::max(glm::length(history_cam_[0]), 1e-3f);
+
+    // Only camera motion can be reprojected; any other change alters the pixels in place. A camera
+    // at rest gets a full frame, so the picture left on screen is exact.
+    constexpr uint32_t kStale = (kInvalidatesHistory & ~kDirtyCamera) | kDirtyDebug | kDirtyTime;
+    bool full = true;
+    if (!history_valid_) {
+        interleave_status_ = "full frame (no history)";
+    } else if (dirty & kStale) {
+        interleave_status_ = "full frame (parameters changed)";
+    } else if ((dirty & kDirtyCamera) == 0) {
+        interleave_status_ = "full frame (camera at rest)";
+    } else if (motion > glm::radians(interleave_max_motion_)) {
+        interleave_status_ = "full frame (fast motion)";
+    } else {
+        interleave_status_ = (interleave_mode_ == kInterleaveQuarter) ? "interleaved, 1/4 of the pixels"
+                                                                      : "interleaved, 1/2 of the pixels";
+        full = false;
+    }
 
-    vkCmdBeginRenderPass(f.cmd, &rpbi, VK_SUBPASS_CONTENTS_INLINE);
+    if (full) {
+        params_.interleave0[0] = kInterleaveFull;
+    } else {
+        const uint32_t phases = (interleave_mode_ == kInterleaveQuarter) ? 4u : 2u;
+        interleave_phase_ = (interleave_phase_ + 1) % phases;
+        params_.interleave0[0] = interleave_mode_;
+        params_.interleave0[1] = static_cast<int>(interleave_phase_);
+    }
+    params_.interleave0[2] = static_cast<int>(extent.width);
+    params_.interleave0[3] = static_cast<int>(extent.height);
+    for (int i = 0; i < 3; i++) {
+        params_.prev_cam_pos[i] = history_cam_[0][i];
+        params_.prev_cam_fw[i] = history_cam_[1][i];
+        params_.prev_cam_rt[i] = history_cam_[2][i];
+    }
 
-    vkCmdBindPipeline(f.cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.pipeline());
+    // This frame's result is the next frame's history.
+    history_cam_[0] = pos;
+    history_cam_[1] = fw;
+    history_cam_[2] = rt;
+    history_valid_ = true;
+}
 
-    // Dynamic viewport/scissor (CRITICAL for resize correctness)
-    VkViewport vp{};
-    vp.x = 0.0f;
-    vp.y = 0.0f;
-    vp.width = static_cast<float>(sw_.extent().width);
-    vp.height = static_cast<float>(sw_.extent().height);
-    vp.minDepth = 0.0f;
-    vp.maxDepth = 1.0f;
-    vkCmdSetViewport(f.cmd, 0, 1, &vp);
+void App::update_shading_rate(uint32_t dirty) {
+    shading_rate_.ensure(sw_.extent(), frames_.last_submitted());
+
+    // Coarse rates follow the previous frame's statistics, which coarse tiles only sample. Every
+    // tile is shaded per pixel in its refresh frame, and a frame in which nothing changed is
+    // shaded per pixel throughout, so the picture left on screen is exact.
+    bool active = false;
+    if (!vrs_enabled_ || !ctx_.shading_rate_supported()) {
+        vrs_status_ = "off";
+    } else if (interleave_active_ || atlas_enabled_) {
+        vrs_status_ = interleave_active_ ? "off while interleaving" : "off in the atlas";
+    } else if (dirty == 0) {
+        vrs_status_ = "full rate (nothing changed)";
+    } else {
+        vrs_status_ = "coarse tiles";
+        active = true;
+        params_.vrs2[0] = (params_.vrs2[0] + 1) % std::max(params_.vrs2[1], 1);
+    }
+    params_.vrs0[0] = active ? 1 : 0;
+    params_.vrs0[1] = static_cast<int>(shading_rate_.tile().width);
+    params_.vrs0[2] = static_cast<int>(shading_rate_.tile().height);
+    params_.vrs0[3] = static_cast<int>(shading_rate_.tiles().width);
+}
 
-    VkRect2D sc{};
-    sc.offset = {0, 0};
-    sc.extent = sw_.extent();
-    vkCmdSetScissor(f.cmd, 0, 1, &sc);
+void App::update_deferred(uint32_t dirty) {
+    // The G-buffer holds the march steps but not the other cost counters or the normal error.
+    const int debug = params_.render1[3];
+    const int heatmap = (debug & kDebugHeatmapMask) >> kDebugHeatmapShift;
+    const bool forward_debug =
+        (debug & (kDebugCostStats | kDebugNormalError)) != 0 || (heatmap != 0 && heatmap != 1 + CostStats::kMarchSteps);
+
+    deferred_active_ = deferred_enabled_ && !interleave_active_ && !atlas_enabled_ && !forward_debug;
+    if (!deferred_active_) {
+        if (!deferred_enabled_) {
+            deferred_status_ = "off";
+        } else if (interleave_active_) {
+            deferred_status_ = "off while interleaving";
+        } else {
+            deferred_status_ = atlas_enabled_ ? "off in the atlas" : "off for this debug view";
+        }
+        gbuffer_valid_ = false;
+        stereo_warm_active_ = false;
+        return;
+    }
 
-    // Bind descriptor set matching this frame-in-flight
-    VkDescriptorSet ds = fsq_.ds(frames_.index());
-    vkCmdBindDescriptorSets(f.cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.layout(), 0, 1, &ds, 0, nullptr);
+    if (gbuffer_.ensure(sw_.extent(), frames_.last_submitted())) {
+        gbuffer_valid_ = false;
+    }
+
+    // Everything that moves a ray's hit or its normal needs a new march; lighting, palette and the
+    // heatmap are applied by the shading pass alone.
+    constexpr uint32_t kMarchInputs = kDirtyCamera | kDirtyRaymarch | kDirtyField | kDirtyView | kDirtyTime;
+    march_gbuffer_ = !gbuffer_valid_ || (dirty & kMarchInputs) != 0 || params_.render3[2] != gbuffer_normal_mode_;
+    deferred_status_ = march_gbuffer_ ? "march + shade" : "shade only";
+    gbuffer_valid_ = true;
+    gbuffer_normal_mode_ = params_.render3[2];
+    stereo_warm_active_ = march_gbuffer_ && stereo_warm_enabled_ && params_.render2[0] == 1;
+}
+
+void App::draw_frame(float time_seconds, const SimFrame &sim) {
+    auto &f = frames_.current();
+    const uint64_t frame = frames_.next_value();
+
+    const auto wait_t0 = std::chrono::steady_clock::now();
+
+    // The slot's previous frame must be finished before its command pools and UBO are reused.
+    frames_.wait_current(kGpuTimeoutNs);
+    pacing_.resolve(frames_.index());
+    cost_.resolve(frames_.index());
+    deletion_.collect(frames_.completed_value());
+    sw_.collect(frames_.completed_value());
+
+    uint32_t img_idx = 0;
+    VkResult acq =
+        vkAcquireNextImageKHR(ctx_.device(), sw_.handle(), kGpuTimeoutNs, f.image_acquired, VK_NULL_HANDLE, &img_idx);
+
+    if (acq == VK_ERROR_OUT_OF_DATE_KHR) {
+        recreate_swapchain_if_needed();
+        return;
+    }
+    if (acq == VK_TIMEOUT || acq == VK_NOT_READY) {
+        // No image within the timeout (e.g. the compositor holds them); try again next loop.
+        request_redraw();
+        return;
+    }
+    if (acq != VK_SUBOPTIMAL_KHR) {
+        vk_check(acq, "vkAcquireNextImageKHR");
+    }
+
+    const auto wait_t1 = std::chrono::steady_clock::now();
+    FramePacing::Sample &pacing = pacing_.at(frame);
+    pacing.cpu_wait_ms = std::chrono::duration<float, std::milli>(wait_t1 - wait_t0).count();
+
+    compute_.collect();
+
+    // --- ImGui ---
+    ctx_.imgui_new_frame();
+    build_ui();
+
+    // --- Update UBO ---
+    update_params(time_seconds, sim);
+    update_atlas();
+    update_interleave(params_tracker_.peek(params_));
+    update_shading_rate(params_tracker_.peek(params_));
+    update_deferred(params_tracker_.peek(params_));
+
+    const uint32_t dirty = params_tracker_.commit(params_);
+    if (dirty) {
+        last_dirty_reasons_ = dirty;
+        frames_since_change_ = 0;
+    } else {
+        frames_since_change_++;
+    }
+
+    // Each frame in flight owns its UBO, so a slot is stale until it has seen the latest generation.
+    if (f.ubo_generation != params_tracker_.generation()) {
+        std::memcpy(f.ubo_mapped, &params_, sizeof(params_));
+        f.ubo_generation = params_tracker_.generation();
+        ubo_uploads_++;
+    }
+
+    // ImGui::Render() touches the ImGui context and stays on this thread; recording its draw
+    // data only reads it. Nothing else uses the queue while the passes are recorded, so the
+    // texture uploads ImGui may submit from inside its recording are safe as well.
+    ctx_.imgui_end_frame();
+
+    const auto rec_t0 = std::chrono::steady_clock::now();
+
+    // --- Render graph ---
+    const uint32_t frame_index = frames_.index();
+
+    graph_.reset();
+    const RGImage backbuffer = graph_.import_image("swapchain",
+                                                   sw_.images()[img_idx],
+                                                   sw_.image_views()[img_idx],
+                                                   sw_.format(),
+                                                   sw_.extent(),
+                                                   VK_IMAGE_LAYOUT_UNDEFINED,
+                                                   VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    // Half-resolution shadows: a pass at half the size marches and traces the shadow rays, the
+    // fractal pass upsamples them. Interleaved and deferred frames trace them per pixel instead.
+    RGImage half_shadow = kRGNone;
+    if (params_.render3[0] == kShadowHalf && !interleave_active_ && !deferred_active_ && !atlas_enabled_) {
+        const VkExtent2D half{(sw_.extent().width + 1) / 2, (sw_.extent().height + 1) / 2};
+        half_shadow = graph_.create_image("half_shadow", kHalfShadowFormat, half);
+        const uint32_t shadow_variant = fractal_variant(kFieldShaderShadow);
+        graph_
+            .add_pass("shadow",
+                      [this, frame_index, shadow_variant, half](VkCommandBuffer cmd) {
+                          record_fullscreen_pass(cmd, frame_index, shadow_variant, half);
+                      })
+            .color(half_shadow, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    }
+
+    const VkExtent2D extent = sw_.extent();
+    RGImage samples = kRGNone;
+    RGImage stereo_left = kRGNone;
+    if (atlas_enabled_) {
+        // Every thumbnail in one pass, each marched with its own field parameters.
+        const uint32_t atlas = fractal_variant(kFieldShaderAtlas);
+        graph_
+            .add_pass("atlas",
+                      [this, frame_index, atlas, extent](VkCommandBuffer cmd) {
+                          record_fullscreen_pass(cmd, frame_index, atlas, extent);
+                      })
+            .color(backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, clear_.color);
+    } else if (interleave_active_) {
+        // The frame goes to the current history image, rendered in full or marched in part and
+        // reconstructed from the previous one, and is then copied to the swapchain.
+        const RGImage history = graph_.import_image("history",
+                                                    history_.current_image(),
+                                                    history_.current_view(),
+                                                    kHistoryFormat,
+                                                    extent,
+                                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        const uint32_t fractal = fractal_variant(kFieldShaderInterleave);
+        if (params_.interleave0[0] == kInterleaveFull) {
+            graph_
+                .add_pass("fractal",
+                          [this, frame_index, fractal, extent](VkCommandBuffer cmd) {
+                              record_fullscreen_pass(cmd, frame_index, fractal, extent);
+                          })
+                .color(history, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        } else {
+            VkExtent2D sample_extent{(extent.width + 1) / 2, extent.height};
+            if (params_.interleave0[0] == kInterleaveQuarter) {
+                sample_extent.height = (extent.height + 1) / 2;
+            }
+            samples = graph_.create_image("interleave_samples", kHistoryFormat, sample_extent);
+            graph_
+                .add_pass("fractal",
+                          [this, frame_index, fractal, sample_extent](VkCommandBuffer cmd) {
+                              record_fullscreen_pass(cmd, frame_index, fractal, sample_extent);
+                          })
+                .color(samples, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+
+            const RGImage previous = graph_.import_image("history_previous",
+                                                         history_.previous_image(),
+                                                         history_.previous_view(),
+                                                         kHistoryFormat,
+                                                         extent,
+                                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            graph_
+                .add_pass("reconstruct",
+                          [this, frame_index, extent](VkCommandBuffer cmd) {
+                              record_fullscreen_pass(cmd, frame_index, reconstruct_variant_, extent);
+                          })
+                .sampled(samples)
+                .sampled(previous)
+                .color(history, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        }
+        graph_
+            .add_pass("present",
+                      [this, frame_index, extent](VkCommandBuffer cmd) {
+                          record_fullscreen_pass(cmd, frame_index, present_variant_, extent);
+                      })
+            .sampled(history)
+            .color(backbuffer, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    } else {
+        // Deferred frames whose march inputs did not change only run the shading pass.
+        const bool march = !deferred_active_ || march_gbuffer_;
+
+        // Variable-rate shading: one fragment per tile picks the tile's rate for the fractal pass.
+        RGImage rate = kRGNone;
+        if (params_.vrs0[0] != 0 && march) {
+            const VkExtent2D tiles = shading_rate_.tiles();
+            rate = graph_.create_image("shading_rate", kShadingRateFormat, tiles);
+            graph_
+                .add_pass("shading_rate",
+                          [this, frame_index, tiles](VkCommandBuffer cmd) {
+                              record_fullscreen_pass(cmd, frame_index, shading_rate_variant_, tiles);
+                          })
+                .color(rate, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        }
+
+        // A G-buffer that is not rewritten this frame still holds the previous frame's march.
+        RGImage gbuffer = kRGNone;
+        if (deferred_active_) {
+            gbuffer = graph_.import_image("gbuffer",
+                                          gbuffer_.image(),
+                                          gbuffer_.view(),
+                                          GBuffer::kFormat,
+                                          extent,
+                                          march ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+
+        if (march && stereo_warm_active_) {
+            // Side-by-side stereo: the left eye is marched first, into an image the right eye's
+            // march reads to start each ray past the surfaces the left eye already ruled out.
+            stereo_left = graph_.create_image("stereo_left", GBuffer::kFormat, extent);
+            const uint32_t left = fractal_variant(kFieldShaderGBuffer);
+            const VkRect2D left_half{{0, 0}, {extent.width / 2, extent.height}};
+            RenderGraph::PassBuilder left_pass =
+                graph_.add_pass("fractal_left", [this, frame_index, left, extent, left_half](VkCommandBuffer cmd) {
+                    record_fullscreen_pass(cmd, frame_index, left, extent, &left_half);
+                });
+            left_pass.color(stereo_left, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+            if (rate != kRGNone) {
+                left_pass.shading_rate(rate, shading_rate_.tile());
+            }
+        }
+
+        if (march) {
+            FieldShader kind = kFieldShaderMain;
+            if (stereo_warm_active_) {
+                kind = kFieldShaderGBufferStereo;
+            } else if (deferred_active_) {
+                kind = kFieldShaderGBuffer;
+            } else if (half_shadow != kRGNone) {
+                kind = kFieldShaderShadowUpsample;
+            }
+            const uint32_t fractal = fractal_variant(kind);
+            RenderGraph::PassBuilder fractal_pass =
+                graph_.add_pass("fractal", [this, frame_index, fractal, extent](VkCommandBuffer cmd) {
+                    record_fullscreen_pass(cmd, frame_index, fractal, extent);
+                });
+            if (deferred_active_) {
+                fractal_pass.color(gbuffer, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+            } else {
+                fractal_pass.color(backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, clear_.color);
+            }
+            if (half_shadow != kRGNone) {
+                fractal_pass.sampled(half_shadow);
+            }
+            if (stereo_left != kRGNone) {
+                fractal_pass.sampled(stereo_left);
+            }
+            if (rate != kRGNone) {
+                fractal_pass.shading_rate(rate, shading_rate_.tile());
+            }
+        }
+
+        if (deferred_active_) {
+            const uint32_t shade = fractal_variant(kFieldShaderDeferred);
+            graph_
+                .add_pass("shade",
+                          [this, frame_index, shade, extent](VkCommandBuffer cmd) {
+                              record_fullscreen_pass(cmd, frame_index, shade, extent);
+                          })
+                .sampled(gbuffer)
+                .color(backbuffer, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        }
+    }
+    graph_.add_pass("imgui", [this](VkCommandBuffer cmd) { ctx_.imgui_record(cmd); })
+        .color(backbuffer, VK_ATTACHMENT_LOAD_OP_LOAD);
 
-    vkCmdDraw(f.cmd, 3, 1, 0, 0);
+    graph_.compile(frames_.last_submitted());
+    bind_tile_stats(frame_index);
+    if (half_shadow != kRGNone) {
+        bind_image(frame_index, kHalfShadowBinding, graph_.view(half_shadow), graph_.physical_generation());
+    }
+    if (stereo_left != kRGNone) {
+        bind_image(frame_index, kStereoLeftBinding, graph_.view(stereo_left), graph_.physical_generation());
+    }
+    if (samples != kRGNone) {
+        bind_image(frame_index, kInterleaveSamplesBinding, graph_.view(samples), graph_.physical_generation());
+        bind_image(frame_index, kHistoryBinding, history_.previous_view(), history_.generation());
+    }
+    if (interleave_active_) {
+        bind_image(frame_index, kPresentBinding, history_.current_view(), history_.generation());
+    }
+    if (deferred_active_) {
+        bind_image(frame_index, kGBufferBinding, gbuffer_.view(), gbuffer_.generation());
+    }
 
-    ctx_.imgui_render(f.cmd);
+    std::string summary = graph_.summary();
+    if (summary != graph_summary_) {
+        std::cout << summary << std::flush;
+        graph_summary_ = std::move(summary);
+    }
 
-    vkCmdEndRenderPass(f.cmd);
+    // --- Record command buffers ---
+    // Every pass records into its own secondary from the recording thread's pool; the primary
+    // only executes them in pass order.
+    frames_.reset_commands();
 
+    VkCommandBufferBeginInfo cbi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vk_check(vkBeginCommandBuffer(f.cmd, &cbi), "vkBeginCommandBuffer");
+    pacing_.begin_gpu(f.cmd, frames_.index(), frame);
+
+    const bool cost_stats = (params_.render1[3] & kDebugCostStats) != 0;
+    if (cost_stats) {
+        // The clear must not overtake the reduction of this slot's previous frame.
+        if (const uint64_t job = cost_.reduce_job(frames_.index())) {
+            compute_waits_.push_back(compute_.wait_for(job, VK_PIPELINE_STAGE_2_CLEAR_BIT));
+        }
+        cost_.begin_frame(f.cmd, frames_.index(), frame);
+    }
+    // Statistics are only collected by a march; a frame without one leaves them to the next.
+    if (params_.vrs0[0] != 0 && (!deferred_active_ || march_gbuffer_)) {
+        shading_rate_.begin_frame(f.cmd, frames_.index(), frame);
+    }
+
+    graph_.execute(f.cmd, parallel_record_ ? &record_pool_ : nullptr, [this](uint32_t thread_index) {
+        return frames_.acquire_secondary(thread_index);
+    });
+    if (interleave_active_) {
+        history_.swap();
+    }
+
+    pacing_.end_gpu(f.cmd, frames_.index());
     vk_check(vkEndCommandBuffer(f.cmd), "vkEndCommandBuffer");
 
-    // --- Submit ---
-    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const float rec_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - rec_t0).count();
+    record_cpu_ms_ = (record_cpu_ms_ == 0.0f) ? rec_ms : record_cpu_ms_ + 0.05f * (rec_ms - record_cpu_ms_);
 
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.waitSemaphoreCount = 1;
-    si.pWaitSemaphores = &f.image_acquired;
-    si.pWaitDstStageMask = &wait_stage;
-    si.commandBufferCount = 1;
-    si.pCommandBuffers = &f.cmd;
-    si.signalSemaphoreCount = 1;
-    si.pSignalSemaphores = &f.render_finished;
+    // --- Submit ---
+    std::vector<VkSemaphoreSubmitInfo> waits;
+
+    VkSemaphoreSubmitInfo acquired{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+    acquired.semaphore = f.image_acquired;
+    acquired.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    waits.push_back(acquired);
+
+    // Results of background compute jobs this frame consumes.
+    for (const AsyncCompute::Wait &w : compute_waits_) {
+        VkSemaphoreSubmitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+        wi.semaphore = w.semaphore;
+        wi.value = w.value;
+        wi.stageMask = w.stages;
+        waits.push_back(wi);
+    }
+    compute_waits_.clear();
+
+    // render_finished gates the present; the timeline value marks the frame as complete.
+    VkSemaphoreSubmitInfo signals[2]{};
+    signals[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signals[0].semaphore = f.render_finished;
+    signals[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    signals[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signals[1].semaphore = frames_.timeline();
+    signals[1].value = frame;
+    signals[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkCommandBufferSubmitInfo cbsi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+    cbsi.commandBuffer = f.cmd;
+
+    VkSubmitInfo2 si{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    si.waitSemaphoreInfoCount = static_cast<uint32_t>(waits.size());
+    si.pWaitSemaphoreInfos = waits.data();
+    si.commandBufferInfoCount = 1;
+    si.pCommandBufferInfos = &cbsi;
+    si.signalSemaphoreInfoCount = 2;
+    si.pSignalSemaphoreInfos = signals;
+
+    vk_check(vkQueueSubmit2(ctx_.graphics_queue(), 1, &si, VK_NULL_HANDLE), "vkQueueSubmit2");
+    frames_.mark_submitted();
+
+    if (cost_stats) {
+        cost_.submit_reduce(frames_.index(), frames_.timeline(), frame);
+    }
 
-    vk_check(vkQueueSubmit(ctx_.graphics_queue(), 1, &si, f.in_flight), "vkQueueSubmit");
+    pacing.cpu_frame_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - wait_t1).count();
 
     // --- Present ---
     VkPresentInfoKHR pi{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
@@ -363,7 +960,17 @@ void App::draw_frame(float time_seconds) {
     pi.pSwapchains = &sc_handle;
     pi.pImageIndices = &img_idx;
 
+    // Lets the swapchain know when this present is done with the image, for a later recreate.
+    VkSwapchainPresentFenceInfoEXT fence_info{VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT};
+    VkFence present_fence = sw_.present_fence();
+    if (present_fence) {
+        fence_info.swapchainCount = 1;
+        fence_info.pFences = &present_fence;
+        pi.pNext = &fence_info;
+    }
+
     VkResult pr = vkQueuePresentKHR(ctx_.present_queue(), &pi);
+    pacing_.presented(frame);
     if (pr == VK_ERROR_OUT_OF_DATE_KHR || pr == VK_SUBOPTIMAL_KHR || framebuffer_resized_) {
         recreate_swapchain_if_needed();
     } else {
@@ -373,11 +980,175 @@ void App::draw_frame(float time_seconds) {
     frames_.advance();
 }
 
+uint32_t App::fractal_variant(FieldShader kind) const {
+    return kind * field_count() + static_cast<uint32_t>(clamp_field_id(params_.render1[1]));
+}
+
+void App::bind_image(uint32_t frame_index, uint32_t binding, VkImageView view, uint64_t generation) {
+    // The slot's previous frame has completed, so its set can be rewritten; only do it when the
+    // view changed or its owner re-created its images.
+    if (bound_view_[frame_index][binding] == view && bound_generation_[frame_index][binding] == generation) {
+        return;
+    }
+
+    VkDescriptorImageInfo ii{};
+    ii.imageView = view;
+    ii.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet wds{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    wds.dstSet = fsq_.ds(frame_index);
+    wds.dstBinding = binding;
+    wds.descriptorCount = 1;
+    wds.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    wds.pImageInfo = &ii;
+    vkUpdateDescriptorSets(ctx_.device(), 1, &wds, 0, nullptr);
+
+    bound_view_[frame_index][binding] = view;
+    bound_generation_[frame_index][binding] = generation;
+}
+
+void App::bind_tile_stats(uint32_t frame_index) {
+    if (bound_tiles_generation_[frame_index] == shading_rate_.generation()) {
+        return;
+    }
+
+    VkDescriptorBufferInfo bi[2]{};
+    bi[0] = {shading_rate_.buffer(frame_index), 0, shading_rate_.buffer_size()};
+    bi[1] = {shading_rate_.buffer((frame_index + 1) % FrameRing::kMaxFrames), 0, shading_rate_.buffer_size()};
+
+    VkWriteDescriptorSet wds[2]{};
+    for (uint32_t i = 0; i < 2; i++) {
+        wds[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wds[i].dstSet = fsq_.ds(frame_index);
+        wds[i].dstBinding = FullscreenPipeline::kFirstTileBinding + i;
+        wds[i].descriptorCount = 1;
+        wds[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        wds[i].pBufferInfo = &bi[i];
+    }
+    vkUpdateDescriptorSets(ctx_.device(), 2, wds, 0, nullptr);
+
+    bound_tiles_generation_[frame_index] = shading_rate_.generation();
+}
+
+void App::record_fullscreen_pass(
+    VkCommandBuffer cmd, uint32_t frame_index, uint32_t variant, VkExtent2D extent, const VkRect2D *scissor) {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.pipeline(variant));
+
+    // Dynamic viewport/scissor (CRITICAL for resize correctness)
+    VkViewport vp{};
+    vp.x = 0.0f;
+    vp.y = 0.0f;
+    vp.width = static_cast<float>(extent.width);
+    vp.height = static_cast<float>(extent.height);
+    vp.minDepth = 0.0f;
+    vp.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &vp);
+
+    VkRect2D sc{};
+    sc.offset = {0, 0};
+    sc.extent = extent;
+    vkCmdSetScissor(cmd, 0, 1, scissor ? scissor : &sc);
+
+    // Bind descriptor set matching this frame-in-flight
+    VkDescriptorSet ds = fsq_.ds(frame_index);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.layout(), 0, 1, &ds, 0, nullptr);
+
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+}
+
 void App::build_ui() {
     ImGui::Begin("Fractal Controls");
 
+    const ImGuiIO &io = ImGui::GetIO();
+    ImGui::Text("Frame: %.2f ms (%.1f fps)", 1000.0f / io.Framerate, io.Framerate);
+
+    ImGui::Text("Dirty: %s (%llu frames ago)",
+                dirty_bits_to_string(last_dirty_reasons_).c_str(),
+                static_cast<unsigned long long>(frames_since_change_)); // NOLINT(runtime/int)
+    ImGui::Text("UBO uploads: %llu", static_cast<unsigned long long>(ubo_uploads_)); // NOLINT(runtime/int)
+
+    if (ImGui::TreeNode("Frame pacing")) {
+        // The current frame has no sample yet; show the last complete one.
+        if (const FramePacing::Sample *ps = pacing_.find(pacing_.latest_frame() - 1)) {
+            ImGui::Text("CPU wait %.2f ms, CPU frame %.2f ms, GPU %.2f ms, present %.2f ms",
+                        ps->cpu_wait_ms,
+                        ps->cpu_frame_ms,
+                        ps->gpu_ms,
+                        ps->present_interval_ms);
+        }
+        const std::vector<float> intervals = pacing_.present_intervals();
+        ImGui::PlotLines("Present (ms)",
+                         intervals.data(),
+                         static_cast<int>(intervals.size()),
+                         0,
+                         nullptr,
+                         0.0f,
+                         50.0f,
+                         ImVec2(0.0f, 60.0f));
+
+        ImGui::InputText("CSV", pacing_path_, sizeof(pacing_path_));
+        if (ImGui::Button("Export")) {
+            try {
+                pacing_.export_csv(pacing_path_);
+                pacing_status_ = std::string("Wrote ") + pacing_path_;
+            } catch (const std::exception &e) {
+                pacing_status_ = e.what();
+            }
+        }
+        if (!pacing_status_.empty()) {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(pacing_status_.c_str());
+        }
+        ImGui::TreePop();
+    }
+
+    ImGui::Checkbox("On-demand rendering", &on_demand_);
+    if (gpu_percent_ >= 0.0f) {
+        ImGui::Text("CPU: %.1f%%, GPU: %.1f%%, rendered: %.1f fps", cpu_percent_, gpu_percent_, rendered_fps_);
+    } else {
+        ImGui::Text("CPU: %.1f%%, GPU: n/a, rendered: %.1f fps", cpu_percent_, rendered_fps_);
+    }
+
+    ImGui::Checkbox("Parallel recording", &parallel_record_);
+    ImGui::SameLine();
+    const uint32_t record_threads = parallel_record_ ? record_pool_.thread_count() : 1u;
+    ImGui::Text("CPU record: %.3f ms (%u threads)", record_cpu_ms_, record_threads);
+
+    ImGui::Text("Deferred deletions: %zu", deletion_.size());
+    ImGui::Text("Async compute: %s family %u, %u jobs in flight",
+                compute_.dedicated() ? "dedicated" : "graphics",
+                compute_.family(),
+                compute_.jobs_in_flight());
+
+    const RenderGraph::Stats &gs = graph_.stats();
+    ImGui::Text("Graph: %u passes (%u culled), %u barriers, transient %.2f/%.2f MiB",
+                gs.passes,
+                gs.culled,
+                gs.barriers,
+                static_cast<double>(gs.transient_bytes) / (1024.0 * 1024.0),
+                static_cast<double>(gs.heap_bytes) / (1024.0 * 1024.0));
+
+    ImGui::Separator();
+
     ImGui::Text("Camera");
-    ImGui::DragFloat3("Position", &camera_.position.x, 0.01f);
+    glm::vec3 cam_pos = camera_.position;
+    if (ImGui::DragFloat3("Position", &cam_pos.x, 0.01f)) {
+        sim_.teleport(cam_pos);
+    }
+
+    ImGui::Separator();
+
+    ImGui::Text("Stereo");
+
+    const char *stereo_modes[] = {"Mono", "Side-by-side"};
+    ImGui::Combo("Mode", &params_.render2[0], stereo_modes, IM_ARRAYSIZE(stereo_modes));
+    ImGui::SliderFloat("IPD", &params_.stereo0[0], 0.0f, 0.5f, "%.4f");
+    ImGui::SliderFloat("Convergence", &params_.stereo0[1], 0.0f, 10.0f, "%.3f");
+    ImGui::Checkbox("Warm-start right eye", &stereo_warm_enabled_);
+    if (stereo_warm_enabled_ && params_.render2[0] == 1 && !deferred_active_) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("(needs deferred shading)");
+    }
 
     ImGui::Separator();
 
@@ -385,20 +1156,188 @@ void App::build_ui() {
     ImGui::SliderInt("Max steps", &params_.render1[0], 16, 2048);
     ImGui::SliderFloat("Max dist", &params_.render0[0], 1e-3f, 10.0f, "%.6f", ImGuiSliderFlags_Logarithmic);
     ImGui::SliderFloat("Hit eps", &params_.render0[1], 1e-6f, 1e-2f, "%.6f", ImGuiSliderFlags_Logarithmic);
-    ImGui::SliderFloat("Normal eps", &params_.render0[4], 1e-6f, 1e-2f, "%.6f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("Over-relaxation", &params_.march0[1], 1.0f, 1.9f, "%.2f");
+    ImGui::SliderFloat("Lipschitz bound", &params_.march0[0], 0.5f, 4.0f, "%.2f");
+    ImGui::SliderFloat("Max step", &params_.march0[2], 0.01f, 2.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Refine steps", &params_.march1[0], 0, 64);
+    bool bounds = params_.march1[1] != 0;
+    if (ImGui::Checkbox("Bounding volume", &bounds)) {
+        params_.march1[1] = bounds ? 1 : 0;
+    }
+    const char *normal_modes[] = {"Tetrahedral", "Analytic"};
+    ImGui::Combo("Normals", &params_.render3[2], normal_modes, IM_ARRAYSIZE(normal_modes));
+    if (params_.render3[2] == kNormalsAnalytic && !field_info(params_.render1[1]).has_normal) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("(not available, tetrahedral)");
+    }
+    ImGui::SliderFloat("Normal eps", &params_.render0[2], 1e-6f, 1e-2f, "%.6f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("AO iterations", &params_.render3[3], 0, 64, params_.render3[3] > 0 ? "%d" : "all");
+
+    ImGui::Separator();
+
+    ImGui::Text("Shadows");
+    const char *shadow_modes[] = {"Off", "Full resolution", "Half resolution"};
+    ImGui::Combo("Shadows", &params_.render3[0], shadow_modes, IM_ARRAYSIZE(shadow_modes));
+    ImGui::SliderInt("Shadow steps", &params_.render3[1], 4, 256);
+    ImGui::SliderFloat("Sharpness", &params_.shadow0[0], 2.0f, 64.0f);
+    ImGui::SliderFloat("Shadow dist", &params_.shadow0[1], 0.1f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+    ImGui::ColorEdit3("Palette low", params_.palette0);
+    ImGui::ColorEdit3("Palette high", params_.palette1);
+
+    ImGui::Separator();
+
+    ImGui::Text("Deferred shading");
+    ImGui::Checkbox("Deferred", &deferred_enabled_);
+    ImGui::Text("Last frame: %s", deferred_status_);
+
+    ImGui::Separator();
+
+    ImGui::Text("Interleaved rendering");
+    const char *interleave_modes[] = {"Off", "Checkerboard (1/2)", "Quarter (1/4)"};
+    ImGui::Combo("Interleave", &interleave_mode_, interleave_modes, IM_ARRAYSIZE(interleave_modes));
+    ImGui::SliderFloat("Full frame above", &interleave_max_motion_, 0.1f, 10.0f, "%.1f deg/frame");
+    ImGui::Text("Last frame: %s", interleave_status_);
+
+    ImGui::Separator();
+
+    ImGui::Text("Variable-rate shading");
+    if (ctx_.shading_rate_supported()) {
+        ImGui::Checkbox("Coarse tiles", &vrs_enabled_);
+        if (vrs_enabled_) {
+            ImGui::SameLine();
+            ImGui::Text("(%s)", vrs_status_);
+        }
+        ImGui::SliderFloat("2x2 normal spread", &params_.vrs1[0], 1e-3f, 0.2f, "%.3f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("2x2 step budget", &params_.vrs1[1], 0.01f, 1.0f, "%.2f of max steps");
+        ImGui::SliderInt("Refresh period", &params_.vrs2[1], 2, 32, "every %d frames");
+    } else {
+        ImGui::TextUnformatted("(VK_KHR_fragment_shading_rate not supported)");
+    }
+
+    ImGui::Separator();
+
+    ImGui::Text("Cost statistics");
+    int &debug_flags = params_.render1[3];
+    bool cost_stats = (debug_flags & kDebugCostStats) != 0;
+    if (ImGui::Checkbox("Collect", &cost_stats)) {
+        debug_flags = cost_stats ? (debug_flags | kDebugCostStats) : (debug_flags & ~kDebugCostStats);
+    }
+    const char *heatmaps[] = {"Off", "March steps", "Field iterations", "Refine steps", "Shading evals"};
+    int heatmap = (debug_flags & kDebugHeatmapMask) >> kDebugHeatmapShift;
+    if (ImGui::Combo("Heatmap", &heatmap, heatmaps, IM_ARRAYSIZE(heatmaps))) {
+        debug_flags = (debug_flags & ~kDebugHeatmapMask) | (heatmap << kDebugHeatmapShift);
+    }
+    bool normal_error = (debug_flags & kDebugNormalError) != 0;
+    if (ImGui::Checkbox("Normal error", &normal_error)) {
+        debug_flags = normal_error ? (debug_flags | kDebugNormalError) : (debug_flags & ~kDebugNormalError);
+    }
+    if (normal_error) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("analytic vs tetrahedral, red = 10 degrees");
+    }
+
+    const CostStats::Summary &cs = cost_.latest();
+    if (cost_stats && cs.frame != 0) {
+        ImGui::Text("Pixels: %u, hit: %u", cs.pixels, cs.hits);
+        if (cs.hits > 0) {
+            // The refinement used to bisect a fixed 16 times on every hit.
+            const float per_hit = cs.mean[CostStats::kRefineSteps] * static_cast<float>(cs.pixels) /
+                                  static_cast<float>(cs.hits);
+            ImGui::Text("Refine: %.1f evaluations per hit pixel, %.1f fewer than 16 bisection steps",
+                        per_hit,
+                        16.0f - per_hit);
+        }
+        if (ImGui::BeginTable("cost_stats", 6, ImGuiTableFlags_Borders)) {
+            ImGui::TableSetupColumn("Counter");
+            ImGui::TableSetupColumn("Mean");
+            ImGui::TableSetupColumn("p50");
+            ImGui::TableSetupColumn("p90");
+            ImGui::TableSetupColumn("p99");
+            ImGui::TableSetupColumn("Max");
+            ImGui::TableHeadersRow();
+            for (uint32_t c = 0; c < CostStats::kCounters; c++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(CostStats::counter_name(c));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", cs.mean[c]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", cs.p50[c]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", cs.p90[c]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", cs.p99[c]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", cs.max_value[c]);
+            }
+            ImGui::EndTable();
+        }
+    }
 
     ImGui::Separator();
 
     ImGui::Text("Fractal");
 
-    const char *fields[] = {"Sphere", "Box", "Mandelbulb", "Mandelbox", "Julia"};
+    const FieldInfo &field = field_info(params_.render1[1]);
+    if (ImGui::BeginCombo("Field", field.name)) {
+        for (uint32_t i = 0; i < field_count(); i++) {
+            const bool selected = static_cast<int>(i) == params_.render1[1];
+            if (ImGui::Selectable(field_info(static_cast<int>(i)).name, selected) && !selected) {
+                select_field(static_cast<int>(i));
+            }
+        }
+        ImGui::EndCombo();
+    }
 
-    ImGui::Combo("Field", &params_.render1[1], fields, IM_ARRAYSIZE(fields));
+    if (field.uses_iterations) {
+        ImGui::SliderInt("Iterations", &params_.render1[2], 16, 2048);
+        ImGui::SliderFloat("LOD aggressiveness", &params_.march0[3], 0.0f, 4.0f, "%.2f");
+    }
+    for (uint32_t i = 0; i < field.param_count; i++) {
+        const FieldParamInfo &fp = field.params[i];
+        float *v = &params_.field_params[fp.slot];
+        if (fp.type == FieldParamType::Vec3) {
+            ImGui::SliderFloat3(fp.name, v, fp.min, fp.max);
+        } else {
+            ImGui::SliderFloat(fp.name, v, fp.min, fp.max);
+        }
+    }
 
-    ImGui::SliderFloat3("Julia C", &params_.julia_c[0], -2.0f, 2.0f);
-    ImGui::SliderInt("Iterations", &params_.render1[2], 16, 2048);
-    ImGui::SliderFloat("Power", &params_.fractal0[1], 2.0f, 32.0f);
-    ImGui::SliderFloat("Bailout", &params_.fractal0[0], 1.0f, 200.0f);
+    ImGui::Separator();
+
+    ImGui::Text("Parameter atlas");
+    ImGui::Checkbox("Show atlas", &atlas_enabled_);
+    if (atlas_enabled_) {
+        const std::vector<ParamAtlas::Lane> lanes = ParamAtlas::lanes(params_.render1[1]);
+        ImGui::SliderInt("Grid", &atlas_.grid, 2, static_cast<int>(ParamAtlas::kMaxGrid));
+        const char *axis_names[] = {"Columns", "Rows"};
+        for (int a = 0; a < 2 && !lanes.empty(); a++) {
+            ParamAtlas::Axis &axis = atlas_.axes[a];
+            const auto lane = std::find_if(lanes.begin(), lanes.end(), [&](const ParamAtlas::Lane &l) {
+                return static_cast<int>(l.slot) == axis.slot;
+            });
+            ImGui::PushID(a);
+            if (ImGui::BeginCombo(axis_names[a], (lane != lanes.end()) ? lane->name.c_str() : "-")) {
+                for (const ParamAtlas::Lane &l : lanes) {
+                    if (ImGui::Selectable(l.name.c_str(), static_cast<int>(l.slot) == axis.slot)) {
+                        axis = {static_cast<int>(l.slot), l.min, l.max};
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            if (lane != lanes.end()) {
+                ImGui::SliderFloat("From", &axis.from, lane->min, lane->max, "%.4f");
+                ImGui::SliderFloat("To", &axis.to, lane->min, lane->max, "%.4f");
+            }
+            ImGui::PopID();
+        }
+        if (lanes.empty()) {
+            ImGui::TextUnformatted("(the field has no parameters)");
+        } else {
+            ImGui::TextUnformatted(mouse_locked_ ? "Unlock the mouse (C) to pick a thumbnail"
+                                                 : "Click a thumbnail to adopt its parameters");
+        }
+    }
 
     ImGui::Separator();
 
@@ -406,33 +1345,319 @@ void App::build_ui() {
 
     const char *animated_params[] = {
         "None", "Julia C.x", "Julia C.y", "Julia C.z", "Julia C.xy", "Julia C.yz", "Julia C.xz"};
-    ImGui::Combo("Param", &animated_param_, animated_params, IM_ARRAYSIZE(animated_params));
+    if (ImGui::Combo("Param", &animated_param_, animated_params, IM_ARRAYSIZE(animated_params))) {
+        sim_.set_animated_param(animated_param_);
+    }
+
+    ImGui::Separator();
+
+    ImGui::Text("Camera path");
+    ImGui::InputText("Path file", path_file_, sizeof(path_file_));
+    if (path_mode_ == PathMode::Recording) {
+        if (ImGui::Button("Stop recording")) {
+            path_mode_ = PathMode::Idle;
+        }
+        ImGui::SameLine();
+        ImGui::Text("%zu keys, %.1f s", path_.size(), path_.duration());
+    } else if (path_mode_ == PathMode::Playing) {
+        if (ImGui::Button("Stop playback")) {
+            stop_playback();
+        }
+        ImGui::SameLine();
+        const double t = path_fixed_step_ ? static_cast<double>(path_frames_) / static_cast<double>(path_fps_)
+                                          : sim_.now() - path_t0_;
+        ImGui::ProgressBar(static_cast<float>(t / std::max(path_.duration(), 1e-6)));
+    } else {
+        if (ImGui::Button("Record")) {
+            path_.clear();
+            path_t0_ = sim_.now();
+            path_mode_ = PathMode::Recording;
+            path_status_.clear();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Play") && !path_.empty()) {
+            start_playback();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save")) {
+            try {
+                path_.save(path_file_);
+                path_status_ = std::format("Wrote {} keys to {}", path_.size(), path_file_);
+            } catch (const std::exception &e) {
+                path_status_ = e.what();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load")) {
+            try {
+                path_.load(path_file_);
+                path_status_ = std::format("Loaded {} keys, {:.1f} s", path_.size(), path_.duration());
+            } catch (const std::exception &e) {
+                path_status_ = e.what();
+            }
+        }
+    }
+    ImGui::Checkbox("Fixed step", &path_fixed_step_);
+    ImGui::SameLine();
+    ImGui::SliderInt("Step fps", &path_fps_, 10, 240);
+    if (!path_status_.empty()) {
+        ImGui::TextUnformatted(path_status_.c_str());
+    }
+
+    ImGui::Separator();
+
+    ImGui::Text("Export mesh");
+    ImGui::SliderInt("Resolution", &mesh_resolution_, 64, 2048);
+    ImGui::SliderFloat("Extent", &mesh_extent_, 0.5f, 4.0f);
+
+    const char *mesh_formats[] = {"STL", "PLY"};
+    ImGui::Combo("Format", &mesh_format_, mesh_formats, IM_ARRAYSIZE(mesh_formats));
+    ImGui::InputText("File", mesh_path_, sizeof(mesh_path_));
+
+    if (mesh_running_) {
+        const uint32_t total = std::max(mesh_progress_.tiles_total.load(), 1u);
+        ImGui::ProgressBar(static_cast<float>(mesh_progress_.tiles_done) / static_cast<float>(total));
+        if (ImGui::Button("Cancel")) {
+            mesh_progress_.cancel = true;
+        }
+    } else if (ImGui::Button("Export")) {
+        start_mesh_export();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mesh_status_mutex_);
+        if (!mesh_status_.empty()) {
+            ImGui::TextUnformatted(mesh_status_.c_str());
+        }
+    }
 
     ImGui::End();
 }
 
+void App::play_on_start(const std::string &path, int fps) {
+    path_.load(path);
+    if (path_.empty()) {
+        throw std::runtime_error("Camera path is empty: " + path);
+    }
+    path_fixed_step_ = fps > 0;
+    path_fps_ = std::max(fps, 1);
+    path_exit_at_end_ = true;
+}
+
+void App::apply_camera_path(double sim_time, SimFrame &sim, double &frame_time) {
+    if (path_mode_ == PathMode::Recording) {
+        path_.record(sim_time - path_t0_, sim);
+        return;
+    }
+    if (path_mode_ != PathMode::Playing) {
+        return;
+    }
+
+    const double t = path_fixed_step_ ? static_cast<double>(path_frames_) / static_cast<double>(path_fps_)
+                                      : sim_time - path_t0_;
+    sim = path_.sample(t);
+    frame_time = t;
+    path_frames_++;
+    if (t >= path_.duration()) {
+        stop_playback();
+    }
+}
+
+void App::start_playback() {
+    path_mode_ = PathMode::Playing;
+    path_t0_ = sim_.now();
+    path_frames_ = 0;
+    path_wall0_ = std::chrono::steady_clock::now();
+    path_status_.clear();
+}
+
+void App::stop_playback() {
+    path_mode_ = PathMode::Idle;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - path_wall0_).count();
+    path_status_ = std::format("Played {} frames in {:.2f} s ({:.2f} ms/frame)",
+                               path_frames_,
+                               seconds,
+                               1000.0 * seconds / std::max(path_frames_, 1u));
+    std::cout << path_status_ << "\n";
+
+    // Continue interactively from where the path ended, looking the way it ended.
+    const SimFrame end = path_.sample(path_.duration());
+    sim_.teleport(end.position, end.orientation);
+    if (path_exit_at_end_) {
+        glfwSetWindowShouldClose(window_, GLFW_TRUE);
+    }
+}
+
+void App::select_field(int field_id) {
+    params_.render1[1] = clamp_field_id(field_id);
+    field_default_params(params_.render1[1], params_.field_params);
+    params_.march0[0] = field_info(params_.render1[1]).lipschitz;
+}
+
+void App::start_mesh_export() {
+    stop_mesh_export();
+
+    FieldParams field;
+    field.field_id = params_.render1[1];
+    field.iterations = params_.render1[2];
+    if (const FieldParamInfo *p = find_field_param(field.field_id, "bailout")) {
+        field.bailout = params_.field_params[p->slot];
+    }
+    if (const FieldParamInfo *p = find_field_param(field.field_id, "power")) {
+        field.power = params_.field_params[p->slot];
+    }
+    if (const FieldParamInfo *p = find_field_param(field.field_id, "c")) {
+        const float *c = &params_.field_params[p->slot];
+        field.julia_c = {c[0], c[1], c[2]};
+    }
+
+    MeshOptions opts;
+    opts.bounds_min = glm::vec3(-mesh_extent_);
+    opts.bounds_max = glm::vec3(mesh_extent_);
+    opts.resolution = static_cast<uint32_t>(mesh_resolution_);
+    opts.path = mesh_path_;
+    opts.format = (mesh_format_ == 1) ? MeshFormat::Ply : MeshFormat::Stl;
+
+    mesh_progress_.cancel = false;
+    mesh_progress_.tiles_done = 0;
+    mesh_running_ = true;
+
+    mesh_thread_ = std::thread([this, field, opts] {
+        std::string status;
+        try {
+            const MeshStats st = extract_mesh(field, opts, &mesh_progress_);
+            if (mesh_progress_.cancel) {
+                status = "Export cancelled";
+            } else {
+                status = std::format(
+                    "{}: {} tris, {} verts, {:.1f} s", opts.path, st.triangles, st.vertices, st.seconds);
+            }
+        } catch (const std::exception &e) {
+            status = std::format("Export failed: {}", e.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mesh_status_mutex_);
+            mesh_status_ = status;
+            mesh_running_ = false;
+        }
+        glfwPostEmptyEvent(); // wake the on-demand loop to show the result
+    });
+}
+
+void App::stop_mesh_export() {
+    if (mesh_thread_.joinable()) {
+        mesh_progress_.cancel = true;
+        mesh_thread_.join();
+    }
+}
+
+bool App::window_hidden() const {
+    int w = 0, h = 0;
+    glfwGetFramebufferSize(window_, &w, &h);
+    return w <= 0 || h <= 0 || glfwGetWindowAttrib(window_, GLFW_ICONIFIED) ||
+           !glfwGetWindowAttrib(window_, GLFW_VISIBLE);
+}
+
+bool App::needs_redraw() const {
+    return !on_demand_ || redraw_frames_ > 0 || animated_param_ != 0 || mesh_running_ || sim_.active() ||
+           path_mode_ != PathMode::Idle;
+}
+
+double App::present_lead_seconds() const {
+    const FramePacing::Sample *ps = pacing_.find(pacing_.latest_frame());
+    if (!ps) {
+        return 0.0;
+    }
+    // The first frame after an idle wait reports the whole wait, hence the cap.
+    return std::min(static_cast<double>(ps->present_interval_ms) * 1e-3, kMaxPresentLeadSeconds);
+}
+
+void App::update_usage_stats(bool rendered) {
+    const auto now = std::chrono::steady_clock::now();
+    if (rendered) {
+        usage_frames_++;
+    }
+
+    const double wall = std::chrono::duration<double>(now - usage_t0_).count();
+    if (wall < 1.0) {
+        return;
+    }
+
+    const double cpu = process_cpu_seconds();
+    cpu_percent_ = static_cast<float>(100.0 * (cpu - usage_cpu0_) / wall);
+    rendered_fps_ = static_cast<float>(usage_frames_ / wall);
+
+    // GPU busy: the GPU times of the frames resolved since the last window. A frame's time is read
+    // when its slot is reused, kMaxFrames frames later, so the window lags by that many frames.
+    const uint64_t latest = pacing_.latest_frame();
+    const uint64_t resolved = (latest > FrameRing::kMaxFrames) ? latest - FrameRing::kMaxFrames : 0;
+    if (pacing_.gpu_timing()) {
+        const double gpu_ms = pacing_.gpu_ms_sum(usage_gpu_frame_ + 1, resolved);
+        gpu_percent_ = static_cast<float>(100.0 * gpu_ms * 1e-3 / wall);
+    }
+    usage_gpu_frame_ = std::max(usage_gpu_frame_, resolved);
+
+    usage_t0_ = now;
+    usage_cpu0_ = cpu;
+    usage_frames_ = 0;
+}
+
 void App::run() {
     init_window();
     init_vulkan();
 
-    auto t0 = std::chrono::high_resolution_clock::now();
-    auto last_t1 = std::chrono::high_resolution_clock::now();
+    usage_t0_ = std::chrono::steady_clock::now();
+    usage_cpu0_ = process_cpu_seconds();
+
+    sim_.start(camera_);
+    if (path_exit_at_end_) {
+        start_playback();
+    }
 
     while (!glfwWindowShouldClose(window_)) {
-        glfwPollEvents();
-        auto t1 = std::chrono::high_resolution_clock::now();
-        float sec = std::chrono::duration<float>(t1 - t0).count();
-        float dt = std::chrono::duration<float>(t1 - last_t1).count();
-        last_t1 = t1;
-        camera_.processKeyboard(glfwGetKey(window_, GLFW_KEY_W) == GLFW_PRESS,
-                                glfwGetKey(window_, GLFW_KEY_S) == GLFW_PRESS,
-                                glfwGetKey(window_, GLFW_KEY_A) == GLFW_PRESS,
-                                glfwGetKey(window_, GLFW_KEY_D) == GLFW_PRESS,
-                                glfwGetKey(window_, GLFW_KEY_Q) == GLFW_PRESS,
-                                glfwGetKey(window_, GLFW_KEY_E) == GLFW_PRESS,
-                                dt);
-
-        draw_frame(sec);
+        if (window_hidden()) {
+            // Minimized: nothing to present, sleep until the window comes back.
+            glfwWaitEvents();
+            update_usage_stats(false);
+            continue;
+        }
+
+        if (needs_redraw()) {
+            glfwPollEvents();
+        } else {
+            // Idle: block until input arrives. The timeout only bounds how stale the
+            // utilisation readout in the overlay can get.
+            glfwWaitEventsTimeout(kIdleTimeoutSeconds);
+            if (!needs_redraw()) {
+                update_usage_stats(false);
+                continue;
+            }
+        }
+
+        // Camera motion comes from the simulation thread, sampled for the time this frame is
+        // expected on screen: now plus the last present interval. A slow frame only delays the
+        // picture, not the input. Camera paths stay keyed by build time, which is the same offset
+        // on record and playback.
+        const double t = sim_.now();
+        const double present_t = t + present_lead_seconds();
+        SimFrame sim = sim_.sample(present_t);
+        double frame_time = present_t;
+        apply_camera_path(t, sim, frame_time);
+
+        if (redraw_frames_ > 0) {
+            redraw_frames_--;
+        }
+
+        draw_frame(static_cast<float>(frame_time), sim);
+
+        // Any parameter change (e.g. a slider drag) keeps the loop awake for a few more frames.
+        if (params_tracker_.last_dirty() != 0) {
+            request_redraw();
+        }
+
+        update_usage_stats(true);
     }
 
     shutdown();
@@ -7,52 +7,120 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include "app/camera_path.hpp"
+#include "app/field_registry.hpp"
+#include "app/gpu_params.hpp"
+#include "app/param_atlas.hpp"
+#include "app/simulation.hpp"
+#include "gfx/async_compute.hpp"
 #include "gfx/camera.hpp"
+#include "gfx/cost_stats.hpp"
+#include "gfx/deletion_queue.hpp"
+#include "gfx/frame_pacing.hpp"
 #include "gfx/frame_resources.hpp"
+#include "gfx/gbuffer.hpp"
 #include "gfx/fullscreen_pipeline.hpp"
+#include "gfx/history_images.hpp"
+#include "gfx/render_graph.hpp"
+#include "gfx/shading_rate.hpp"
 #include "gfx/swapchain.hpp"
 #include "gfx/vk_context.hpp"
-
-struct alignas(16) GpuParams {
-    float cam_pos[4] = {0, 0, 3, 0};
-
-    // Camera basis (supports roll):
-    // fw = forward, rt = right, up = up
-    float cam_fw[4] = {0, 0, -1, 0};
-    float cam_rt[4] = {1, 0, 0, 0};
-    float cam_up[4] = {0, 1, 0, 0};
-
-    float render0[4] = {100.0f, 1e-3f, 1e-3f, 1.2f}; // max_dist, hit_eps, normal_eps, fov
-    int render1[4] = {256, 0, 12, 0};                // max_steps, field_id, iterations, debug_flags
-
-    float fractal0[4] = {8.0f, 8.0f, 0.0f, 0.0f}; // bailout, power, ...
-    float julia_c[4] = {0.3, 0.5, -0.2, 0.0f};    // Julia set constant
-    float misc0[4] = {0.0f, 1.0f, 0.0f, 0.0f};    // time, aspect, ...
-};
-static_assert(sizeof(GpuParams) % 16 == 0);
+#include "mesh/mesher.hpp"
+#include "util/thread_pool.hpp"
 
 class App {
 public:
     void run();
     void on_framebuffer_resize(int width, int height);
     void on_mouse_move(double x, double y);
+    void on_mouse_button(int button, bool down);
     void on_field_change(int d);
+    void on_key(int key, bool down);
+    void on_focus(bool focused);
     bool mouse_locked() { return mouse_locked_; }
     void toggle_mouse_lock() { mouse_locked_ = !mouse_locked_; }
 
+    // Keeps the on-demand loop rendering for a few frames so ImGui can settle after input.
+    void request_redraw() { redraw_frames_ = kRedrawFrames; }
+
+    // Plays the camera path file from the first frame and closes the window at its end, for
+    // benchmarks. fps > 0 advances the path by 1 / fps per rendered frame, 0 by the wall clock.
+    void play_on_start(const std::string &path, int fps);
+
 private:
     void init_window();
     void init_vulkan();
     void shutdown();
 
-    void draw_frame(float time_seconds);
+    void draw_frame(float time_seconds, const SimFrame &sim);
+    void update_params(float time_seconds, const SimFrame &sim);
+    // Parameter atlas: fills GpuParams::atlas0 and this frame slot's thumbnail parameters.
+    void update_atlas();
     void recreate_swapchain_if_needed();
+    // Pipeline of the current field for one of its shader kinds.
+    uint32_t fractal_variant(FieldShader kind) const;
+    // Draws `variant` over `extent`; a scissor limits it to part of the target.
+    void record_fullscreen_pass(VkCommandBuffer cmd,
+                                uint32_t frame_index,
+                                uint32_t variant,
+                                VkExtent2D extent,
+                                const VkRect2D *scissor = nullptr);
+    // Points a sampled image binding of the frame slot's descriptor set at `view`. generation is
+    // that of the view's owner (render graph transients, history images), so views re-created
+    // under the same handle are rebound too.
+    void bind_image(uint32_t frame_index, uint32_t binding, VkImageView view, uint64_t generation);
+
+    // Interleaved rendering: chooses between an interleaved and a full frame from the params
+    // that changed (`dirty`) and fills GpuParams::interleave0 and prev_cam_*.
+    void update_interleave(uint32_t dirty);
+    // Variable-rate shading: sizes the tile statistics for the framebuffer and fills
+    // GpuParams::vrs0 and vrs2 from the params that changed (`dirty`). The shading rate image is
+    // only used outside interleaved rendering, and not in a frame where nothing changed.
+    void update_shading_rate(uint32_t dirty);
+    // Deferred shading: decides whether this frame marches into the G-buffer or only shades from
+    // the previous frame's, from the params that changed (`dirty`).
+    void update_deferred(uint32_t dirty);
+    // Points the tile statistics bindings of the frame slot's descriptor set at the slot's buffer
+    // (written this frame) and the other slot's (written by the previous frame).
+    void bind_tile_stats(uint32_t frame_index);
 
     void build_ui();
+    // Switches to `field_id` (clamped) and resets field_params to that field's defaults.
+    void select_field(int field_id);
+
+    void start_mesh_export();
+    void stop_mesh_export();
+
+    // Camera path: records the frame's pose, or replaces it (and the time) with the playback's.
+    void apply_camera_path(double sim_time, SimFrame &sim, double &frame_time);
+    void start_playback();
+    void stop_playback();
+
+    bool window_hidden() const;
+    bool needs_redraw() const;
+    void update_usage_stats(bool rendered);
+    // Estimated time from building a frame to presenting it, from the last present interval.
+    double present_lead_seconds() const;
+
+    static constexpr int kRedrawFrames = 3;
+    static constexpr double kIdleTimeoutSeconds = 0.5;
+    static constexpr double kMaxPresentLeadSeconds = 0.05;
+
+    // Upper bound for any wait on the GPU or the swapchain; exceeding it means a hang.
+    static constexpr uint64_t kGpuTimeoutNs = 5'000'000'000ull;
+
+    // Worker threads recording render graph passes next to the main thread.
+    static constexpr uint32_t kRecordWorkers = 1;
 
     GLFWwindow *window_{};
     uint32_t win_w_ = 1280;
@@ -60,23 +128,148 @@ private:
     bool framebuffer_resized_ = false;
 
     VkContext ctx_;
+    DeletionQueue deletion_; // objects retired while frames in flight may still use them
     Swapchain sw_;
     FullscreenPipeline fsq_;
     FrameRing frames_;
+    RenderGraph graph_;
 
-    VkClearValue clear_{};
+    // Background GPU jobs (the cost statistics reduction); the next frame submit waits on
+    // compute_waits_ (jobs whose buffers it reuses or results it reads).
+    AsyncCompute compute_;
+    std::vector<AsyncCompute::Wait> compute_waits_;
+
+    FramePacing pacing_;
+    char pacing_path_[256] = "frame_pacing.csv";
+    std::string pacing_status_;
+
+    CostStats cost_;
 
-    float cam_yaw_ = 0.0f;
-    float cam_pitch_ = 0.0f;
-    float cam_radius_ = 4.0f;
-    glm::vec3 cam_target_ = {0, 0, 0};
+    static constexpr VkFormat kHalfShadowFormat = VK_FORMAT_R16G16_SFLOAT; // hit t, shadow
+    static constexpr uint32_t kHalfShadowBinding = 2;
 
-    Camera camera_;
+    // Image views each frame slot's descriptor set points at, and the generation of their owner.
+    VkImageView bound_view_[FrameRing::kMaxFrames][FullscreenPipeline::kBindings]{};
+    uint64_t bound_generation_[FrameRing::kMaxFrames][FullscreenPipeline::kBindings]{};
+
+    // Interleaved rendering: each frame marches a checkerboard half or a quarter of the pixels
+    // into a compact sample image and reconstructs the rest from the previous frame (history_),
+    // which is then presented. Frames at rest, after other changes or with fast camera motion
+    // are rendered in full.
+    static constexpr VkFormat kHistoryFormat = VK_FORMAT_R16G16B16A16_SFLOAT; // colour, hit t
+    static constexpr uint32_t kInterleaveSamplesBinding = 3;
+    static constexpr uint32_t kHistoryBinding = 4;
+    static constexpr uint32_t kPresentBinding = 5;
+    HistoryImages history_;
+    int interleave_mode_ = kInterleaveFull; // kInterleave*, full = off
+    float interleave_max_motion_ = 2.0f;    // degrees of camera motion per frame before a full frame
+    bool interleave_active_ = false;        // this frame renders through the history images
+    bool history_valid_ = false;            // previous frame's history image holds a complete frame
+    uint32_t interleave_phase_ = 0;
+    const char *interleave_status_ = "off";
+    glm::vec3 history_cam_[3]{}; // position, forward, right of the camera history_ was rendered with
+    uint32_t reconstruct_variant_ = 0;
+    uint32_t present_variant_ = 0;
+
+    // Variable-rate shading: a pass at one fragment per tile turns the previous frame's tile
+    // statistics into a shading rate image, and the fractal pass shades background tiles at 4x4
+    // and flat, cheap surface tiles at 2x2. Needs VK_KHR_fragment_shading_rate.
+    static constexpr VkFormat kShadingRateFormat = VK_FORMAT_R8_UINT;
+    ShadingRate shading_rate_;
+    bool vrs_enabled_ = false;
+    const char *vrs_status_ = "off";
+    uint32_t shading_rate_variant_ = 0;
+    uint64_t bound_tiles_generation_[FrameRing::kMaxFrames]{};
+
+    // Deferred shading: the march pass writes hit distance, normal, orbit trap and steps into a
+    // G-buffer that outlives the frame, and a shading pass computes ambient occlusion, shadows
+    // and colour from it. Frames in which only shading inputs (lighting, palette, the march
+    // steps heatmap, the UI) changed skip the march. Interleaved frames and the other debug
+    // views render forward.
+    static constexpr uint32_t kGBufferBinding = 6;
+    GBuffer gbuffer_;
+    bool deferred_enabled_ = true;
+    bool deferred_active_ = false; // this frame shades from the G-buffer
+    bool march_gbuffer_ = false;   // this frame marches into the G-buffer first
+    bool gbuffer_valid_ = false;   // the G-buffer holds a march of the current inputs
+    int gbuffer_normal_mode_ = -1; // kNormals* the G-buffer normals were estimated with
+    const char *deferred_status_ = "off";
+
+    // Stereo warm start: in side-by-side stereo the left eye is marched into its own G-buffer
+    // first, and each right-eye ray starts past the surfaces the left eye rules out
+    // (RAYMARCH_GBUFFER_STEREO). Needs deferred shading. The image shares binding 3 with the
+    // interleaved samples, which are never used in stereo.
+    static constexpr uint32_t kStereoLeftBinding = 3;
+    bool stereo_warm_enabled_ = true;
+    bool stereo_warm_active_ = false; // this frame marches the eyes in two passes
+
+    // Parameter atlas: the whole frame becomes a grid of thumbnails sweeping two field parameters,
+    // marched in a single pass; clicking a thumbnail adopts its parameters. Interleaved, deferred
+    // and variable-rate shading are off while it is shown.
+    ParamAtlas atlas_;
+    bool atlas_enabled_ = false;
+    int atlas_field_ = -1; // field the atlas axes were chosen for
+
+    std::string graph_summary_; // last summary printed, reprinted when the graph changes
+
+    // Records the passes of a frame in parallel; thread i records into its own per-frame pool.
+    ThreadPool record_pool_{kRecordWorkers};
+    bool parallel_record_ = true;
+    float record_cpu_ms_ = 0.0f; // smoothed CPU time to record and end the frame's command buffers
+
+    VkClearValue clear_{};
+
+    Camera camera_; // pose of the frame being rendered, interpolated from sim_
+    Simulation sim_;
     bool first_mouse_ = true;
     double last_x_, last_y_;
 
     GpuParams params_{};
     int animated_param_ = 0;
 
+    // Change tracking for params_: UBO slots are only rewritten when the generation moves.
+    ParamsTracker params_tracker_;
+    uint32_t last_dirty_reasons_ = 0;
+    uint64_t frames_since_change_ = 0;
+    uint64_t ubo_uploads_ = 0;
+
     bool mouse_locked_ = true;
+
+    // On-demand rendering: when nothing changes the loop blocks in glfwWaitEventsTimeout.
+    bool on_demand_ = true;
+    int redraw_frames_ = kRedrawFrames;
+
+    std::chrono::steady_clock::time_point usage_t0_{};
+    double usage_cpu0_ = 0.0;
+    uint32_t usage_frames_ = 0;
+    float cpu_percent_ = 0.0f;
+    float rendered_fps_ = 0.0f;
+    uint64_t usage_gpu_frame_ = 0; // last frame whose GPU time went into gpu_percent_
+    float gpu_percent_ = -1.0f;    // < 0 without timestamps
+
+    // Mesh export runs on its own thread so the interactive frame keeps going.
+    std::thread mesh_thread_;
+    MeshProgress mesh_progress_;
+    std::atomic<bool> mesh_running_{false};
+    std::mutex mesh_status_mutex_;
+    std::string mesh_status_;
+
+    // Camera path recording and playback. Recording keeps the loop rendering so every frame
+    // becomes a key; playback renders from the path instead of the simulation.
+    enum class PathMode { Idle, Recording, Playing };
+    CameraPath path_;
+    PathMode path_mode_ = PathMode::Idle;
+    double path_t0_ = 0.0;        // simulation time the recording or wall-clock playback started at
+    bool path_fixed_step_ = true; // playback advances by 1 / path_fps_ per frame, not by the clock
+    int path_fps_ = 60;
+    bool path_exit_at_end_ = false; // --play: close the window when the playback ends
+    uint32_t path_frames_ = 0;      // frames rendered by the current playback
+    std::chrono::steady_clock::time_point path_wall0_{};
+    char path_file_[256] = "camera.path";
+    std::string path_status_;
+
+    int mesh_resolution_ = 512;
+    float mesh_extent_ = 1.5f;
+    int mesh_format_ = 0;
+    char mesh_path_[256] = "fractal.stl";
 };
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/camera_path.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "util/read_file.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'K', 'F', 'P', 'A', 'T', 'H', 1};
+// time; position, orientation and julia_c (3 + 4 + 3 floats); julia_mask.
+constexpr size_t kKeySize = sizeof(double) + 10 * sizeof(float) + sizeof(uint32_t);
+
+template <typename T> void put(std::vector<uint8_t> &out, const T &v) {
+    const auto *p = reinterpret_cast<const uint8_t *>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T> T get(const uint8_t *&p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+}
+
+// Tangent (per second) at key i of the spline through value(key): the slope between the
+// neighbouring keys, one-sided at the ends.
+template <typename F> glm::vec3 tangent(const std::vector<CameraPath::Key> &keys, size_t i, F value) {
+    const size_t a = (i > 0) ? i - 1 : i;
+    const size_t b = std::min(i + 1, keys.size() - 1);
+    const double dt = keys[b].time - keys[a].time;
+    return (dt > 0.0) ? (value(keys[b]) - value(keys[a])) / static_cast<float>(dt) : glm::vec3(0.0f);
+}
+
+} // namespace
+
+void CameraPath::record(double time, const SimFrame &frame) {
+    if (!keys_.empty() && time <= keys_.back().time) {
+        return;
+    }
+    keys_.push_back({time, frame});
+}
+
+SimFrame CameraPath::sample(double time) const {
+    if (keys_.empty()) {
+        return {};
+    }
+    if (time <= keys_.front().time) {
+        return keys_.front().frame;
+    }
+    if (time >= keys_.back().time) {
+        return keys_.back().frame;
+    }
+
+    // Segment [i, i + 1] containing time.
+    const auto it =
+        std::upper_bound(keys_.begin(), keys_.end(), time, [](double t, const Key &k) { return t < k.time; });
+    const size_t i = static_cast<size_t>(it - keys_.begin()) - 1;
+    const Key &k0 = keys_[i];
+    const Key &k1 = keys_[i + 1];
+
+    const float h = static_cast<float>(k1.time - k0.time);
+    const float s = static_cast<float>((time - k0.time) / (k1.time - k0.time));
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = s3 - 2.0f * s2 + s;
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = s3 - s2;
+
+    const auto hermite = [&](auto value) {
+        return h00 * value(k0) + h10 * h * tangent(keys_, i, value) + h01 * value(k1) +
+               h11 * h * tangent(keys_, i + 1, value);
+    };
+
+    SimFrame out;
+    out.position = hermite([](const Key &k) { return k.frame.position; });
+    out.orientation = glm::slerp(k0.frame.orientation, k1.frame.orientation, s);
+    out.julia_c = hermite([](const Key &k) { return k.frame.julia_c; });
+    out.julia_mask = k0.frame.julia_mask;
+    return out;
+}
+
+void CameraPath::save(const std::string &path) const {
+    std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+    out.reserve(sizeof(kMagic) + sizeof(uint32_t) + keys_.size() * kKeySize);
+    put(out, static_cast<uint32_t>(keys_.size()));
+    for (const Key &k : keys_) {
+        const SimFrame &f = k.frame;
+        put(out, k.time);
+        for (int c = 0; c < 3; c++) {
+            put(out, f.position[c]);
+        }
+        put(out, f.orientation.w);
+        put(out, f.orientation.x);
+        put(out, f.orientation.y);
+        put(out, f.orientation.z);
+        for (int c = 0; c < 3; c++) {
+            put(out, f.julia_c[c]);
+        }
+        put(out, f.julia_mask);
+    }
+    assert(out.size() == sizeof(kMagic) + sizeof(uint32_t) + keys_.size() * kKeySize);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()))) {
+        throw std::runtime_error("Failed to write camera path: " + path);
+    }
+}
+
+void CameraPath::load(const std::string &path) {
+    const std::vector<uint8_t> data = read_file_binary(path);
+    if (data.size() < sizeof(kMagic) + sizeof(uint32_t) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a camera path file: " + path);
+    }
+    const uint8_t *p = data.data() + sizeof(kMagic);
+    const uint32_t count = get<uint32_t>(p);
+    if (data.size() != sizeof(kMagic) + sizeof(uint32_t) + count * kKeySize) {
+        throw std::runtime_error("Truncated camera path file: " + path);
+    }
+
+    std::vector<Key> keys(count);
+    for (Key &k : keys) {
+        SimFrame &f = k.frame;
+        k.time = get<double>(p);
+        for (int c = 0; c < 3; c++) {
+            f.position[c] = get<float>(p);
+        }
+        f.orientation.w = get<float>(p);
+        f.orientation.x = get<float>(p);
+        f.orientation.y = get<float>(p);
+        f.orientation.z = get<float>(p);
+        for (int c = 0; c < 3; c++) {
+            f.julia_c[c] = get<float>(p);
+        }
+        f.julia_mask = get<uint32_t>(p);
+    }
+    keys_ = std::move(keys);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "app/simulation.hpp"
+
+// Recorded flight through a scene: the camera pose and the animated parameters of every rendered
+// frame, with the simulation time it was sampled at. Playback interpolates between the keys, so
+// a path recorded at one frame rate can be replayed at any other, including a fixed timestep
+// that does not depend on how fast frames are rendered.
+//
+// File format (little-endian): "VKFPATH" + version byte, key count (u32), then per key the time
+// (f64), position (3 x f32), orientation quaternion w, x, y, z (4 x f32), julia_c (3 x f32) and
+// julia_mask (u32).
+class CameraPath {
+public:
+    struct Key {
+        double time = 0.0; // seconds since the start of the path
+        SimFrame frame;
+    };
+
+    void clear() { keys_.clear(); }
+    // Appends a key; keys not later than the last one are dropped.
+    void record(double time, const SimFrame &frame);
+
+    bool empty() const { return keys_.empty(); }
+    size_t size() const { return keys_.size(); }
+    double duration() const { return keys_.empty() ? 0.0 : keys_.back().time; }
+
+    // Pose at `time`, clamped to the path: cubic Hermite spline through the positions and the
+    // animated parameters (tangents from the neighbouring keys), slerp between orientations.
+    SimFrame sample(double time) const;
+
+    // Throw std::runtime_error on I/O errors and malformed files.
+    void save(const std::string &path) const;
+    void load(const std::string &path);
+
+private:
+    std::vector<Key> keys_;
+};
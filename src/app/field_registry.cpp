@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/field_registry.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+#include "field_table.inc"
+
+} // namespace
+
+uint32_t field_count() { return static_cast<uint32_t>(std::size(kFieldTable)); }
+
+std::vector<std::string> field_shaders(FieldShader kind) {
+    std::vector<std::string> out;
+    for (const FieldInfo &f : kFieldTable) {
+        out.emplace_back(f.shaders[kind]);
+    }
+    return out;
+}
+
+int clamp_field_id(int field_id) { return std::clamp(field_id, 0, static_cast<int>(field_count()) - 1); }
+
+const FieldInfo &field_info(int field_id) { return kFieldTable[clamp_field_id(field_id)]; }
+
+const FieldParamInfo *find_field_param(int field_id, const char *name) {
+    const FieldInfo &f = field_info(field_id);
+    for (uint32_t i = 0; i < f.param_count; i++) {
+        if (std::strcmp(f.params[i].name, name) == 0) {
+            return &f.params[i];
+        }
+    }
+    return nullptr;
+}
+
+void field_default_params(int field_id, float out[kFieldParamSlots]) {
+    std::fill(out, out + kFieldParamSlots, 0.0f);
+
+    const FieldInfo &f = field_info(field_id);
+    for (uint32_t i = 0; i < f.param_count; i++) {
+        const FieldParamInfo &p = f.params[i];
+        const uint32_t width = (p.type == FieldParamType::Vec3) ? 3 : 1;
+        std::copy(p.def, p.def + width, out + p.slot);
+    }
+}
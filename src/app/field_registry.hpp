@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fields and their parameters, generated at build time by cmake/field_registry.cmake from the
+// metadata comments in shaders/fields/*.glsl. Each field has its own fragment shaders; its
+// parameters live in GpuParams::field_params at the slots listed here.
+
+constexpr uint32_t kFieldParamSlots = 8; // floats in GpuParams::field_params
+
+// Fragment shaders generated per field, in the order of _FIELD_SHADER_SUFFIXES in
+// cmake/field_registry.cmake.
+enum FieldShader : uint32_t {
+    kFieldShaderMain = 0,           // march and shade, shadows off or at full resolution
+    kFieldShaderShadow = 1,         // half-resolution hit distance and shadow (RAYMARCH_SHADOW_PASS)
+    kFieldShaderShadowUpsample = 2, // march and shade with upsampled half-resolution shadows
+    kFieldShaderInterleave = 3,     // this frame's share of the pixels, alpha = hit t (RAYMARCH_INTERLEAVE)
+    kFieldShaderGBuffer = 4,        // march only, into the deferred shading G-buffer (RAYMARCH_GBUFFER)
+    kFieldShaderDeferred = 5,       // shade from the G-buffer (RAYMARCH_DEFERRED)
+    kFieldShaderAtlas = 6,          // grid of thumbnails with per-tile field parameters (RAYMARCH_ATLAS)
+    kFieldShaderGBufferStereo = 7,  // right eye warm-started from the left (RAYMARCH_GBUFFER_STEREO)
+    kFieldShaderCount = 8,
+};
+
+enum class FieldParamType : uint32_t {
+    Float,
+    Vec3,
+};
+
+struct FieldParamInfo {
+    const char *name;
+    FieldParamType type;
+    uint32_t slot; // first float in GpuParams::field_params
+    float def[3];
+    float min;
+    float max;
+};
+
+struct FieldInfo {
+    const char *name;                       // UI label
+    const char *key;                        // file name in shaders/fields/ without extension
+    const char *shaders[kFieldShaderCount]; // fragment shader SPIR-V names in the shader bundle
+    bool uses_iterations;                   // reads GpuParams::render1[2]
+    bool has_normal;                        // analytic normal (@normal), else always tetrahedral
+    float lipschitz;                        // default GpuParams::march0[0] (@lipschitz, 1 = exact distance)
+    const FieldParamInfo *params;
+    uint32_t param_count;
+};
+
+// Fields in GpuParams::render1[1] order.
+uint32_t field_count();
+// Fragment shader SPIR-V names of one kind, indexed by field id.
+std::vector<std::string> field_shaders(FieldShader kind);
+// Out-of-range ids are clamped.
+const FieldInfo &field_info(int field_id);
+int clamp_field_id(int field_id);
+
+// nullptr when the field has no parameter `name`.
+const FieldParamInfo *find_field_param(int field_id, const char *name);
+
+// The field's defaults, laid out like GpuParams::field_params.
+void field_default_params(int field_id, float out[kFieldParamSlots]);
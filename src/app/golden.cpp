@@ -0,0 +1,730 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/golden.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "app/field_registry.hpp"
+#include "app/gpu_params.hpp"
+#include "gfx/cost_stats.hpp"
+#include "gfx/fullscreen_pipeline.hpp"
+#include "gfx/shading_rate.hpp"
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+#include "util/read_file.hpp"
+
+namespace {
+
+constexpr uint32_t kWidth = 320;
+constexpr uint32_t kHeight = 240;
+// Side-by-side stereo target: each eye at the full mono resolution.
+constexpr uint32_t kStereoWidth = 2 * kWidth;
+constexpr VkFormat kFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+constexpr int kWarmupRuns = 1;
+constexpr int kTimedRuns = 5;
+
+// A pixel differs when its CIE76 colour difference is above kPixelDeltaE (about 2.3 is just
+// noticeable); a scene fails when more than kMaxBadPixelFraction of its pixels differ. This
+// absorbs rasterizer and driver rounding but not a visibly different surface.
+constexpr float kPixelDeltaE = 5.0f;
+constexpr float kMaxBadPixelFraction = 0.005f;
+
+struct Scene {
+    const char *name;
+    int field_id;
+    glm::vec3 eye;
+    glm::vec3 target;
+};
+
+// Every field, seen head-on and from an oblique pose that grazes the surface, and the fractals
+// from far away, where most of the frame is background.
+const Scene kScenes[] = {
+    {"sphere_front", 0, {0.0f, 0.0f, 3.0f}, {0.0f, 0.0f, 0.0f}},
+    {"sphere_oblique", 0, {1.9f, 1.3f, 1.9f}, {0.0f, 0.0f, 0.0f}},
+    {"box_front", 1, {0.0f, 0.0f, 3.5f}, {0.0f, 0.0f, 0.0f}},
+    {"box_oblique", 1, {2.2f, 1.6f, 2.2f}, {0.0f, 0.0f, 0.0f}},
+    {"mandelbulb_front", 2, {0.0f, 0.0f, 2.6f}, {0.0f, 0.0f, 0.0f}},
+    {"mandelbulb_oblique", 2, {1.3f, 0.9f, 1.4f}, {0.0f, 0.1f, 0.0f}},
+    {"mandelbox_front", 3, {0.0f, 0.0f, 2.5f}, {0.0f, 0.0f, 0.0f}},
+    {"mandelbox_oblique", 3, {1.2f, 0.8f, 1.3f}, {0.0f, 0.0f, 0.0f}},
+    {"julia_front", 4, {0.0f, 0.0f, 2.8f}, {0.0f, 0.0f, 0.0f}},
+    {"julia_oblique", 4, {1.5f, 1.1f, 1.6f}, {0.0f, 0.0f, 0.0f}},
+    {"mandelbulb_far", 2, {3.0f, 2.0f, 7.0f}, {0.0f, 0.0f, 0.0f}},
+    {"mandelbox_far", 3, {-2.5f, 1.5f, 6.5f}, {0.0f, 0.0f, 0.0f}},
+    {"julia_far", 4, {0.0f, 3.0f, 7.5f}, {0.0f, 0.0f, 0.0f}},
+};
+
+GpuParams scene_params(const Scene &s) {
+    GpuParams p{};
+
+    const glm::vec3 fw = glm::normalize(s.target - s.eye);
+    const glm::vec3 rt = glm::normalize(glm::cross(fw, glm::vec3(0.0f, 1.0f, 0.0f)));
+    const glm::vec3 up = glm::cross(rt, fw);
+    for (int i = 0; i < 3; i++) {
+        p.cam_pos[i] = s.eye[i];
+        p.cam_fw[i] = fw[i];
+        p.cam_rt[i] = rt[i];
+        p.cam_up[i] = up[i];
+    }
+
+    p.render0[0] = 50.0f; // max_dist
+    p.render1[0] = 256;   // max_steps
+    p.render1[2] = 12;    // iterations
+    p.render1[1] = s.field_id;
+    field_default_params(s.field_id, p.field_params);
+    p.march0[0] = field_info(s.field_id).lipschitz;
+    p.misc0[0] = 0.0f; // time: fixed so animated terms are reproducible
+    p.misc0[1] = static_cast<float>(kWidth) / static_cast<float>(kHeight);
+    p.misc0[2] = 1.0f / static_cast<float>(kHeight);
+    return p;
+}
+
+// --- Images ---
+
+struct Rgb8Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+void write_ppm(const std::string &path, const Rgb8Image &img) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    f << "P6\n" << img.width << " " << img.height << "\n255\n";
+    f.write(reinterpret_cast<const char *>(img.rgb.data()), static_cast<std::streamsize>(img.rgb.size()));
+    if (!f) {
+        throw std::runtime_error("Failed to write file: " + path);
+    }
+}
+
+// Binary PPM (P6, maxval 255) as written by write_ppm().
+Rgb8Image read_ppm(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    std::string magic;
+    uint32_t maxval = 0;
+    Rgb8Image img;
+    f >> magic >> img.width >> img.height >> maxval;
+    f.get(); // single whitespace before the pixel data
+    if (!f || magic != "P6" || maxval != 255) {
+        throw std::runtime_error("Unsupported PPM: " + path);
+    }
+
+    img.rgb.resize(static_cast<size_t>(img.width) * img.height * 3);
+    if (!f.read(reinterpret_cast<char *>(img.rgb.data()), static_cast<std::streamsize>(img.rgb.size()))) {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    return img;
+}
+
+// 8-bit colour, taken as sRGB-encoded, to CIE L*a*b* (D65).
+glm::vec3 to_lab(const uint8_t *rgb) {
+    auto linear = [](uint8_t c) {
+        const float v = static_cast<float>(c) / 255.0f;
+        return (v <= 0.04045f) ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+    };
+    const float r = linear(rgb[0]);
+    const float g = linear(rgb[1]);
+    const float b = linear(rgb[2]);
+
+    const float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f;
+    const float y = (0.2126f * r + 0.7152f * g + 0.0722f * b) / 1.00000f;
+    const float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f;
+
+    auto f = [](float t) { return (t > 0.008856f) ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f; };
+    const float fx = f(x);
+    const float fy = f(y);
+    const float fz = f(z);
+    return {116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz)};
+}
+
+struct Diff {
+    float bad_fraction = 0.0f;
+    float mean_delta_e = 0.0f;
+    float max_delta_e = 0.0f;
+};
+
+Diff compare(const Rgb8Image &ref, const Rgb8Image &img) {
+    if (ref.width != img.width || ref.height != img.height) {
+        return {1.0f, 100.0f, 100.0f};
+    }
+
+    Diff d;
+    size_t bad = 0;
+    double sum = 0.0;
+    const size_t pixels = static_cast<size_t>(img.width) * img.height;
+    for (size_t i = 0; i < pixels; i++) {
+        const float de = glm::length(to_lab(&ref.rgb[i * 3]) - to_lab(&img.rgb[i * 3]));
+        sum += de;
+        d.max_delta_e = std::max(d.max_delta_e, de);
+        if (de > kPixelDeltaE) {
+            bad++;
+        }
+    }
+    d.bad_fraction = static_cast<float>(bad) / static_cast<float>(pixels);
+    d.mean_delta_e = static_cast<float>(sum / static_cast<double>(pixels));
+    return d;
+}
+
+// scene,median_ms rows.
+std::map<std::string, float> read_baseline(const std::string &path) {
+    std::map<std::string, float> out;
+    std::ifstream f(path);
+    std::string line;
+    while (std::getline(f, line)) {
+        const size_t comma = line.find(',');
+        if (comma == std::string::npos || line.rfind("scene,", 0) == 0) {
+            continue;
+        }
+        out[line.substr(0, comma)] = std::stof(line.substr(comma + 1));
+    }
+    return out;
+}
+
+void write_baseline(const std::string &path, const std::map<std::string, float> &ms) {
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    std::fprintf(f, "scene,median_ms\n");
+    for (const auto &[name, t] : ms) {
+        std::fprintf(f, "%s,%.4f\n", name.c_str(), t);
+    }
+    if (std::fclose(f) != 0) {
+        throw std::runtime_error("Failed to write file: " + path);
+    }
+}
+
+// --- Offscreen renderer ---
+
+// Renders GpuParams into a fixed-height offscreen image, kWidth or kStereoWidth wide, and reads it
+// back.
+class OffscreenRenderer {
+public:
+    void init(VkContext &ctx) {
+        ctx_ = &ctx;
+        VkDevice dev = ctx.device();
+
+        // Shadows stay off in the scenes, so only the main shader of each field is needed.
+        std::vector<FullscreenPipeline::Variant> variants;
+        for (const std::string &shader : field_shaders(kFieldShaderMain)) {
+            variants.push_back({shader, kFormat});
+        }
+        fsq_.init(ctx, variants);
+
+        ctx.create_buffer(512,
+                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          ubo_,
+                          ubo_mem_);
+        vk_check(vkMapMemory(dev, ubo_mem_, 0, VK_WHOLE_SIZE, 0, &ubo_mapped_), "vkMapMemory(ubo)");
+
+        // Only filled when the params set kDebugCostStats (--stats).
+        cost_.init(ctx, 1);
+        // Scenes render at full rate; the main shader still declares the tile statistics.
+        tiles_.init(ctx, nullptr, 1, {16, 16});
+        tiles_.ensure({kWidth, kHeight}, 0);
+
+        VkDescriptorBufferInfo dbi{ubo_, 0, sizeof(GpuParams)};
+        VkDescriptorBufferInfo sbi{cost_.buffer(0), 0, CostStats::kBufferSize};
+        VkDescriptorBufferInfo tbi{tiles_.buffer(0), 0, tiles_.buffer_size()};
+        VkWriteDescriptorSet w[3]{};
+        w[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        w[0].dstSet = fsq_.ds(0);
+        w[0].dstBinding = 0;
+        w[0].descriptorCount = 1;
+        w[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        w[0].pBufferInfo = &dbi;
+        w[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        w[1].dstSet = fsq_.ds(0);
+        w[1].dstBinding = 1;
+        w[1].descriptorCount = 1;
+        w[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        w[1].pBufferInfo = &sbi;
+        w[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        w[2].dstSet = fsq_.ds(0);
+        w[2].dstBinding = FullscreenPipeline::kFirstTileBinding;
+        w[2].descriptorCount = 1;
+        w[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        w[2].pBufferInfo = &tbi;
+        vkUpdateDescriptorSets(dev, 3, w, 0, nullptr);
+
+        // Target image
+        VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ici.imageType = VK_IMAGE_TYPE_2D;
+        ici.format = kFormat;
+        ici.extent = {kStereoWidth, kHeight, 1};
+        ici.mipLevels = 1;
+        ici.arrayLayers = 1;
+        ici.samples = VK_SAMPLE_COUNT_1_BIT;
+        ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ici.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        vk_check(vkCreateImage(dev, &ici, nullptr, &image_), "vkCreateImage(golden)");
+
+        VkMemoryRequirements req{};
+        vkGetImageMemoryRequirements(dev, image_, &req);
+        VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        mai.allocationSize = req.size;
+        mai.memoryTypeIndex = ctx.find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        vk_check(vkAllocateMemory(dev, &mai, nullptr, &image_mem_), "vkAllocateMemory(golden)");
+        vk_check(vkBindImageMemory(dev, image_, image_mem_, 0), "vkBindImageMemory(golden)");
+
+        VkImageViewCreateInfo vci{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vci.image = image_;
+        vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vci.format = kFormat;
+        vci.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vk_check(vkCreateImageView(dev, &vci, nullptr, &view_), "vkCreateImageView(golden)");
+
+        // Readback
+        ctx.create_buffer(static_cast<VkDeviceSize>(kStereoWidth) * kHeight * 4,
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          readback_,
+                          readback_mem_);
+        vk_check(vkMapMemory(dev, readback_mem_, 0, VK_WHOLE_SIZE, 0, &readback_mapped_), "vkMapMemory(readback)");
+
+        // Commands
+        VkCommandPoolCreateInfo cpci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        cpci.queueFamilyIndex = ctx.graphics_qf();
+        cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        vk_check(vkCreateCommandPool(dev, &cpci, nullptr, &pool_), "vkCreateCommandPool(golden)");
+
+        VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cai.commandPool = pool_;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cai.commandBufferCount = 1;
+        vk_check(vkAllocateCommandBuffers(dev, &cai, &cmd_), "vkAllocateCommandBuffers(golden)");
+
+        VkFenceCreateInfo fci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        vk_check(vkCreateFence(dev, &fci, nullptr, &fence_), "vkCreateFence(golden)");
+
+        // GPU timestamps when the queue supports them, otherwise submit-to-fence wall time.
+        uint32_t qf_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(ctx.phys(), &qf_count, nullptr);
+        std::vector<VkQueueFamilyProperties> qfs(qf_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(ctx.phys(), &qf_count, qfs.data());
+        if (qfs.at(ctx.graphics_qf()).timestampValidBits != 0) {
+            VkQueryPoolCreateInfo qpci{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            qpci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            qpci.queryCount = 2;
+            vk_check(vkCreateQueryPool(dev, &qpci, nullptr, &queries_), "vkCreateQueryPool(golden)");
+            timestamp_period_ns_ = ctx.properties().limits.timestampPeriod;
+        }
+    }
+
+    void shutdown() {
+        if (!ctx_) {
+            return;
+        }
+        VkDevice dev = ctx_->device();
+        vkDeviceWaitIdle(dev);
+
+        if (queries_) {
+            vkDestroyQueryPool(dev, queries_, nullptr);
+        }
+        vkDestroyFence(dev, fence_, nullptr);
+        vkDestroyCommandPool(dev, pool_, nullptr);
+        vkDestroyBuffer(dev, readback_, nullptr);
+        vkFreeMemory(dev, readback_mem_, nullptr);
+        vkDestroyImageView(dev, view_, nullptr);
+        vkDestroyImage(dev, image_, nullptr);
+        vkFreeMemory(dev, image_mem_, nullptr);
+        tiles_.shutdown(dev);
+        cost_.shutdown(dev);
+        vkDestroyBuffer(dev, ubo_, nullptr);
+        vkFreeMemory(dev, ubo_mem_, nullptr);
+        fsq_.shutdown(dev);
+        ctx_ = nullptr;
+    }
+
+    // Renders p once into a `width` x kHeight image; returns the render time in milliseconds. With
+    // kDebugCostStats in p, the frame's cost statistics are available from stats() afterwards.
+    float render(const GpuParams &p, uint32_t width = kWidth) {
+        std::memcpy(ubo_mapped_, &p, sizeof(GpuParams));
+        width_ = width;
+        const bool cost_stats = (p.render1[3] & kDebugCostStats) != 0;
+
+        vk_check(vkResetCommandBuffer(cmd_, 0), "vkResetCommandBuffer(golden)");
+        VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vk_check(vkBeginCommandBuffer(cmd_, &bi), "vkBeginCommandBuffer(golden)");
+        if (cost_stats) {
+            cost_.begin_frame(cmd_, 0, ++stats_frame_);
+        }
+        record(cmd_, static_cast<uint32_t>(clamp_field_id(p.render1[1])), width);
+        if (cost_stats) {
+            cost_.end_frame(cmd_, 0);
+        }
+        vk_check(vkEndCommandBuffer(cmd_), "vkEndCommandBuffer(golden)");
+
+        VkCommandBufferSubmitInfo cbsi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+        cbsi.commandBuffer = cmd_;
+        VkSubmitInfo2 si{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+        si.commandBufferInfoCount = 1;
+        si.pCommandBufferInfos = &cbsi;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        vk_check(vkQueueSubmit2(ctx_->graphics_queue(), 1, &si, fence_), "vkQueueSubmit2(golden)");
+        vk_check(vkWaitForFences(ctx_->device(), 1, &fence_, VK_TRUE, UINT64_MAX), "vkWaitForFences(golden)");
+        const auto t1 = std::chrono::steady_clock::now();
+        vk_check(vkResetFences(ctx_->device(), 1, &fence_), "vkResetFences(golden)");
+        if (cost_stats) {
+            cost_.resolve(0);
+        }
+
+        if (!queries_) {
+            return std::chrono::duration<float, std::milli>(t1 - t0).count();
+        }
+        uint64_t ts[2]{};
+        vk_check(vkGetQueryPoolResults(ctx_->device(),
+                                       queries_,
+                                       0,
+                                       2,
+                                       sizeof(ts),
+                                       ts,
+                                       sizeof(uint64_t),
+                                       VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT),
+                 "vkGetQueryPoolResults(golden)");
+        return static_cast<float>(static_cast<double>(ts[1] - ts[0]) * timestamp_period_ns_ * 1e-6);
+    }
+
+    const CostStats::Summary &stats() const { return cost_.latest(); }
+
+    // Result of the last render().
+    Rgb8Image readback() const {
+        Rgb8Image img;
+        img.width = width_;
+        img.height = kHeight;
+        img.rgb.resize(static_cast<size_t>(width_) * kHeight * 3);
+        const auto *rgba = static_cast<const uint8_t *>(readback_mapped_);
+        for (size_t i = 0; i < static_cast<size_t>(width_) * kHeight; i++) {
+            std::memcpy(&img.rgb[i * 3], &rgba[i * 4], 3);
+        }
+        return img;
+    }
+
+private:
+    void record(VkCommandBuffer cmd, uint32_t field, uint32_t width) {
+        const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        VkImageMemoryBarrier2 to_color{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        to_color.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        to_color.srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        to_color.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        to_color.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        to_color.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        to_color.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        to_color.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_color.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_color.image = image_;
+        to_color.subresourceRange = range;
+
+        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        dep.imageMemoryBarrierCount = 1;
+        dep.pImageMemoryBarriers = &to_color;
+        vkCmdPipelineBarrier2(cmd, &dep);
+
+        if (queries_) {
+            vkCmdResetQueryPool(cmd, queries_, 0, 2);
+            vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, queries_, 0);
+        }
+
+        VkRenderingAttachmentInfo color{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
+        color.imageView = view_;
+        color.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color.clearValue.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+
+        VkRenderingInfo ri{VK_STRUCTURE_TYPE_RENDERING_INFO};
+        ri.renderArea = {{0, 0}, {width, kHeight}};
+        ri.layerCount = 1;
+        ri.colorAttachmentCount = 1;
+        ri.pColorAttachments = &color;
+        vkCmdBeginRendering(cmd, &ri);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.pipeline(field));
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(kHeight), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, {width, kHeight}};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+        VkDescriptorSet ds = fsq_.ds(0);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, fsq_.layout(), 0, 1, &ds, 0, nullptr);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+
+        vkCmdEndRendering(cmd);
+
+        if (queries_) {
+            vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, queries_, 1);
+        }
+
+        VkImageMemoryBarrier2 to_src = to_color;
+        to_src.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        to_src.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        to_src.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        to_src.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        to_src.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        to_src.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        dep.pImageMemoryBarriers = &to_src;
+        vkCmdPipelineBarrier2(cmd, &dep);
+
+        VkBufferImageCopy copy{};
+        copy.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        copy.imageExtent = {width, kHeight, 1};
+        vkCmdCopyImageToBuffer(cmd, image_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback_, 1, &copy);
+
+        VkMemoryBarrier2 to_host{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+        to_host.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        to_host.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        to_host.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+        to_host.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+        VkDependencyInfo host_dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        host_dep.memoryBarrierCount = 1;
+        host_dep.pMemoryBarriers = &to_host;
+        vkCmdPipelineBarrier2(cmd, &host_dep);
+    }
+
+    VkContext *ctx_ = nullptr;
+    FullscreenPipeline fsq_;
+
+    VkBuffer ubo_{};
+    VkDeviceMemory ubo_mem_{};
+    void *ubo_mapped_ = nullptr;
+
+    CostStats cost_;
+    uint64_t stats_frame_ = 0;
+    ShadingRate tiles_;
+
+    VkImage image_{};
+    VkDeviceMemory image_mem_{};
+    VkImageView view_{};
+
+    VkBuffer readback_{};
+    VkDeviceMemory readback_mem_{};
+    void *readback_mapped_ = nullptr;
+
+    VkCommandPool pool_{};
+    VkCommandBuffer cmd_{};
+    VkFence fence_{};
+
+    VkQueryPool queries_{};
+    float timestamp_period_ns_ = 1.0f;
+
+    uint32_t width_ = kWidth; // of the last render()
+};
+
+} // namespace
+
+int run_golden(const GoldenOptions &opt) {
+    namespace fs = std::filesystem;
+    fs::create_directories(opt.dir);
+    const std::string baseline_path =
+        opt.baseline.empty() ? (fs::path(opt.dir) / "baseline.csv").string() : opt.baseline;
+    const bool record_baseline = opt.update || !fs::exists(baseline_path);
+
+    VkContext ctx;
+    ctx.init(nullptr);
+    ctx.init_shaders(shader_dir_from_exe() + "/shaders.bundle");
+    std::cout << "Golden images on " << ctx.properties().deviceName << " (" << kWidth << "x" << kHeight << ")\n";
+
+    OffscreenRenderer renderer;
+    std::map<std::string, float> timings;
+    int failures = 0;
+    float mono_total_ms = 0.0f;
+    float stereo_total_ms = 0.0f;
+
+    try {
+        renderer.init(ctx);
+        const std::map<std::string, float> baseline = opt.update ? std::map<std::string, float>{}
+                                                                 : read_baseline(baseline_path);
+
+        auto median_render_ms = [&renderer](const GpuParams &params, uint32_t width = kWidth) {
+            std::vector<float> ms;
+            for (int run = 0; run < kWarmupRuns + kTimedRuns; run++) {
+                const float t = renderer.render(params, width);
+                if (run >= kWarmupRuns) {
+                    ms.push_back(t);
+                }
+            }
+            std::sort(ms.begin(), ms.end());
+            return ms[ms.size() / 2];
+        };
+        auto mean_counters = [&renderer](GpuParams params) {
+            params.render1[3] |= kDebugCostStats;
+            renderer.render(params);
+            return renderer.stats();
+        };
+
+        for (const Scene &scene : kScenes) {
+            const GpuParams params = scene_params(scene);
+
+            const float median_ms = median_render_ms(params);
+            timings[scene.name] = median_ms;
+
+            const Rgb8Image img = renderer.readback();
+            const std::string ref_path = (fs::path(opt.dir) / (std::string(scene.name) + ".ppm")).string();
+
+            if (opt.update) {
+                write_ppm(ref_path, img);
+                std::printf("%-20s %8.3f ms  updated\n", scene.name, median_ms);
+                continue;
+            }
+
+            std::string status = "ok";
+            if (!fs::exists(ref_path)) {
+                status = "FAIL (no reference, run with --update)";
+            } else {
+                const Diff d = compare(read_ppm(ref_path), img);
+                if (d.bad_fraction > kMaxBadPixelFraction) {
+                    std::ostringstream os;
+                    os << "FAIL (" << d.bad_fraction * 100.0f << "% pixels dE>" << kPixelDeltaE
+                       << ", max dE " << d.max_delta_e << ")";
+                    status = os.str();
+                    write_ppm((fs::path(opt.dir) / (std::string(scene.name) + ".actual.ppm")).string(), img);
+                }
+            }
+
+            const auto base = baseline.find(scene.name);
+            if (base != baseline.end() && median_ms > base->second * (1.0f + opt.max_slowdown_pct / 100.0f)) {
+                std::ostringstream os;
+                os << (status == "ok" ? "" : status + ", ") << "FAIL (slower than baseline " << base->second
+                   << " ms by more than " << opt.max_slowdown_pct << "%)";
+                status = os.str();
+            }
+
+            if (status != "ok") {
+                failures++;
+            }
+            std::printf("%-20s %8.3f ms  %s\n", scene.name, median_ms, status.c_str());
+
+            if (opt.compare_normals && params.render3[2] == kNormalsAnalytic && field_info(scene.field_id).has_normal) {
+                GpuParams tetrahedral = params;
+                tetrahedral.render3[2] = kNormalsTetrahedral;
+                const float tetrahedral_ms = median_render_ms(tetrahedral);
+                const Diff d = compare(renderer.readback(), img);
+                std::printf("%-20s %8.3f ms  tetrahedral normals, mean dE %.2f, %.2f%% pixels dE>%.0f\n",
+                            "",
+                            tetrahedral_ms,
+                            d.mean_delta_e,
+                            d.bad_fraction * 100.0f,
+                            kPixelDeltaE);
+            }
+
+            if (opt.compare_stereo) {
+                // Both eyes side by side in a target twice as wide, so each eye has the mono
+                // resolution and the stereo frame does the work of two mono frames.
+                GpuParams stereo = params;
+                stereo.render2[0] = 1;
+                stereo.misc0[1] = static_cast<float>(kStereoWidth) / static_cast<float>(kHeight);
+                const float stereo_ms = median_render_ms(stereo, kStereoWidth);
+                mono_total_ms += median_ms;
+                stereo_total_ms += stereo_ms;
+                std::printf("%-20s %8.3f ms  side-by-side stereo (2x %ux%u), %.2fx two mono frames\n",
+                            "",
+                            stereo_ms,
+                            kWidth,
+                            kHeight,
+                            stereo_ms / (2.0f * median_ms));
+            }
+
+            if (opt.stats) {
+                const CostStats::Summary cs = mean_counters(params);
+                std::printf("%-20s steps %.1f, iterations %.1f, refine %.1f, shading evals %.1f per pixel\n",
+                            "",
+                            cs.mean[CostStats::kMarchSteps],
+                            cs.mean[CostStats::kFieldIterations],
+                            cs.mean[CostStats::kRefineSteps],
+                            cs.mean[CostStats::kShadingEvals]);
+                if (cs.hits > 0) {
+                    std::printf("%-20s refine %.1f evaluations per hit pixel\n",
+                                "",
+                                cs.mean[CostStats::kRefineSteps] * static_cast<float>(cs.pixels) /
+                                    static_cast<float>(cs.hits));
+                }
+                if (params.march0[3] > 0.0f) {
+                    GpuParams fixed = params;
+                    fixed.march0[3] = 0.0f;
+                    const float fixed_ms = median_render_ms(fixed);
+                    const Diff d = compare(renderer.readback(), img);
+                    std::printf("%-20s %8.3f ms  fixed iterations, mean dE %.2f, %.2f%% pixels dE>%.0f\n",
+                                "",
+                                fixed_ms,
+                                d.mean_delta_e,
+                                d.bad_fraction * 100.0f,
+                                kPixelDeltaE);
+                }
+                if (params.march1[1] != 0) {
+                    GpuParams unbounded = params;
+                    unbounded.march1[1] = 0;
+                    std::printf("%-20s %8.3f ms  steps %.1f without bounding volume\n",
+                                "",
+                                median_render_ms(unbounded),
+                                mean_counters(unbounded).mean[CostStats::kMarchSteps]);
+                }
+                if (params.march0[1] > 1.0f) {
+                    GpuParams plain = params;
+                    plain.march0[1] = 1.0f;
+                    std::printf("%-20s steps %.1f without over-relaxation\n",
+                                "",
+                                mean_counters(plain).mean[CostStats::kMarchSteps]);
+                }
+            }
+        }
+
+        if (opt.update || (record_baseline && failures == 0)) {
+            write_baseline(baseline_path, timings);
+            if (!opt.update) {
+                std::cout << "Recorded timing baseline " << baseline_path << "\n";
+            }
+        }
+        if (opt.compare_stereo && mono_total_ms > 0.0f) {
+            std::printf("Stereo %.3f ms over all scenes, two mono frames %.3f ms (%.2fx)\n",
+                        stereo_total_ms,
+                        2.0f * mono_total_ms,
+                        stereo_total_ms / (2.0f * mono_total_ms));
+        }
+    } catch (...) {
+        renderer.shutdown();
+        ctx.shutdown();
+        throw;
+    }
+
+    renderer.shutdown();
+    ctx.shutdown();
+
+    if (failures > 0) {
+        std::cout << failures << " of " << std::size(kScenes) << " scenes failed\n";
+        return 1;
+    }
+    return 0;
+}
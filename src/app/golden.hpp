@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+// Headless correctness and performance regression check of the fractal shader.
+//
+// Renders a fixed set of scenes (every field from two camera poses, and the fractals from far away)
+// offscreen, without a window or swapchain, so it runs on a software rasterizer such as lavapipe.
+// Each image is compared with the reference in `dir` using a perceptual colour difference, and the
+// median GPU time of each scene is compared with the timing baseline. Timings only mean something
+// on the machine that recorded them, so a missing baseline is recorded by the first run whose
+// images all match.
+//
+// With `stats`, the mean cost counters (CostStats) of every scene are printed as well. With
+// `compare_normals`, scenes of fields with analytic normals are also rendered with the
+// tetrahedral estimator and the time and colour difference of the two are reported. With
+// `compare_stereo`, every scene is also rendered as side-by-side stereo with each eye at the full
+// scene resolution, and its time is reported against two mono frames.
+struct GoldenOptions {
+    std::string dir;                // references: <scene>.ppm
+    std::string baseline;           // timing baseline (CSV); empty = <dir>/baseline.csv
+    bool update = false;            // write new references and baseline instead of comparing
+    float max_slowdown_pct = 20.0f; // allowed render time increase over the baseline
+    bool compare_normals = false;   // report analytic against tetrahedral normals per scene
+    bool stats = false;             // report the mean cost counters per scene
+    bool compare_stereo = false;    // report stereo against two mono frames per scene
+};
+
+// Returns the process exit code: 0 when every scene matches its reference and baseline. A scene
+// without a reference fails, so an empty `dir` never passes.
+int run_golden(const GoldenOptions &opt);
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/gpu_params.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+struct FieldGroup {
+    size_t offset;
+    size_t size;
+    uint32_t bit;
+};
+
+// Byte ranges of GpuParams and the group they belong to. Ranges sharing a vec4 are split by lane.
+const FieldGroup kGroups[] = {
+    {offsetof(GpuParams, cam_pos), 4 * sizeof(float), kDirtyCamera},
+    {offsetof(GpuParams, cam_fw), 4 * sizeof(float), kDirtyCamera},
+    {offsetof(GpuParams, cam_rt), 4 * sizeof(float), kDirtyCamera},
+    {offsetof(GpuParams, cam_up), 4 * sizeof(float), kDirtyCamera},
+    {offsetof(GpuParams, render0), 4 * sizeof(float), kDirtyRaymarch},
+    {offsetof(GpuParams, render1), 1 * sizeof(int), kDirtyRaymarch},
+    {offsetof(GpuParams, render1) + 1 * sizeof(int), 2 * sizeof(int), kDirtyField},
+    {offsetof(GpuParams, render1) + 3 * sizeof(int), 1 * sizeof(int), kDirtyDebug},
+    {offsetof(GpuParams, field_params), 8 * sizeof(float), kDirtyField},
+    {offsetof(GpuParams, misc0), 1 * sizeof(float), kDirtyTime},
+    {offsetof(GpuParams, misc0) + 1 * sizeof(float), 3 * sizeof(float), kDirtyView},
+    {offsetof(GpuParams, render2), 4 * sizeof(int), kDirtyView},
+    {offsetof(GpuParams, stereo0), 4 * sizeof(float), kDirtyView},
+    {offsetof(GpuParams, render3), 4 * sizeof(int), kDirtyLighting},
+    {offsetof(GpuParams, shadow0), 4 * sizeof(float), kDirtyLighting},
+    {offsetof(GpuParams, march0), 4 * sizeof(float), kDirtyRaymarch},
+    {offsetof(GpuParams, march1), 4 * sizeof(int), kDirtyRaymarch},
+    {offsetof(GpuParams, interleave0), 4 * sizeof(int), kDirtyInterleave},
+    {offsetof(GpuParams, prev_cam_pos), 12 * sizeof(float), kDirtyInterleave},
+    {offsetof(GpuParams, vrs0), 4 * sizeof(int), kDirtyView},
+    {offsetof(GpuParams, vrs1), 4 * sizeof(float), kDirtyView},
+    {offsetof(GpuParams, vrs2), 4 * sizeof(int), kDirtyView},
+    {offsetof(GpuParams, palette0), 8 * sizeof(float), kDirtyLighting},
+    {offsetof(GpuParams, atlas0), 4 * sizeof(int), kDirtyView},
+};
+
+} // namespace
+
+std::string dirty_bits_to_string(uint32_t bits) {
+    static const char *names[] = {"camera", "raymarch", "field", "view", "debug", "time", "lighting", "interleave"};
+
+    std::string out;
+    for (uint32_t i = 0; i < std::size(names); i++) {
+        if (bits & (1u << i)) {
+            if (!out.empty()) {
+                out += ' ';
+            }
+            out += names[i];
+        }
+    }
+    return out.empty() ? "none" : out;
+}
+
+uint32_t ParamsTracker::peek(const GpuParams &p) const {
+    uint32_t dirty = 0;
+
+    if (force_all_) {
+        for (const auto &g : kGroups) {
+            dirty |= g.bit;
+        }
+    } else {
+        const auto *a = reinterpret_cast<const unsigned char *>(&p);
+        const auto *b = reinterpret_cast<const unsigned char *>(&last_);
+        for (const auto &g : kGroups) {
+            if ((dirty & g.bit) == 0 && std::memcmp(a + g.offset, b + g.offset, g.size) != 0) {
+                dirty |= g.bit;
+            }
+        }
+    }
+    return dirty;
+}
+
+uint32_t ParamsTracker::commit(const GpuParams &p) {
+    const uint32_t dirty = peek(p);
+    force_all_ = false;
+
+    if (dirty) {
+        last_ = p;
+        generation_++;
+    }
+    last_dirty_ = dirty;
+    return dirty;
+}
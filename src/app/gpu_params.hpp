@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct alignas(16) GpuParams {
+    float cam_pos[4] = {0, 0, 3, 0};
+
+    // Camera basis (supports roll):
+    // fw = forward, rt = right, up = up
+    float cam_fw[4] = {0, 0, -1, 0};
+    float cam_rt[4] = {1, 0, 0, 0};
+    float cam_up[4] = {0, 1, 0, 0};
+
+    float render0[4] = {100.0f, 1e-3f, 1e-3f, 1.2f}; // max_dist, hit_eps, normal_eps, fov
+    int render1[4] = {256, 0, 12, 0};                // max_steps, field_id, iterations, debug_flags (kDebug*)
+
+    float field_params[8] = {};                // per-field parameters, slots from field_registry.hpp
+    float misc0[4] = {0.0f, 1.0f, 0.0f, 0.0f}; // time, aspect, pixel size (1 / framebuffer height), ...
+
+    int render2[4] = {0, 0, 0, 0};                 // stereo_mode (0 = mono, 1 = side-by-side), ...
+    float stereo0[4] = {0.064f, 0.0f, 0.0f, 0.0f}; // ipd, convergence distance (0 = parallel), ...
+
+    int render3[4] = {0, 48, 1, 8};               // kShadow*, shadow_steps, kNormals*, ao_iterations (0 = iterations)
+    float shadow0[4] = {12.0f, 4.0f, 0.0f, 0.0f}; // penumbra sharpness (k), shadow max_dist, ...
+
+    float march0[4] = {1.0f, 1.5f, 0.5f, 1.0f}; // Lipschitz bound, over-relaxation (1 = off), max step, LOD (0 = off)
+    int march1[4] = {16, 1, 0, 0};              // refine_steps cap, bounding volumes (0 = off), ...
+
+    // Interleaved rendering (kInterleave*): the pixels marched this frame and the camera the
+    // history image was rendered with, for reprojection.
+    int interleave0[4] = {0, 0, 0, 0}; // kInterleave*, phase, full-resolution width, height
+    float prev_cam_pos[4] = {0, 0, 3, 0};
+    float prev_cam_fw[4] = {0, 0, -1, 0};
+    float prev_cam_rt[4] = {1, 0, 0, 0};
+
+    // Variable-rate shading (ShadingRate): per-tile statistics of the fractal pass and the
+    // thresholds that turn the previous frame's into coarse shading rates.
+    int vrs0[4] = {0, 16, 16, 0};               // enabled, tile width, tile height, tiles per row
+    float vrs1[4] = {0.02f, 0.15f, 0.0f, 0.0f}; // max normal spread, max steps / max_steps, ...
+    int vrs2[4] = {0, 8, 0, 0};                 // refresh phase, refresh period in frames, ...
+
+    // Surface colour, blended by the orbit trap from palette0 (trap 0) to palette1 (trap >= 4).
+    float palette0[4] = {0.2f, 0.3f, 0.6f, 0.0f};
+    float palette1[4] = {0.9f, 0.8f, 0.2f, 0.0f};
+
+    int atlas0[4] = {0, 0, 0, 0}; // parameter atlas (ParamAtlas) columns, rows (0 = off), thumbnail width, height
+};
+static_assert(sizeof(GpuParams) % 16 == 0);
+
+// GpuParams::render1[3] debug flags, mirrored in shaders/params.glsl.
+constexpr int kDebugCostStats = 1 << 0; // accumulate per-pixel cost counters (CostStats)
+constexpr int kDebugHeatmapShift = 1;   // bits 1..3: heatmap overlay, 0 = off, else 1 + CostStats::Counter
+constexpr int kDebugHeatmapMask = 7 << kDebugHeatmapShift;
+constexpr int kDebugNormalError = 1 << 4; // angle between the analytic and tetrahedral normals
+
+// GpuParams::render3[0] shadow modes, mirrored in shaders/params.glsl.
+constexpr int kShadowOff = 0;
+constexpr int kShadowFull = 1; // one shadow ray per pixel
+constexpr int kShadowHalf = 2; // one per 2x2 pixels in a separate pass, upsampled by depth
+
+// GpuParams::render3[2] normal modes, mirrored in shaders/params.glsl.
+constexpr int kNormalsTetrahedral = 0; // finite difference, four field evaluations
+constexpr int kNormalsAnalytic = 1;    // the field's gradient (FieldInfo::has_normal), one evaluation
+
+// GpuParams::interleave0[0] modes, mirrored in shaders/params.glsl.
+constexpr int kInterleaveFull = 0;         // every pixel
+constexpr int kInterleaveCheckerboard = 1; // half of the pixels, alternating checkerboard
+constexpr int kInterleaveQuarter = 2;      // one pixel of each 2x2 block, rotating over four frames
+
+// Groups of GpuParams fields that change together. A set bit means the group differs from the
+// previously committed snapshot.
+enum DirtyBits : uint32_t {
+    kDirtyCamera = 1u << 0,     // cam_pos, cam_fw, cam_rt, cam_up
+    kDirtyRaymarch = 1u << 1,   // max_dist, hit_eps, normal_eps, fov, max_steps, march0, march1
+    kDirtyField = 1u << 2,      // field_id, iterations, field_params
+    kDirtyView = 1u << 3,       // aspect, stereo, variable-rate shading, parameter atlas
+    kDirtyDebug = 1u << 4,      // debug_flags
+    kDirtyTime = 1u << 5,       // misc0.x
+    kDirtyLighting = 1u << 6,   // shadows, normals, ambient occlusion, palette
+    kDirtyInterleave = 1u << 7, // interleave0, prev_cam_*
+};
+
+// Changes that make previously rendered pixels (history, accumulation) stale.
+constexpr uint32_t kInvalidatesHistory = kDirtyCamera | kDirtyRaymarch | kDirtyField | kDirtyView | kDirtyLighting;
+
+// Space separated names of the set bits, for the overlay.
+std::string dirty_bits_to_string(uint32_t bits);
+
+// Tracks which parts of GpuParams changed between frames. Every change bumps generation(), so
+// consumers such as per-frame UBOs only need to remember the generation they last saw.
+class ParamsTracker {
+public:
+    // Diffs p against the last committed snapshot, stores p and returns the changed groups.
+    uint32_t commit(const GpuParams &p);
+    // The groups commit(p) would report, without committing.
+    uint32_t peek(const GpuParams &p) const;
+
+    // Forces the next peek() and commit() to report every group dirty; called after the swapchain
+    // is recreated, when nothing rendered at the old size can be reused.
+    void invalidate() { force_all_ = true; }
+
+    uint64_t generation() const { return generation_; }
+    uint32_t last_dirty() const { return last_dirty_; }
+
+private:
+    GpuParams last_{};
+    uint64_t generation_ = 1;
+    uint32_t last_dirty_ = 0;
+    bool force_all_ = true;
+};
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/param_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+void ParamAtlas::init(VkContext &ctx, uint32_t slots) {
+    slots_.assign(slots, Slot{});
+    for (Slot &s : slots_) {
+        ctx.create_buffer(buffer_size(),
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          s.buffer,
+                          s.memory);
+        vk_check(vkMapMemory(ctx.device(), s.memory, 0, VK_WHOLE_SIZE, 0, &s.mapped), "vkMapMemory(atlas)");
+    }
+}
+
+void ParamAtlas::shutdown(VkDevice device) {
+    for (const Slot &s : slots_) {
+        if (s.mapped) {
+            vkUnmapMemory(device, s.memory);
+        }
+        if (s.buffer) {
+            vkDestroyBuffer(device, s.buffer, nullptr);
+        }
+        if (s.memory) {
+            vkFreeMemory(device, s.memory, nullptr);
+        }
+    }
+    slots_.clear();
+}
+
+std::vector<ParamAtlas::Lane> ParamAtlas::lanes(int field_id) {
+    static const char *kComponents[] = {".x", ".y", ".z"};
+
+    std::vector<Lane> out;
+    const FieldInfo &field = field_info(field_id);
+    for (uint32_t i = 0; i < field.param_count; i++) {
+        const FieldParamInfo &fp = field.params[i];
+        if (fp.type == FieldParamType::Vec3) {
+            for (uint32_t c = 0; c < 3; c++) {
+                out.push_back({std::string(fp.name) + kComponents[c], fp.slot + c, fp.min, fp.max});
+            }
+        } else {
+            out.push_back({fp.name, fp.slot, fp.min, fp.max});
+        }
+    }
+    return out;
+}
+
+void ParamAtlas::reset_axes(int field_id) {
+    const std::vector<Lane> l = lanes(field_id);
+    for (uint32_t a = 0; a < 2; a++) {
+        if (l.empty()) {
+            axes[a] = {};
+            continue;
+        }
+        const Lane &lane = l[std::min<size_t>(a, l.size() - 1)];
+        // Rows run top to bottom; sweep y from the top of the range so it reads like a plot.
+        axes[a] = {static_cast<int>(lane.slot), (a == 0) ? lane.min : lane.max, (a == 0) ? lane.max : lane.min};
+    }
+}
+
+void ParamAtlas::tile_params(uint32_t col,
+                             uint32_t row,
+                             const float base[kFieldParamSlots],
+                             float out[kFieldParamSlots]) const {
+    std::memmove(out, base, kFieldParamSlots * sizeof(float));
+
+    const int n = std::clamp(grid, 2, static_cast<int>(kMaxGrid));
+    const uint32_t index[2] = {col, row};
+    for (uint32_t a = 0; a < 2; a++) {
+        const Axis &axis = axes[a];
+        if (axis.slot < 0 || axis.slot >= static_cast<int>(kFieldParamSlots)) {
+            continue;
+        }
+        const float s = static_cast<float>(index[a]) / static_cast<float>(n - 1);
+        out[axis.slot] = axis.from + s * (axis.to - axis.from);
+    }
+}
+
+void ParamAtlas::upload(uint32_t slot, const float base[kFieldParamSlots]) {
+    const uint32_t n = static_cast<uint32_t>(std::clamp(grid, 2, static_cast<int>(kMaxGrid)));
+    auto *tiles = static_cast<Tile *>(slots_[slot].mapped);
+    for (uint32_t row = 0; row < n; row++) {
+        for (uint32_t col = 0; col < n; col++) {
+            tile_params(col, row, base, tiles[row * n + col].field_params);
+        }
+    }
+}
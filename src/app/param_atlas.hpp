@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "app/field_registry.hpp"
+
+class VkContext;
+
+// Parameter-space preview: a grid of thumbnails of the current field, each with different field
+// parameters, rendered by one draw of the RAYMARCH_ATLAS field shader variant. Two parameter
+// lanes (e.g. julia_c.x and julia_c.y) are swept across the columns and the rows; every other
+// parameter keeps its current value. The thumbnails' parameters live in a storage buffer per
+// frame slot that the shader indexes by thumbnail.
+class ParamAtlas {
+public:
+    static constexpr uint32_t kMaxGrid = 16;
+
+    // Mirrors the two vec4 per thumbnail of AtlasBuffer in shaders/raymarch.glsl (std430).
+    struct Tile {
+        float field_params[kFieldParamSlots];
+    };
+    static_assert(sizeof(Tile) == 32);
+
+    // One float of GpuParams::field_params: a float parameter or one component of a vec3.
+    struct Lane {
+        std::string name; // "power", "c.x", ...
+        uint32_t slot;
+        float min;
+        float max;
+    };
+
+    // Range swept by one axis of the grid; a negative slot sweeps nothing.
+    struct Axis {
+        int slot = -1;
+        float from = 0.0f; // first column (x) or top row (y)
+        float to = 1.0f;   // last column or bottom row
+    };
+
+    void init(VkContext &ctx, uint32_t slots);
+    void shutdown(VkDevice device);
+
+    // The field's parameter lanes, in field_params order.
+    static std::vector<Lane> lanes(int field_id);
+    // Sweeps the field's first two lanes over their whole range (the first one twice when it has
+    // a single lane).
+    void reset_axes(int field_id);
+
+    // Field parameters of thumbnail (col, row): `base` with the swept lanes replaced. out may
+    // alias base.
+    void tile_params(uint32_t col, uint32_t row, const float base[kFieldParamSlots], float out[kFieldParamSlots]) const;
+    // Writes every thumbnail's parameters into the slot's buffer. The slot's previous frame must
+    // have completed.
+    void upload(uint32_t slot, const float base[kFieldParamSlots]);
+
+    VkBuffer buffer(uint32_t slot) const { return slots_[slot].buffer; }
+    static constexpr VkDeviceSize buffer_size() { return kMaxGrid * kMaxGrid * sizeof(Tile); }
+
+    int grid = 8; // thumbnails per row and per column, 2..kMaxGrid
+    Axis axes[2];
+
+private:
+    struct Slot {
+        VkBuffer buffer{};
+        VkDeviceMemory memory{};
+        void *mapped = nullptr;
+    };
+
+    std::vector<Slot> slots_;
+};
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+// When the simulation thread falls further behind than this it skips ahead instead of
+// replaying every missed tick.
+constexpr auto kMaxLag = std::chrono::milliseconds(250);
+
+// Upper bound on how long an idle simulation sleeps; only matters if a wakeup is lost.
+constexpr auto kIdleWait = std::chrono::milliseconds(100);
+
+} // namespace
+
+uint32_t animate_julia(int mode, float time_seconds, glm::vec3 &c) {
+    const float saw = std::fmod(time_seconds / 4.0f, 4.0f) - 2.0f;
+    const float t = std::fmod(time_seconds / 4.0f, 2 * std::numbers::pi_v<float>);
+
+    switch (mode) {
+    case 1: // Julia C.x
+        c.x = saw;
+        return 0x1;
+    case 2: // Julia C.y
+        c.y = saw;
+        return 0x2;
+    case 3: // Julia C.z
+        c.z = saw;
+        return 0x4;
+    case 4: // Julia C.xy
+        c.x = std::sin(t);
+        c.y = std::cos(t);
+        return 0x3;
+    case 5: // Julia C.yz
+        c.y = std::sin(t);
+        c.z = std::cos(t);
+        return 0x6;
+    case 6: // Julia C.xz
+        c.x = std::sin(t);
+        c.z = std::cos(t);
+        return 0x5;
+    }
+    return 0;
+}
+
+void Simulation::start(const Camera &initial) {
+    stop();
+
+    t0_ = Clock::now();
+    camera_ = initial;
+
+    Snapshot s;
+    s.cur = {camera_.position, camera_.orientation, 0.0};
+    s.prev = s.cur;
+    snapshots_.fill(s);
+
+    stop_ = false;
+    thread_ = std::thread([this] { thread_main(); });
+}
+
+void Simulation::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    stop_ = true;
+    wake();
+    thread_.join();
+}
+
+double Simulation::now() const { return std::chrono::duration<double>(Clock::now() - t0_).count(); }
+
+void Simulation::wake() {
+    // Taking the lock orders the caller's update before the simulation thread re-checks idle().
+    { std::lock_guard<std::mutex> lock(wake_mutex_); }
+    wake_cv_.notify_one();
+}
+
+void Simulation::set_key(SimKey key, bool down) {
+    if (down) {
+        keys_.fetch_or(key);
+    } else {
+        keys_.fetch_and(~static_cast<uint32_t>(key));
+    }
+    wake();
+}
+
+void Simulation::release_all_keys() { keys_ = 0; }
+
+void Simulation::add_mouse_delta(float dx, float dy) {
+    mouse_dx_.fetch_add(dx);
+    mouse_dy_.fetch_add(dy);
+    wake();
+}
+
+void Simulation::teleport(const glm::vec3 &position, const std::optional<glm::quat> &orientation) {
+    {
+        std::lock_guard<std::mutex> lock(teleport_mutex_);
+        teleport_ = Teleport{position, orientation};
+    }
+    teleport_pending_ = true;
+    wake();
+}
+
+bool Simulation::idle() const {
+    return keys_ == 0 && mouse_dx_ == 0.0f && mouse_dy_ == 0.0f && !teleport_pending_;
+}
+
+bool Simulation::active() const { return !idle(); }
+
+void Simulation::thread_main() {
+    const auto tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(kTickSeconds));
+    auto next = Clock::now();
+
+    Snapshot snap = snapshots_.back();
+
+    while (!stop_) {
+        if (idle()) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, kIdleWait, [&] { return stop_ || !idle(); });
+            if (stop_) {
+                break;
+            }
+            if (idle()) {
+                continue;
+            }
+
+            // Restart the clock at the current time with a motionless previous state, so the
+            // render thread does not interpolate across the idle gap.
+            next = Clock::now();
+            snap.cur.time = std::chrono::duration<double>(next - t0_).count();
+            snap.prev = snap.cur;
+        }
+
+        if (teleport_pending_.exchange(false)) {
+            std::lock_guard<std::mutex> lock(teleport_mutex_);
+            if (teleport_) {
+                camera_.position = teleport_->position;
+                if (teleport_->orientation) {
+                    camera_.orientation = *teleport_->orientation;
+                }
+                teleport_.reset();
+            }
+        }
+
+        const float dx = mouse_dx_.exchange(0.0f);
+        const float dy = mouse_dy_.exchange(0.0f);
+        if (dx != 0.0f || dy != 0.0f) {
+            camera_.processMouse(dx, dy);
+        }
+
+        const uint32_t keys = keys_;
+        camera_.processKeyboard(keys & kSimKeyForward,
+                                keys & kSimKeyBackward,
+                                keys & kSimKeyLeft,
+                                keys & kSimKeyRight,
+                                keys & kSimKeyRollLeft,
+                                keys & kSimKeyRollRight,
+                                static_cast<float>(kTickSeconds));
+
+        next += tick;
+
+        snap.prev = snap.cur;
+        snap.cur = {camera_.position, camera_.orientation, std::chrono::duration<double>(next - t0_).count()};
+        snapshots_.back() = snap;
+        snapshots_.publish();
+
+        if (Clock::now() - next > kMaxLag) {
+            next = Clock::now();
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+SimFrame Simulation::sample(double render_time) {
+    snapshots_.update();
+    const Snapshot &s = snapshots_.front();
+
+    float a = 1.0f;
+    const double span = s.cur.time - s.prev.time;
+    if (span > 0.0) {
+        a = static_cast<float>(std::clamp((render_time - s.prev.time) / span, 0.0, 1.0));
+    }
+
+    SimFrame out;
+    out.position = glm::mix(s.prev.position, s.cur.position, a);
+    out.orientation = glm::normalize(glm::slerp(s.prev.orientation, s.cur.orientation, a));
+    out.julia_mask = animate_julia(animated_param_, static_cast<float>(render_time), out.julia_c);
+    return out;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "gfx/camera.hpp"
+#include "util/triple_buffer.hpp"
+
+enum SimKey : uint32_t {
+    kSimKeyForward = 1u << 0,
+    kSimKeyBackward = 1u << 1,
+    kSimKeyLeft = 1u << 2,
+    kSimKeyRight = 1u << 3,
+    kSimKeyRollLeft = 1u << 4,
+    kSimKeyRollRight = 1u << 5,
+};
+
+// Camera pose sampled for a presentation time, plus the animated parameters at that time.
+struct SimFrame {
+    glm::vec3 position{};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+
+    glm::vec3 julia_c{};
+    uint32_t julia_mask = 0; // bit i set: julia_c[i] is animated and must be copied
+};
+
+// Fixed-rate camera simulation on its own thread. Input callbacks feed key state and mouse
+// deltas into atomics; each tick integrates the camera and publishes the last two states
+// through a triple buffer, which the render thread interpolates to its presentation time.
+// A slow frame therefore delays only the picture, never the input sampling or the motion.
+class Simulation {
+public:
+    static constexpr double kTickSeconds = 1.0 / 240.0;
+
+    ~Simulation() { stop(); }
+
+    void start(const Camera &initial);
+    void stop();
+
+    // Input side (any thread).
+    void set_key(SimKey key, bool down);
+    void release_all_keys();
+    void add_mouse_delta(float dx, float dy);
+    // Moves the camera; also turns it when an orientation is given.
+    void teleport(const glm::vec3 &position, const std::optional<glm::quat> &orientation = std::nullopt);
+    void set_animated_param(int p) { animated_param_ = p; }
+
+    // True while the simulation is producing motion (keys held or input not yet consumed).
+    bool active() const;
+
+    // Seconds since start() on the simulation clock.
+    double now() const;
+
+    // Render side: camera pose and animated parameters at render_time.
+    SimFrame sample(double render_time);
+
+private:
+    struct State {
+        glm::vec3 position{};
+        glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+        double time = 0.0;
+    };
+    struct Snapshot {
+        State prev;
+        State cur;
+    };
+
+    void thread_main();
+    bool idle() const;
+    void wake();
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point t0_{};
+
+    Camera camera_; // owned by the simulation thread while it runs
+    TripleBuffer<Snapshot> snapshots_;
+
+    std::atomic<uint32_t> keys_{0};
+    std::atomic<float> mouse_dx_{0.0f};
+    std::atomic<float> mouse_dy_{0.0f};
+    std::atomic<int> animated_param_{0};
+
+    std::mutex teleport_mutex_;
+    struct Teleport {
+        glm::vec3 position;
+        std::optional<glm::quat> orientation;
+    };
+    std::optional<Teleport> teleport_;
+    std::atomic<bool> teleport_pending_{false};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+// Closed-form Julia constant animation used by the "Animate" combo. Writes only the animated
+// components of c and returns their mask.
+uint32_t animate_julia(int mode, float time_seconds, glm::vec3 &c);
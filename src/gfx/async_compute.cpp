@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/async_compute.hpp"
+
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+void AsyncCompute::init(VkContext &ctx) {
+    device_ = ctx.device();
+    queue_ = ctx.compute_queue();
+    family_ = ctx.compute_qf();
+    dedicated_ = ctx.compute_qf() != ctx.graphics_qf();
+
+    VkCommandPoolCreateInfo cpci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    cpci.queueFamilyIndex = family_;
+    cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    vk_check(vkCreateCommandPool(device_, &cpci, nullptr, &pool_), "vkCreateCommandPool(compute)");
+
+    VkSemaphoreTypeCreateInfo stci{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    stci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    stci.initialValue = 0;
+
+    VkSemaphoreCreateInfo sci{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    sci.pNext = &stci;
+    vk_check(vkCreateSemaphore(device_, &sci, nullptr, &timeline_), "vkCreateSemaphore(compute timeline)");
+    last_value_ = 0;
+}
+
+void AsyncCompute::shutdown() {
+    if (device_ == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (last_value_ > 0) {
+        wait(last_value_, UINT64_MAX);
+    }
+    in_flight_.clear();
+    free_.clear();
+
+    if (timeline_) {
+        vkDestroySemaphore(device_, timeline_, nullptr);
+    }
+    if (pool_) {
+        vkDestroyCommandPool(device_, pool_, nullptr);
+    }
+
+    timeline_ = VK_NULL_HANDLE;
+    pool_ = VK_NULL_HANDLE;
+    device_ = VK_NULL_HANDLE;
+}
+
+uint64_t AsyncCompute::submit(const RecordFn &record, const std::vector<Wait> &waits) {
+    collect();
+
+    VkCommandBuffer cmd{};
+    if (!free_.empty()) {
+        cmd = free_.back();
+        free_.pop_back();
+        vk_check(vkResetCommandBuffer(cmd, 0), "vkResetCommandBuffer(compute)");
+    } else {
+        VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cai.commandPool = pool_;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cai.commandBufferCount = 1;
+        vk_check(vkAllocateCommandBuffers(device_, &cai, &cmd), "vkAllocateCommandBuffers(compute)");
+    }
+
+    VkCommandBufferBeginInfo cbi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vk_check(vkBeginCommandBuffer(cmd, &cbi), "vkBeginCommandBuffer(compute)");
+    record(cmd);
+    vk_check(vkEndCommandBuffer(cmd), "vkEndCommandBuffer(compute)");
+
+    std::vector<VkSemaphoreSubmitInfo> wait_infos;
+    wait_infos.reserve(waits.size());
+    for (const Wait &w : waits) {
+        VkSemaphoreSubmitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+        wi.semaphore = w.semaphore;
+        wi.value = w.value;
+        wi.stageMask = w.stages;
+        wait_infos.push_back(wi);
+    }
+
+    const uint64_t value = last_value_ + 1;
+
+    VkSemaphoreSubmitInfo signal{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+    signal.semaphore = timeline_;
+    signal.value = value;
+    signal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkCommandBufferSubmitInfo cbsi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+    cbsi.commandBuffer = cmd;
+
+    VkSubmitInfo2 si{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    si.waitSemaphoreInfoCount = static_cast<uint32_t>(wait_infos.size());
+    si.pWaitSemaphoreInfos = wait_infos.data();
+    si.commandBufferInfoCount = 1;
+    si.pCommandBufferInfos = &cbsi;
+    si.signalSemaphoreInfoCount = 1;
+    si.pSignalSemaphoreInfos = &signal;
+
+    vk_check(vkQueueSubmit2(queue_, 1, &si, VK_NULL_HANDLE), "vkQueueSubmit2(compute)");
+
+    last_value_ = value;
+    in_flight_.push_back({cmd, value});
+    return value;
+}
+
+uint64_t AsyncCompute::completed() const {
+    uint64_t v = 0;
+    vk_check(vkGetSemaphoreCounterValue(device_, timeline_, &v), "vkGetSemaphoreCounterValue");
+    return v;
+}
+
+bool AsyncCompute::wait(uint64_t value, uint64_t timeout_ns) const {
+    VkSemaphoreWaitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wi.semaphoreCount = 1;
+    wi.pSemaphores = &timeline_;
+    wi.pValues = &value;
+
+    const VkResult r = vkWaitSemaphores(device_, &wi, timeout_ns);
+    if (r == VK_TIMEOUT) {
+        return false;
+    }
+    vk_check(r, "vkWaitSemaphores(compute)");
+    return true;
+}
+
+void AsyncCompute::collect() {
+    if (in_flight_.empty()) {
+        return;
+    }
+    const uint64_t done_value = completed();
+    while (!in_flight_.empty() && in_flight_.front().value <= done_value) {
+        free_.push_back(in_flight_.front().cmd);
+        in_flight_.pop_front();
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class VkContext;
+
+// Background GPU work on the compute queue, synchronized with a timeline semaphore.
+//
+// Each submitted job signals the next value of the timeline, so the graphics queue (or the
+// CPU) can wait for exactly the job it needs while the interactive frame keeps running. On
+// devices without a separate compute family the jobs go to the graphics queue and still
+// complete in submission order.
+//
+// submit() must be called on the thread that submits graphics work: the queue may be shared
+// with graphics or present. Images and buffers shared with the graphics queue need
+// VK_SHARING_MODE_CONCURRENT, or ownership transfer barriers recorded by the job, when the
+// family is dedicated().
+class AsyncCompute {
+public:
+    using RecordFn = std::function<void(VkCommandBuffer cmd)>;
+
+    struct Wait {
+        VkSemaphore semaphore;
+        uint64_t value;
+        VkPipelineStageFlags2 stages;
+    };
+
+    void init(VkContext &ctx);
+    void shutdown();
+
+    // Records a job with record() and submits it after waits; returns the timeline value
+    // signalled when the job has finished.
+    uint64_t submit(const RecordFn &record, const std::vector<Wait> &waits = {});
+
+    // Wait description for a graphics submit that consumes the result of job `value`.
+    Wait wait_for(uint64_t value, VkPipelineStageFlags2 stages) const { return {timeline_, value, stages}; }
+
+    uint64_t completed() const;
+    bool done(uint64_t value) const { return completed() >= value; }
+
+    // Blocks the CPU until job `value` has finished; false on timeout.
+    bool wait(uint64_t value, uint64_t timeout_ns) const;
+
+    // Recycles the command buffers of finished jobs.
+    void collect();
+
+    VkSemaphore timeline() const { return timeline_; }
+    uint32_t family() const { return family_; }
+    bool dedicated() const { return dedicated_; }
+    uint32_t jobs_in_flight() const { return static_cast<uint32_t>(in_flight_.size()); }
+
+private:
+    struct Job {
+        VkCommandBuffer cmd;
+        uint64_t value;
+    };
+
+    VkDevice device_{};
+    VkQueue queue_{};
+    uint32_t family_ = 0;
+    bool dedicated_ = false;
+
+    VkCommandPool pool_{};
+    VkSemaphore timeline_{};
+    uint64_t last_value_ = 0;
+
+    std::deque<Job> in_flight_;
+    std::vector<VkCommandBuffer> free_;
+};
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/cost_stats.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "gfx/async_compute.hpp"
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+// Only the header (everything before the histograms) is needed on the host.
+static constexpr VkDeviceSize kResultSize = offsetof(CostStats::Gpu, hist);
+
+const char *CostStats::counter_name(uint32_t counter) {
+    switch (counter) {
+    case kMarchSteps:
+        return "March steps";
+    case kFieldIterations:
+        return "Field iterations";
+    case kRefineSteps:
+        return "Refine steps";
+    case kShadingEvals:
+        return "Shading evals";
+    default:
+        return "?";
+    }
+}
+
+void CostStats::init(VkContext &ctx, uint32_t slots, AsyncCompute *compute) {
+    device_ = ctx.device();
+    compute_ = compute;
+    slots_.assign(slots, Slot{});
+    const bool shared = compute != nullptr;
+
+    for (Slot &s : slots_) {
+        ctx.create_buffer(kBufferSize,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                              VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          s.storage,
+                          s.storage_mem,
+                          shared);
+        ctx.create_buffer(kResultSize,
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          s.readback,
+                          s.readback_mem,
+                          shared);
+        vk_check(vkMapMemory(device_, s.readback_mem, 0, VK_WHOLE_SIZE, 0, &s.readback_mapped),
+                 "vkMapMemory(cost stats)");
+    }
+
+    // Reduction pipeline: one storage buffer at binding 0.
+    VkDescriptorSetLayoutBinding b0{};
+    b0.binding = 0;
+    b0.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    b0.descriptorCount = 1;
+    b0.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo dslci{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    dslci.bindingCount = 1;
+    dslci.pBindings = &b0;
+    vk_check(vkCreateDescriptorSetLayout(device_, &dslci, nullptr, &dsl_), "vkCreateDescriptorSetLayout(cost stats)");
+
+    VkDescriptorPoolSize ps{};
+    ps.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    ps.descriptorCount = slots;
+
+    VkDescriptorPoolCreateInfo dpci{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    dpci.maxSets = slots;
+    dpci.poolSizeCount = 1;
+    dpci.pPoolSizes = &ps;
+    vk_check(vkCreateDescriptorPool(device_, &dpci, nullptr, &dspool_), "vkCreateDescriptorPool(cost stats)");
+
+    for (Slot &s : slots_) {
+        VkDescriptorSetAllocateInfo dsai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        dsai.descriptorPool = dspool_;
+        dsai.descriptorSetCount = 1;
+        dsai.pSetLayouts = &dsl_;
+        vk_check(vkAllocateDescriptorSets(device_, &dsai, &s.ds), "vkAllocateDescriptorSets(cost stats)");
+
+        VkDescriptorBufferInfo bi{s.storage, 0, kBufferSize};
+        VkWriteDescriptorSet wds{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        wds.dstSet = s.ds;
+        wds.dstBinding = 0;
+        wds.descriptorCount = 1;
+        wds.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        wds.pBufferInfo = &bi;
+        vkUpdateDescriptorSets(device_, 1, &wds, 0, nullptr);
+    }
+
+    VkPipelineLayoutCreateInfo plci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    plci.setLayoutCount = 1;
+    plci.pSetLayouts = &dsl_;
+    vk_check(vkCreatePipelineLayout(device_, &plci, nullptr, &layout_), "vkCreatePipelineLayout(cost stats)");
+
+    VkShaderModule cs = ctx.load_shader("cost_stats.comp.spv");
+
+    VkComputePipelineCreateInfo cpci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    cpci.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    cpci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    cpci.stage.module = cs;
+    cpci.stage.pName = "main";
+    cpci.layout = layout_;
+    vk_check(vkCreateComputePipelines(device_, ctx.pipeline_cache(), 1, &cpci, nullptr, &pipe_),
+             "vkCreateComputePipelines(cost stats)");
+
+    vkDestroyShaderModule(device_, cs, nullptr);
+}
+
+void CostStats::shutdown(VkDevice device) {
+    if (pipe_) {
+        vkDestroyPipeline(device, pipe_, nullptr);
+    }
+    if (layout_) {
+        vkDestroyPipelineLayout(device, layout_, nullptr);
+    }
+    if (dspool_) {
+        vkDestroyDescriptorPool(device, dspool_, nullptr);
+    }
+    if (dsl_) {
+        vkDestroyDescriptorSetLayout(device, dsl_, nullptr);
+    }
+    for (Slot &s : slots_) {
+        vkDestroyBuffer(device, s.readback, nullptr);
+        vkFreeMemory(device, s.readback_mem, nullptr);
+        vkDestroyBuffer(device, s.storage, nullptr);
+        vkFreeMemory(device, s.storage_mem, nullptr);
+    }
+    slots_.clear();
+
+    pipe_ = VK_NULL_HANDLE;
+    layout_ = VK_NULL_HANDLE;
+    dspool_ = VK_NULL_HANDLE;
+    dsl_ = VK_NULL_HANDLE;
+    device_ = VK_NULL_HANDLE;
+    compute_ = nullptr;
+}
+
+void CostStats::begin_frame(VkCommandBuffer cmd, uint32_t slot, uint64_t frame) {
+    Slot &s = slots_[slot];
+    vkCmdFillBuffer(cmd, s.storage, 0, VK_WHOLE_SIZE, 0);
+
+    VkBufferMemoryBarrier2 b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+    b.srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    b.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    b.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    b.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.buffer = s.storage;
+    b.size = VK_WHOLE_SIZE;
+
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.bufferMemoryBarrierCount = 1;
+    dep.pBufferMemoryBarriers = &b;
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    s.frame = frame;
+}
+
+void CostStats::end_frame(VkCommandBuffer cmd, uint32_t slot) {
+    Slot &s = slots_[slot];
+
+    VkBufferMemoryBarrier2 b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+    b.srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    b.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    b.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    b.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.buffer = s.storage;
+    b.size = VK_WHOLE_SIZE;
+
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.bufferMemoryBarrierCount = 1;
+    dep.pBufferMemoryBarriers = &b;
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    record_reduce(cmd, s);
+}
+
+void CostStats::submit_reduce(uint32_t slot, VkSemaphore frame_timeline, uint64_t frame_value) {
+    Slot &s = slots_[slot];
+    // The wait orders the job after the frame's histogram writes, in place of end_frame()'s
+    // barrier.
+    const AsyncCompute::Wait frame_done{frame_timeline, frame_value, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT};
+    s.reduce_job = compute_->submit([this, &s](VkCommandBuffer cmd) { record_reduce(cmd, s); }, {frame_done});
+}
+
+void CostStats::record_reduce(VkCommandBuffer cmd, const Slot &s) const {
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipe_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout_, 0, 1, &s.ds, 0, nullptr);
+    vkCmdDispatch(cmd, kCounters, 1, 1);
+
+    VkBufferMemoryBarrier2 b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.buffer = s.storage;
+    b.size = VK_WHOLE_SIZE;
+    b.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    b.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    b.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    b.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.bufferMemoryBarrierCount = 1;
+    dep.pBufferMemoryBarriers = &b;
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    VkBufferCopy copy{0, 0, kResultSize};
+    vkCmdCopyBuffer(cmd, s.storage, s.readback, 1, &copy);
+
+    b.buffer = s.readback;
+    b.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    b.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    b.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+    b.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+    vkCmdPipelineBarrier2(cmd, &dep);
+}
+
+void CostStats::resolve(uint32_t slot) {
+    Slot &s = slots_[slot];
+    if (s.frame == 0) {
+        return;
+    }
+    if (s.reduce_job != 0 && !compute_->done(s.reduce_job)) {
+        // The compute queue is behind; the slot is about to be reused, so skip this frame.
+        s.frame = 0;
+        return;
+    }
+
+    Gpu result{};
+    std::memcpy(&result, s.readback_mapped, kResultSize);
+
+    latest_.frame = s.frame;
+    latest_.pixels = result.pixels;
+    latest_.hits = result.hits;
+    std::memcpy(latest_.max_value, result.max_value, sizeof(latest_.max_value));
+    std::memcpy(latest_.p50, result.p50, sizeof(latest_.p50));
+    std::memcpy(latest_.p90, result.p90, sizeof(latest_.p90));
+    std::memcpy(latest_.p99, result.p99, sizeof(latest_.p99));
+    std::memcpy(latest_.mean, result.mean, sizeof(latest_.mean));
+    s.frame = 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class AsyncCompute;
+class VkContext;
+
+// Per-pixel cost statistics of the fractal pass.
+//
+// With kDebugCostStats set, every pixel of the fractal pass adds its march steps, fractal
+// iterations, refine steps and shading field evaluations to log-linear histograms in a storage
+// buffer (shaders/cost_stats.glsl). After the pass, a compute dispatch reduces the histograms to
+// percentiles and means on the GPU and the small result is copied to host memory. The reduction
+// is either recorded into the frame (end_frame()) or submitted as a job on the async compute
+// queue that waits for the frame (submit_reduce()). Like the GPU times in FramePacing, results
+// arrive when the frame slot comes around again and its work is known to be complete.
+class CostStats {
+public:
+    static constexpr uint32_t kCounters = 4;
+    static constexpr uint32_t kBuckets = 256;
+
+    enum Counter : uint32_t {
+        kMarchSteps = 0,
+        kFieldIterations = 1,
+        kRefineSteps = 2,
+        kShadingEvals = 3,
+    };
+
+    // Mirrors the CostStatsBuffer block in shaders/cost_stats.glsl (std430).
+    struct Gpu {
+        uint32_t pixels;
+        uint32_t hits;
+        uint32_t pad0[2];
+        uint32_t max_value[kCounters];
+        uint32_t p50[kCounters];
+        uint32_t p90[kCounters];
+        uint32_t p99[kCounters];
+        float mean[kCounters];
+        uint32_t hist[kCounters * kBuckets];
+    };
+    static constexpr VkDeviceSize kBufferSize = sizeof(Gpu);
+
+    struct Summary {
+        uint64_t frame = 0; // 0 = no statistics yet
+        uint32_t pixels = 0;
+        uint32_t hits = 0; // pixels whose ray hit the surface
+        uint32_t max_value[kCounters]{};
+        uint32_t p50[kCounters]{};
+        uint32_t p90[kCounters]{};
+        uint32_t p99[kCounters]{};
+        float mean[kCounters]{};
+    };
+
+    static const char *counter_name(uint32_t counter);
+
+    // With `compute`, the buffers are shared with its queue family for submit_reduce().
+    void init(VkContext &ctx, uint32_t slots, AsyncCompute *compute = nullptr);
+    void shutdown(VkDevice device);
+
+    // Storage buffer bound at binding 1 of the fractal pass for frames using `slot`.
+    VkBuffer buffer(uint32_t slot) const { return slots_[slot].storage; }
+
+    // Clears the slot's counters; record before the fractal pass. The primary must not be
+    // inside rendering.
+    void begin_frame(VkCommandBuffer cmd, uint32_t slot, uint64_t frame);
+    // Reduces the histograms and copies the result for the host; record after the fractal pass.
+    void end_frame(VkCommandBuffer cmd, uint32_t slot);
+
+    // Instead of end_frame(): reduces the histograms on the compute queue once `frame_value` of
+    // the frame timeline has been signalled. Call after the frame's submit.
+    void submit_reduce(uint32_t slot, VkSemaphore frame_timeline, uint64_t frame_value);
+
+    // Compute job still reading the slot's histograms (0 = none); the next frame that calls
+    // begin_frame() on the slot must wait for it before the clear.
+    uint64_t reduce_job(uint32_t slot) const { return slots_[slot].reduce_job; }
+
+    // Reads the result of the frame previously recorded in `slot`. The slot's submission must
+    // have completed. A result whose compute job has not finished yet is dropped.
+    void resolve(uint32_t slot);
+
+    const Summary &latest() const { return latest_; }
+
+private:
+    struct Slot {
+        VkBuffer storage{};
+        VkDeviceMemory storage_mem{};
+        VkBuffer readback{};
+        VkDeviceMemory readback_mem{};
+        void *readback_mapped = nullptr;
+        VkDescriptorSet ds{};
+        uint64_t frame = 0;      // frame whose statistics are in flight in this slot; 0 = none
+        uint64_t reduce_job = 0; // AsyncCompute value of the slot's last reduction; 0 = none
+    };
+
+    // Records the reduction and the copy to the host; the caller orders it after the histogram
+    // writes.
+    void record_reduce(VkCommandBuffer cmd, const Slot &s) const;
+
+    VkDevice device_{};
+    AsyncCompute *compute_ = nullptr;
+    std::vector<Slot> slots_;
+
+    VkDescriptorSetLayout dsl_{};
+    VkDescriptorPool dspool_{};
+    VkPipelineLayout layout_{};
+    VkPipeline pipe_{};
+
+    Summary latest_{};
+};
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/deletion_queue.hpp"
+
+#include <utility>
+
+void DeletionQueue::push(uint64_t retire_value, DestroyFn destroy) {
+    entries_.push_back({retire_value, std::move(destroy)});
+}
+
+void DeletionQueue::collect(uint64_t completed_value) {
+    size_t kept = 0;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (entries_[i].retire_value <= completed_value) {
+            entries_[i].destroy();
+        } else {
+            if (kept != i) {
+                entries_[kept] = std::move(entries_[i]);
+            }
+            kept++;
+        }
+    }
+    entries_.resize(kept);
+}
+
+void DeletionQueue::flush() {
+    for (Entry &e : entries_) {
+        e.destroy();
+    }
+    entries_.clear();
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Deferred destruction of Vulkan objects that may still be referenced by frames in flight.
+//
+// Objects are enqueued together with the FrameRing timeline value after which nothing on the
+// GPU can use them (usually the last submitted frame) and are destroyed once collect() sees
+// that value completed. Replacing a swapchain, pipeline or cached images therefore never
+// needs vkDeviceWaitIdle.
+class DeletionQueue {
+public:
+    using DestroyFn = std::function<void()>;
+
+    // Runs destroy once the timeline has reached retire_value.
+    void push(uint64_t retire_value, DestroyFn destroy);
+
+    // Runs every entry whose value is <= completed_value, in the order they were pushed.
+    void collect(uint64_t completed_value);
+
+    // Runs everything; the device must be idle.
+    void flush();
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        uint64_t retire_value;
+        DestroyFn destroy;
+    };
+
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/frame_pacing.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+void FramePacing::init(VkContext &ctx, uint32_t slots) {
+    device_ = ctx.device();
+
+    uint32_t qf_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.phys(), &qf_count, nullptr);
+    std::vector<VkQueueFamilyProperties> qfs(qf_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.phys(), &qf_count, qfs.data());
+
+    gpu_timing_ = qfs.at(ctx.graphics_qf()).timestampValidBits != 0;
+    timestamp_period_ns_ = ctx.properties().limits.timestampPeriod;
+
+    pools_.assign(slots, VK_NULL_HANDLE);
+    pool_frame_.assign(slots, 0);
+    if (!gpu_timing_) {
+        return;
+    }
+
+    for (auto &pool : pools_) {
+        VkQueryPoolCreateInfo qpci{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+        qpci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        qpci.queryCount = 2;
+        vk_check(vkCreateQueryPool(device_, &qpci, nullptr, &pool), "vkCreateQueryPool(timestamps)");
+    }
+}
+
+void FramePacing::shutdown(VkDevice device) {
+    for (auto &pool : pools_) {
+        if (pool) {
+            vkDestroyQueryPool(device, pool, nullptr);
+        }
+    }
+    pools_.clear();
+    pool_frame_.clear();
+    device_ = VK_NULL_HANDLE;
+}
+
+FramePacing::Sample &FramePacing::at(uint64_t frame) {
+    Sample &s = ring_[frame % kHistory];
+    if (s.frame != frame) {
+        s = Sample{};
+        s.frame = frame;
+    }
+    if (frame > latest_) {
+        latest_ = frame;
+    }
+    return s;
+}
+
+const FramePacing::Sample *FramePacing::find(uint64_t frame) const {
+    const Sample &s = ring_[frame % kHistory];
+    return (s.frame == frame && frame != 0) ? &s : nullptr;
+}
+
+void FramePacing::resolve(uint32_t slot) {
+    if (!gpu_timing_ || pool_frame_[slot] == 0) {
+        return;
+    }
+
+    uint64_t ts[2]{};
+    const VkResult r = vkGetQueryPoolResults(device_,
+                                             pools_[slot],
+                                             0,
+                                             2,
+                                             sizeof(ts),
+                                             ts,
+                                             sizeof(uint64_t),
+                                             VK_QUERY_RESULT_64_BIT);
+    const uint64_t frame = pool_frame_[slot];
+    pool_frame_[slot] = 0;
+    if (r == VK_NOT_READY) {
+        return;
+    }
+    vk_check(r, "vkGetQueryPoolResults");
+
+    Sample &s = ring_[frame % kHistory];
+    if (s.frame == frame) {
+        s.gpu_ms = static_cast<float>(static_cast<double>(ts[1] - ts[0]) * timestamp_period_ns_ * 1e-6);
+    }
+}
+
+void FramePacing::begin_gpu(VkCommandBuffer cmd, uint32_t slot, uint64_t frame) {
+    if (!gpu_timing_) {
+        return;
+    }
+    vkCmdResetQueryPool(cmd, pools_[slot], 0, 2);
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, pools_[slot], 0);
+    pool_frame_[slot] = frame;
+}
+
+void FramePacing::end_gpu(VkCommandBuffer cmd, uint32_t slot) {
+    if (!gpu_timing_) {
+        return;
+    }
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pools_[slot], 1);
+}
+
+void FramePacing::presented(uint64_t frame) {
+    const auto now = std::chrono::steady_clock::now();
+    if (last_present_ != std::chrono::steady_clock::time_point{}) {
+        at(frame).present_interval_ms = std::chrono::duration<float, std::milli>(now - last_present_).count();
+    }
+    last_present_ = now;
+}
+
+double FramePacing::gpu_ms_sum(uint64_t first, uint64_t last) const {
+    if (latest_ >= kHistory) {
+        first = std::max(first, latest_ - kHistory + 1);
+    }
+    double sum = 0.0;
+    for (uint64_t f = std::max<uint64_t>(first, 1); f <= last; f++) {
+        const Sample *s = find(f);
+        if (s && s->gpu_ms >= 0.0f) {
+            sum += s->gpu_ms;
+        }
+    }
+    return sum;
+}
+
+std::vector<float> FramePacing::present_intervals() const {
+    std::vector<float> out;
+    out.reserve(kHistory);
+    const uint64_t first = (latest_ >= kHistory) ? latest_ - kHistory + 1 : 1;
+    for (uint64_t f = first; f <= latest_; f++) {
+        const Sample *s = find(f);
+        out.push_back(s ? s->present_interval_ms : 0.0f);
+    }
+    return out;
+}
+
+void FramePacing::export_csv(const std::string &path) const {
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    std::fprintf(f, "frame,cpu_wait_ms,cpu_frame_ms,gpu_ms,present_interval_ms\n");
+    const uint64_t first = (latest_ >= kHistory) ? latest_ - kHistory + 1 : 1;
+    for (uint64_t frame = first; frame <= latest_; frame++) {
+        const Sample *s = find(frame);
+        if (!s) {
+            continue;
+        }
+        std::fprintf(f,
+                     "%llu,%.4f,%.4f,%.4f,%.4f\n",
+                     static_cast<unsigned long long>(s->frame), // NOLINT(runtime/int)
+                     s->cpu_wait_ms,
+                     s->cpu_frame_ms,
+                     s->gpu_ms,
+                     s->present_interval_ms);
+    }
+
+    if (std::fclose(f) != 0) {
+        throw std::runtime_error("Failed to write file: " + path);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class VkContext;
+
+// Per-frame timing history for stutter analysis.
+//
+// Every frame records how long the CPU blocked on the GPU (frame slot + swapchain acquire),
+// how long it took to build and submit the frame, the GPU time between two timestamps at the
+// start and end of the frame's command buffer, and the interval between consecutive presents.
+// GPU times arrive one frame slot later, when the slot's queries are known to be complete.
+// The last kHistory frames are kept in a ring buffer and can be exported as CSV.
+class FramePacing {
+public:
+    static constexpr uint32_t kHistory = 1024;
+
+    struct Sample {
+        uint64_t frame = 0; // frame number (FrameRing timeline value); 0 = empty
+        float cpu_wait_ms = 0.0f;
+        float cpu_frame_ms = 0.0f;
+        float gpu_ms = -1.0f; // < 0 until resolved or when timestamps are unsupported
+        float present_interval_ms = 0.0f;
+    };
+
+    void init(VkContext &ctx, uint32_t slots);
+    void shutdown(VkDevice device);
+
+    // Sample slot for `frame`, cleared the first time the frame is seen.
+    Sample &at(uint64_t frame);
+    const Sample *find(uint64_t frame) const;
+
+    // Reads the GPU time of the frame previously recorded in `slot`. The slot's submission must
+    // have completed.
+    void resolve(uint32_t slot);
+
+    // Timestamps around the frame's commands; the primary must not be inside rendering.
+    void begin_gpu(VkCommandBuffer cmd, uint32_t slot, uint64_t frame);
+    void end_gpu(VkCommandBuffer cmd, uint32_t slot);
+
+    // Call right after vkQueuePresentKHR for `frame`.
+    void presented(uint64_t frame);
+
+    uint64_t latest_frame() const { return latest_; }
+    bool gpu_timing() const { return gpu_timing_; }
+
+    // Sum of the resolved GPU times of frames first..last still in the history.
+    double gpu_ms_sum(uint64_t first, uint64_t last) const;
+
+    // Ordered oldest to newest, for plotting.
+    std::vector<float> present_intervals() const;
+
+    // Writes frame,cpu_wait_ms,cpu_frame_ms,gpu_ms,present_interval_ms rows; throws on I/O error.
+    void export_csv(const std::string &path) const;
+
+private:
+    std::vector<Sample> ring_ = std::vector<Sample>(kHistory);
+    uint64_t latest_ = 0;
+
+    VkDevice device_{};
+    bool gpu_timing_ = false;
+    float timestamp_period_ns_ = 1.0f;
+    std::vector<VkQueryPool> pools_;
+    std::vector<uint64_t> pool_frame_; // frame whose timestamps are in pools_[slot]; 0 = none
+
+    std::chrono::steady_clock::time_point last_present_{};
+};
@@ -6,83 +6,119 @@
 
 #include <cstring>
 #include <stdexcept>
+#include <string>
 
 #include "gfx/frame_resources.hpp"
 #include "gfx/vk_context.hpp"
 #include "util/checks.hpp"
 
-static uint32_t find_mem_type(VkPhysicalDevice phys, uint32_t type_bits, VkMemoryPropertyFlags flags) {
-    VkPhysicalDeviceMemoryProperties mp{};
-    vkGetPhysicalDeviceMemoryProperties(phys, &mp);
-    for (uint32_t i = 0; i < mp.memoryTypeCount; i++) {
-        if ((type_bits & (1u << i)) && (mp.memoryTypes[i].propertyFlags & flags) == flags) {
-            return i;
-        }
-    }
-    throw std::runtime_error("No suitable memory type");
-}
+void FrameRing::init(VkContext &ctx, uint32_t thread_count) {
+    device_ = ctx.device();
 
-static void make_buffer(VkContext &ctx,
-                        VkDeviceSize size,
-                        VkBufferUsageFlags usage,
-                        VkMemoryPropertyFlags mem_flags,
-                        VkBuffer &buf,
-                        VkDeviceMemory &mem) {
-    VkBufferCreateInfo bci{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-    bci.size = size;
-    bci.usage = usage;
-    bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vk_check(vkCreateBuffer(ctx.device(), &bci, nullptr, &buf), "vkCreateBuffer");
-
-    VkMemoryRequirements req{};
-    vkGetBufferMemoryRequirements(ctx.device(), buf, &req);
-
-    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    mai.allocationSize = req.size;
-    mai.memoryTypeIndex = find_mem_type(ctx.phys(), req.memoryTypeBits, mem_flags);
-
-    vk_check(vkAllocateMemory(ctx.device(), &mai, nullptr, &mem), "vkAllocateMemory");
-    vk_check(vkBindBufferMemory(ctx.device(), buf, mem, 0), "vkBindBufferMemory");
-}
+    VkSemaphoreTypeCreateInfo stci{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    stci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    stci.initialValue = 0;
 
-void FrameRing::init(VkContext &ctx) {
-    // Allocate command buffers
-    VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-    cai.commandPool = ctx.command_pool();
-    cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cai.commandBufferCount = kMaxFrames;
-
-    VkCommandBuffer cbs[kMaxFrames]{};
-    vk_check(vkAllocateCommandBuffers(ctx.device(), &cai, cbs), "vkAllocateCommandBuffers");
+    VkSemaphoreCreateInfo tci{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    tci.pNext = &stci;
+    vk_check(vkCreateSemaphore(ctx.device(), &tci, nullptr, &timeline_), "vkCreateSemaphore(frame timeline)");
+    last_submitted_ = 0;
 
     for (uint32_t i = 0; i < kMaxFrames; i++) {
-        frames_[i].cmd = cbs[i];
+        // Per-thread command pools; buffers are re-recorded every frame, hence TRANSIENT.
+        frames_[i].threads.resize(thread_count);
+        for (auto &t : frames_[i].threads) {
+            VkCommandPoolCreateInfo cpci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+            cpci.queueFamilyIndex = ctx.graphics_qf();
+            cpci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            vk_check(vkCreateCommandPool(ctx.device(), &cpci, nullptr, &t.pool), "vkCreateCommandPool(frame)");
+        }
+
+        VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cai.commandPool = frames_[i].threads[0].pool;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cai.commandBufferCount = 1;
+        vk_check(vkAllocateCommandBuffers(ctx.device(), &cai, &frames_[i].cmd), "vkAllocateCommandBuffers");
 
         VkSemaphoreCreateInfo sci{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
         vk_check(vkCreateSemaphore(ctx.device(), &sci, nullptr, &frames_[i].image_acquired),
                  "vkCreateSemaphore(image_acquired)");
         vk_check(vkCreateSemaphore(ctx.device(), &sci, nullptr, &frames_[i].render_finished),
                  "vkCreateSemaphore(render_finished)");
-
-        VkFenceCreateInfo fci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-        fci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        vk_check(vkCreateFence(ctx.device(), &fci, nullptr, &frames_[i].in_flight), "vkCreateFence");
+        frames_[i].submitted_value = 0;
 
         // Uniform buffer (host visible)
-        make_buffer(ctx,
-                    512,
-                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    frames_[i].ubo,
-                    frames_[i].ubo_mem);
+        ctx.create_buffer(512,
+                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          frames_[i].ubo,
+                          frames_[i].ubo_mem);
 
         vk_check(vkMapMemory(ctx.device(), frames_[i].ubo_mem, 0, VK_WHOLE_SIZE, 0, &frames_[i].ubo_mapped),
                  "vkMapMemory(ubo)");
     }
 }
 
+uint64_t FrameRing::completed_value() const {
+    uint64_t v = 0;
+    vk_check(vkGetSemaphoreCounterValue(device_, timeline_, &v), "vkGetSemaphoreCounterValue(frame)");
+    return v;
+}
+
+bool FrameRing::wait(uint64_t value, uint64_t timeout_ns) const {
+    VkSemaphoreWaitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wi.semaphoreCount = 1;
+    wi.pSemaphores = &timeline_;
+    wi.pValues = &value;
+
+    const VkResult r = vkWaitSemaphores(device_, &wi, timeout_ns);
+    if (r == VK_TIMEOUT) {
+        return false;
+    }
+    vk_check(r, "vkWaitSemaphores(frame)");
+    return true;
+}
+
+void FrameRing::wait_current(uint64_t timeout_ns) {
+    if (!wait(current().submitted_value, timeout_ns)) {
+        throw std::runtime_error("Timed out waiting for frame " + std::to_string(current().submitted_value) +
+                                 " on the GPU");
+    }
+}
+
+void FrameRing::reset_commands() {
+    for (auto &t : current().threads) {
+        vk_check(vkResetCommandPool(device_, t.pool, 0), "vkResetCommandPool");
+        t.used = 0;
+    }
+}
+
+VkCommandBuffer FrameRing::acquire_secondary(uint32_t thread_index) {
+    ThreadCommands &t = current().threads[thread_index];
+    if (t.used == t.secondaries.size()) {
+        VkCommandBufferAllocateInfo cai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cai.commandPool = t.pool;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        cai.commandBufferCount = 1;
+
+        VkCommandBuffer cb{};
+        vk_check(vkAllocateCommandBuffers(device_, &cai, &cb), "vkAllocateCommandBuffers(secondary)");
+        t.secondaries.push_back(cb);
+    }
+    return t.secondaries[t.used++];
+}
+
 void FrameRing::shutdown(VkDevice device) {
     for (auto &f : frames_) {
+        // Destroying a pool frees the command buffers allocated from it.
+        for (auto &t : f.threads) {
+            if (t.pool) {
+                vkDestroyCommandPool(device, t.pool, nullptr);
+            }
+        }
+        f.threads.clear();
+        f.cmd = VK_NULL_HANDLE;
+
         if (f.ubo_mapped) {
             vkUnmapMemory(device, f.ubo_mem);
         }
@@ -99,8 +135,10 @@ void FrameRing::shutdown(VkDevice device) {
         if (f.render_finished) {
             vkDestroySemaphore(device, f.render_finished, nullptr);
         }
-        if (f.in_flight) {
-            vkDestroyFence(device, f.in_flight, nullptr);
-        }
+    }
+
+    if (timeline_) {
+        vkDestroySemaphore(device, timeline_, nullptr);
+        timeline_ = VK_NULL_HANDLE;
     }
 }
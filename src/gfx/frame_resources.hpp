@@ -9,16 +9,29 @@
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
+#include <vector>
+
+// Command pool owned by one recording thread for one frame in flight. The pool is reset as a
+// whole when its frame slot comes around again instead of resetting buffers one by one.
+struct ThreadCommands {
+    VkCommandPool pool{};
+    std::vector<VkCommandBuffer> secondaries;
+    uint32_t used = 0; // secondaries handed out since the last reset
+};
 
 struct FrameResources {
-    VkCommandBuffer cmd{};
+    VkCommandBuffer cmd{}; // primary, allocated from threads[0].pool
+    std::vector<ThreadCommands> threads;
+
+    // Binary semaphores are still required by acquire/present.
     VkSemaphore image_acquired{};
     VkSemaphore render_finished{};
-    VkFence in_flight{};
+    uint64_t submitted_value{}; // FrameRing timeline value signalled by this slot's last submit
 
     VkBuffer ubo{};
     VkDeviceMemory ubo_mem{};
     void *ubo_mapped{};
+    uint64_t ubo_generation{}; // ParamsTracker generation last written to ubo
 };
 
 class VkContext;
@@ -27,9 +40,18 @@ class FrameRing {
 public:
     static constexpr uint32_t kMaxFrames = 2;
 
-    void init(VkContext &ctx);
+    // thread_count: number of threads that record secondaries; each gets its own pool per frame.
+    void init(VkContext &ctx, uint32_t thread_count = 1);
     void shutdown(VkDevice device);
 
+    // Resets every command pool of the current frame. The slot's submitted_value must have completed
+    // on the FrameRing timeline (see wait_current()).
+    void reset_commands();
+
+    // Next unused secondary command buffer of the current frame for the given recording thread.
+    // Pools are externally synchronized, so only that thread may call this with its index.
+    VkCommandBuffer acquire_secondary(uint32_t thread_index);
+
     FrameResources &frame(uint32_t i) { return frames_[i]; }
     const FrameResources &frame(uint32_t i) const { return frames_[i]; }
 
@@ -37,7 +59,27 @@ public:
     uint32_t index() const { return frame_index_; }
     void advance() { frame_index_ = (frame_index_ + 1) % kMaxFrames; }
 
+    // Frame completion is tracked by one timeline semaphore whose value is the frame number:
+    // the submit of frame N signals N, so anything can wait for "frame N has finished".
+    VkSemaphore timeline() const { return timeline_; }
+    uint64_t next_value() const { return last_submitted_ + 1; }
+    uint64_t last_submitted() const { return last_submitted_; }
+    uint64_t completed_value() const;
+
+    // Waits until frame `value` has finished on the GPU; false on timeout.
+    bool wait(uint64_t value, uint64_t timeout_ns) const;
+
+    // Waits until the current slot's previous submission has finished. Throws on timeout,
+    // which means the GPU is hung or lost.
+    void wait_current(uint64_t timeout_ns);
+
+    // Records that the current slot was submitted signalling next_value().
+    void mark_submitted() { current().submitted_value = ++last_submitted_; }
+
 private:
+    VkDevice device_{};
+    VkSemaphore timeline_{};
+    uint64_t last_submitted_ = 0;
     FrameResources frames_[kMaxFrames]{};
     uint32_t frame_index_ = 0;
 };
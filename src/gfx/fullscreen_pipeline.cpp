@@ -11,90 +11,53 @@
 #include <string>
 #include <vector>
 
-#include "gfx/swapchain.hpp"
 #include "gfx/vk_context.hpp"
 #include "util/checks.hpp"
-#include "util/read_file.hpp"
 
-VkShaderModule FullscreenPipeline::load_shader(VkDevice device, const std::string &path) {
-    auto bytes = read_file_binary(path);
-    if (bytes.size() % 4 != 0) {
-        throw std::runtime_error("SPIR-V size not multiple of 4: " + path);
-    }
-
-    VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-    ci.codeSize = bytes.size();
-    ci.pCode = reinterpret_cast<const uint32_t *>(bytes.data());
-
-    VkShaderModule mod{};
-    vk_check(vkCreateShaderModule(device, &ci, nullptr, &mod), "vkCreateShaderModule");
-    return mod;
-}
-
-void FullscreenPipeline::init(VkContext &ctx, const Swapchain &sw, const std::string &shader_dir) {
-    // ----------------------------
-    // Render pass (single color)
+void FullscreenPipeline::init(VkContext &ctx, const std::vector<Variant> &variants) {
     // ----------------------------
-    VkAttachmentDescription color{};
-    color.format = sw.format();
-    color.samples = VK_SAMPLE_COUNT_1_BIT;
-    color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference color_ref{};
-    color_ref.attachment = 0;
-    color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription sub{};
-    sub.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    sub.colorAttachmentCount = 1;
-    sub.pColorAttachments = &color_ref;
-
-    VkSubpassDependency dep{};
-    dep.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dep.dstSubpass = 0;
-    dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep.srcAccessMask = 0;
-    dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo rpci{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
-    rpci.attachmentCount = 1;
-    rpci.pAttachments = &color;
-    rpci.subpassCount = 1;
-    rpci.pSubpasses = &sub;
-    rpci.dependencyCount = 1;
-    rpci.pDependencies = &dep;
-
-    vk_check(vkCreateRenderPass(ctx.device(), &rpci, nullptr, &rp_), "vkCreateRenderPass");
-
+    // Descriptor set layout (UBO at set=0, binding=0; cost statistics SSBO at binding=1;
+    // sampled images at bindings 2..6, each only read by the variants that need it: half-resolution
+    // shadows, interleaved samples, previous history, the image to present and the G-buffer; tile
+    // statistics SSBOs at bindings 7 and 8; parameter atlas SSBO at binding 9)
     // ----------------------------
-    // Descriptor set layout (UBO at set=0, binding=0)
-    // ----------------------------
-    VkDescriptorSetLayoutBinding b0{};
-    b0.binding = 0;
-    b0.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    b0.descriptorCount = 1;
-    b0.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutBinding bindings[kBindings]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    for (uint32_t b = kFirstImageBinding; b < kBindings; b++) {
+        bindings[b].binding = b;
+        bindings[b].descriptorType =
+            (b < kFirstTileBinding) ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[b].descriptorCount = 1;
+        bindings[b].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
 
     VkDescriptorSetLayoutCreateInfo dslci{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    dslci.bindingCount = 1;
-    dslci.pBindings = &b0;
+    dslci.bindingCount = kBindings;
+    dslci.pBindings = bindings;
     vk_check(vkCreateDescriptorSetLayout(ctx.device(), &dslci, nullptr, &dsl_), "vkCreateDescriptorSetLayout");
 
     // Descriptor pool for 2 frames (2 sets)
-    VkDescriptorPoolSize ps{};
-    ps.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    ps.descriptorCount = 2;
+    VkDescriptorPoolSize ps[3]{};
+    ps[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    ps[0].descriptorCount = 2;
+    ps[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    ps[1].descriptorCount = 2 * (1 + kBindings - kFirstTileBinding);
+    ps[2].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    ps[2].descriptorCount = 2 * (kFirstTileBinding - kFirstImageBinding);
 
     VkDescriptorPoolCreateInfo dpci{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
     dpci.maxSets = 2;
-    dpci.poolSizeCount = 1;
-    dpci.pPoolSizes = &ps;
+    dpci.poolSizeCount = 3;
+    dpci.pPoolSizes = ps;
     vk_check(vkCreateDescriptorPool(ctx.device(), &dpci, nullptr, &dspool_), "vkCreateDescriptorPool");
 
     // Allocate descriptor sets
@@ -114,19 +77,26 @@ void FullscreenPipeline::init(VkContext &ctx, const Swapchain &sw, const std::st
     // ----------------------------
     // Shaders
     // ----------------------------
-    VkShaderModule vs = load_shader(ctx.device(), shader_dir + "/fullscreen.vert.spv");
-    VkShaderModule fs = load_shader(ctx.device(), shader_dir + "/fullscreen.frag.spv");
-
-    VkPipelineShaderStageCreateInfo stages[2]{};
-    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    stages[0].module = vs;
-    stages[0].pName = "main";
+    // One fragment shader per variant, all sharing the vertex shader and fixed-function state.
+    VkShaderModule vs = ctx.load_shader("fullscreen.vert.spv");
+    std::vector<VkShaderModule> fss;
+    fss.reserve(variants.size());
+    for (const Variant &v : variants) {
+        fss.push_back(ctx.load_shader(v.frag_shader));
+    }
 
-    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    stages[1].module = fs;
-    stages[1].pName = "main";
+    std::vector<std::array<VkPipelineShaderStageCreateInfo, 2>> stages(fss.size());
+    for (size_t i = 0; i < fss.size(); i++) {
+        stages[i][0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[i][0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[i][0].module = vs;
+        stages[i][0].pName = "main";
+
+        stages[i][1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[i][1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[i][1].module = fss[i];
+        stages[i][1].pName = "main";
+    }
 
     // ----------------------------
     // Fixed-function: fullscreen triangle, no vertex buffers
@@ -165,7 +135,6 @@ void FullscreenPipeline::init(VkContext &ctx, const Swapchain &sw, const std::st
 
     VkGraphicsPipelineCreateInfo gpci{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
     gpci.stageCount = 2;
-    gpci.pStages = stages;
     gpci.pVertexInputState = &vi;
     gpci.pInputAssemblyState = &ia;
     gpci.pViewportState = &vp;
@@ -174,50 +143,51 @@ void FullscreenPipeline::init(VkContext &ctx, const Swapchain &sw, const std::st
     gpci.pColorBlendState = &cb;
     gpci.pDynamicState = &ds;
     gpci.layout = layout_;
-    gpci.renderPass = rp_;
-    gpci.subpass = 0;
-
-    vk_check(vkCreateGraphicsPipelines(ctx.device(), VK_NULL_HANDLE, 1, &gpci, nullptr, &pipe_),
-             "vkCreateGraphicsPipelines");
-
-    vkDestroyShaderModule(ctx.device(), fs, nullptr);
-    vkDestroyShaderModule(ctx.device(), vs, nullptr);
 
-    recreate_framebuffers(ctx.device(), sw);
-}
-
-void FullscreenPipeline::recreate_framebuffers(VkDevice device, const Swapchain &sw) {
-    for (auto f : fb_) {
-        vkDestroyFramebuffer(device, f, nullptr);
+    // Dynamic rendering: the render graph begins rendering on the target, no render pass object.
+    std::vector<VkPipelineRenderingCreateInfo> prcis(fss.size(), {VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO});
+
+    // Variable-rate variants take the rate from the attachment (1x1 when the pass has none).
+    VkPipelineFragmentShadingRateStateCreateInfoKHR fsr{
+        VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR};
+    fsr.fragmentSize = {1, 1};
+    fsr.combinerOps[0] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR;
+    fsr.combinerOps[1] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR;
+
+    // A single call lets the driver compile the variants in parallel.
+    std::vector<VkGraphicsPipelineCreateInfo> gpcis(fss.size(), gpci);
+    for (size_t i = 0; i < fss.size(); i++) {
+        prcis[i].colorAttachmentCount = 1;
+        prcis[i].pColorAttachmentFormats = &variants[i].color_format;
+        gpcis[i].pNext = &prcis[i];
+        gpcis[i].pStages = stages[i].data();
+        if (variants[i].shading_rate) {
+            prcis[i].pNext = &fsr;
+            gpcis[i].flags |= VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+        }
     }
-    fb_.clear();
-
-    fb_.resize(sw.image_views().size());
-
-    for (size_t i = 0; i < sw.image_views().size(); i++) {
-        VkImageView att[] = {sw.image_views()[i]};
-
-        VkFramebufferCreateInfo fci{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
-        fci.renderPass = rp_;
-        fci.attachmentCount = 1;
-        fci.pAttachments = att;
-        fci.width = sw.extent().width;
-        fci.height = sw.extent().height;
-        fci.layers = 1;
+    pipes_.assign(fss.size(), VK_NULL_HANDLE);
+    vk_check(vkCreateGraphicsPipelines(ctx.device(),
+                                       ctx.pipeline_cache(),
+                                       static_cast<uint32_t>(gpcis.size()),
+                                       gpcis.data(),
+                                       nullptr,
+                                       pipes_.data()),
+             "vkCreateGraphicsPipelines");
 
-        vk_check(vkCreateFramebuffer(device, &fci, nullptr, &fb_[i]), "vkCreateFramebuffer");
+    for (VkShaderModule fs : fss) {
+        vkDestroyShaderModule(ctx.device(), fs, nullptr);
     }
+    vkDestroyShaderModule(ctx.device(), vs, nullptr);
 }
 
 void FullscreenPipeline::shutdown(VkDevice device) {
-    for (auto f : fb_) {
-        vkDestroyFramebuffer(device, f, nullptr);
-    }
-    fb_.clear();
-
-    if (pipe_) {
-        vkDestroyPipeline(device, pipe_, nullptr);
+    for (VkPipeline pipe : pipes_) {
+        if (pipe) {
+            vkDestroyPipeline(device, pipe, nullptr);
+        }
     }
+    pipes_.clear();
     if (layout_) {
         vkDestroyPipelineLayout(device, layout_, nullptr);
     }
@@ -227,13 +197,8 @@ void FullscreenPipeline::shutdown(VkDevice device) {
     if (dsl_) {
         vkDestroyDescriptorSetLayout(device, dsl_, nullptr);
     }
-    if (rp_) {
-        vkDestroyRenderPass(device, rp_, nullptr);
-    }
 
-    pipe_ = VK_NULL_HANDLE;
     layout_ = VK_NULL_HANDLE;
     dspool_ = VK_NULL_HANDLE;
     dsl_ = VK_NULL_HANDLE;
-    rp_ = VK_NULL_HANDLE;
 }
@@ -8,38 +8,47 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 class VkContext;
-class Swapchain;
 
 class FullscreenPipeline {
 public:
-    void init(VkContext &ctx, const Swapchain &sw, const std::string &shader_dir);
+    struct Variant {
+        std::string frag_shader;   // name in the context's shader bundle
+        VkFormat color_format;     // format of the target the variant renders into
+        bool shading_rate = false; // rendered with a fragment shading rate attachment
+    };
+
+    // Sampled images without a sampler (texelFetch) at bindings kFirstImageBinding..
+    // kFirstTileBinding-1, after the UBO (0) and the cost statistics buffer (1). The bindings
+    // from kFirstTileBinding on are storage buffers: this and the previous frame's tile
+    // statistics for variable-rate shading, then the parameter atlas's thumbnail parameters.
+    static constexpr uint32_t kFirstImageBinding = 2;
+    static constexpr uint32_t kFirstTileBinding = 7;
+    static constexpr uint32_t kAtlasBinding = 9;
+    static constexpr uint32_t kBindings = 10;
+
+    // One pipeline per variant, in that order. All variants share the vertex shader, the
+    // descriptor set layout and the fixed-function state.
+    void init(VkContext &ctx, const std::vector<Variant> &variants);
     void shutdown(VkDevice device);
 
-    void recreate_framebuffers(VkDevice device, const Swapchain &sw);
-
-    VkRenderPass render_pass() const { return rp_; }
     VkPipelineLayout layout() const { return layout_; }
-    VkPipeline pipeline() const { return pipe_; }
+    VkPipeline pipeline(uint32_t variant) const { return pipes_[variant]; }
+    uint32_t variant_count() const { return static_cast<uint32_t>(pipes_.size()); }
 
     VkDescriptorSetLayout dsl() const { return dsl_; }
     VkDescriptorPool dspool() const { return dspool_; }
     VkDescriptorSet ds(uint32_t frame_index) const { return ds_[frame_index]; }
 
-    VkFramebuffer framebuffer(uint32_t swap_img) const { return fb_.at(swap_img); }
-
 private:
-    VkShaderModule load_shader(VkDevice device, const std::string &path);
-
-    VkRenderPass rp_{};
     VkDescriptorSetLayout dsl_{};
     VkDescriptorPool dspool_{};
     VkPipelineLayout layout_{};
-    VkPipeline pipe_{};
+    std::vector<VkPipeline> pipes_;
 
-    std::vector<VkFramebuffer> fb_;
     VkDescriptorSet ds_[2]{};
 };
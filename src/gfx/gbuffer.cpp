@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/gbuffer.hpp"
+
+#include "gfx/deletion_queue.hpp"
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+void GBuffer::init(VkContext &ctx, DeletionQueue &deferred) {
+    ctx_ = &ctx;
+    deferred_ = &deferred;
+}
+
+void GBuffer::shutdown(VkDevice device) {
+    destroy(device, image_, view_, memory_);
+    image_ = {};
+    view_ = {};
+    memory_ = {};
+    extent_ = {};
+}
+
+void GBuffer::destroy(VkDevice device, VkImage image, VkImageView view, VkDeviceMemory memory) {
+    if (view) {
+        vkDestroyImageView(device, view, nullptr);
+    }
+    if (image) {
+        vkDestroyImage(device, image, nullptr);
+    }
+    if (memory) {
+        vkFreeMemory(device, memory, nullptr);
+    }
+}
+
+bool GBuffer::ensure(VkExtent2D extent, uint64_t retire_value) {
+    if (image_ && extent.width == extent_.width && extent.height == extent_.height) {
+        return false;
+    }
+
+    VkDevice device = ctx_->device();
+    if (image_) {
+        // Frames in flight may still shade from the old G-buffer.
+        deferred_->push(retire_value, [device, image = image_, view = view_, memory = memory_] {
+            destroy(device, image, view, memory);
+        });
+    }
+
+    VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ici.imageType = VK_IMAGE_TYPE_2D;
+    ici.format = kFormat;
+    ici.extent = {extent.width, extent.height, 1};
+    ici.mipLevels = 1;
+    ici.arrayLayers = 1;
+    ici.samples = VK_SAMPLE_COUNT_1_BIT;
+    ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ici.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    vk_check(vkCreateImage(device, &ici, nullptr, &image_), "vkCreateImage(gbuffer)");
+
+    VkMemoryRequirements req{};
+    vkGetImageMemoryRequirements(device, image_, &req);
+    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mai.allocationSize = req.size;
+    mai.memoryTypeIndex = ctx_->find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vk_check(vkAllocateMemory(device, &mai, nullptr, &memory_), "vkAllocateMemory(gbuffer)");
+    vk_check(vkBindImageMemory(device, image_, memory_, 0), "vkBindImageMemory(gbuffer)");
+
+    VkImageViewCreateInfo vci{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    vci.image = image_;
+    vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    vci.format = kFormat;
+    vci.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vk_check(vkCreateImageView(device, &vci, nullptr, &view_), "vkCreateImageView(gbuffer)");
+
+    extent_ = extent;
+    generation_++;
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+class VkContext;
+class DeletionQueue;
+
+// Full-resolution G-buffer of deferred shading (shaders/gbuffer.glsl): hit distance, normal,
+// orbit trap and march steps of every pixel. It outlives the frame, so a frame in which only
+// shading inputs changed can shade the previous frame's march again. Imported into the render
+// graph; between frames it is left in SHADER_READ_ONLY_OPTIMAL.
+class GBuffer {
+public:
+    static constexpr VkFormat kFormat = VK_FORMAT_R32G32B32A32_UINT;
+
+    void init(VkContext &ctx, DeletionQueue &deferred);
+    void shutdown(VkDevice device);
+
+    // (Re)creates the image when the extent differs; the old one is destroyed once the timeline
+    // reaches retire_value. Returns true when the contents were lost.
+    bool ensure(VkExtent2D extent, uint64_t retire_value);
+
+    VkImage image() const { return image_; }
+    VkImageView view() const { return view_; }
+    VkExtent2D extent() const { return extent_; }
+    // Incremented whenever the image is re-created, so cached descriptors can be refreshed.
+    uint64_t generation() const { return generation_; }
+
+private:
+    static void destroy(VkDevice device, VkImage image, VkImageView view, VkDeviceMemory memory);
+
+    VkContext *ctx_ = nullptr;
+    DeletionQueue *deferred_ = nullptr;
+    VkExtent2D extent_{};
+    VkImage image_{};
+    VkImageView view_{};
+    VkDeviceMemory memory_{};
+    uint64_t generation_ = 0;
+};
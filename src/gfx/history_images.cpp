@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/history_images.hpp"
+
+#include "gfx/deletion_queue.hpp"
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+
+void HistoryImages::init(VkContext &ctx, DeletionQueue &deferred, VkFormat format) {
+    ctx_ = &ctx;
+    deferred_ = &deferred;
+    format_ = format;
+}
+
+void HistoryImages::shutdown(VkDevice device) {
+    for (Image &img : images_) {
+        destroy(device, img);
+        img = {};
+    }
+    extent_ = {};
+}
+
+void HistoryImages::destroy(VkDevice device, const Image &img) {
+    if (img.view) {
+        vkDestroyImageView(device, img.view, nullptr);
+    }
+    if (img.image) {
+        vkDestroyImage(device, img.image, nullptr);
+    }
+    if (img.memory) {
+        vkFreeMemory(device, img.memory, nullptr);
+    }
+}
+
+bool HistoryImages::ensure(VkExtent2D extent, uint64_t retire_value) {
+    if (images_[0].image && extent.width == extent_.width && extent.height == extent_.height) {
+        return false;
+    }
+
+    VkDevice device = ctx_->device();
+    if (images_[0].image) {
+        // Frames in flight may still sample the old history.
+        deferred_->push(retire_value, [device, old0 = images_[0], old1 = images_[1]] {
+            destroy(device, old0);
+            destroy(device, old1);
+        });
+    }
+
+    for (Image &img : images_) {
+        VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ici.imageType = VK_IMAGE_TYPE_2D;
+        ici.format = format_;
+        ici.extent = {extent.width, extent.height, 1};
+        ici.mipLevels = 1;
+        ici.arrayLayers = 1;
+        ici.samples = VK_SAMPLE_COUNT_1_BIT;
+        ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ici.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        vk_check(vkCreateImage(device, &ici, nullptr, &img.image), "vkCreateImage(history)");
+
+        VkMemoryRequirements req{};
+        vkGetImageMemoryRequirements(device, img.image, &req);
+        VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        mai.allocationSize = req.size;
+        mai.memoryTypeIndex = ctx_->find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        vk_check(vkAllocateMemory(device, &mai, nullptr, &img.memory), "vkAllocateMemory(history)");
+        vk_check(vkBindImageMemory(device, img.image, img.memory, 0), "vkBindImageMemory(history)");
+
+        VkImageViewCreateInfo vci{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vci.image = img.image;
+        vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vci.format = format_;
+        vci.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vk_check(vkCreateImageView(device, &vci, nullptr, &img.view), "vkCreateImageView(history)");
+    }
+
+    extent_ = extent;
+    current_ = 0;
+    generation_++;
+    return true;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+class VkContext;
+class DeletionQueue;
+
+// Two full-resolution colour images that outlive the frame, for temporal techniques: each frame
+// samples the image the previous frame wrote (previous()) and renders into the other one
+// (current()). Both are imported into the render graph; between frames they are left in
+// SHADER_READ_ONLY_OPTIMAL.
+class HistoryImages {
+public:
+    void init(VkContext &ctx, DeletionQueue &deferred, VkFormat format);
+    void shutdown(VkDevice device);
+
+    // (Re)creates both images when the extent differs; the old ones are destroyed once the
+    // timeline reaches retire_value. Returns true when the history contents were lost.
+    bool ensure(VkExtent2D extent, uint64_t retire_value);
+
+    // Makes the image written this frame the previous one of the next frame.
+    void swap() { current_ ^= 1u; }
+
+    VkImage current_image() const { return images_[current_].image; }
+    VkImageView current_view() const { return images_[current_].view; }
+    VkImage previous_image() const { return images_[current_ ^ 1u].image; }
+    VkImageView previous_view() const { return images_[current_ ^ 1u].view; }
+
+    VkFormat format() const { return format_; }
+    VkExtent2D extent() const { return extent_; }
+    // Incremented whenever the images are re-created, so cached descriptors can be refreshed.
+    uint64_t generation() const { return generation_; }
+
+private:
+    struct Image {
+        VkImage image{};
+        VkImageView view{};
+        VkDeviceMemory memory{};
+    };
+
+    static void destroy(VkDevice device, const Image &img);
+
+    VkContext *ctx_ = nullptr;
+    DeletionQueue *deferred_ = nullptr;
+    VkFormat format_{};
+    VkExtent2D extent_{};
+    Image images_[2]{};
+    uint32_t current_ = 0;
+    uint64_t generation_ = 0;
+};
@@ -52,10 +52,12 @@ void ImGuiLayer::init(GLFWwindow *window,
                       VkDevice device,
                       uint32_t queue_family,
                       VkQueue queue,
-                      VkRenderPass render_pass,
+                      VkFormat color_format,
                       uint32_t image_count,
-                      VkCommandPool /*upload_cmd_pool*/) {
+                      VkCommandPool /*upload_cmd_pool*/,
+                      VkPipelineCache pipeline_cache) {
     device_ = device;
+    color_format_ = color_format;
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -65,7 +67,7 @@ void ImGuiLayer::init(GLFWwindow *window,
     ImGui_ImplGlfw_InitForVulkan(window, true);
 
     ImGui_ImplVulkan_InitInfo init_info{};
-    init_info.ApiVersion = VK_API_VERSION_1_1;
+    init_info.ApiVersion = VK_API_VERSION_1_3;
     init_info.Instance = instance;
     init_info.PhysicalDevice = phys;
     init_info.Device = device_;
@@ -78,13 +80,15 @@ void ImGuiLayer::init(GLFWwindow *window,
     init_info.MinImageCount = image_count;
     init_info.ImageCount = image_count;
 
-    init_info.PipelineInfoMain.RenderPass = render_pass;
-    init_info.PipelineInfoMain.Subpass = 0;
+    // ImGui draws inside the render graph's dynamic rendering instance on the swapchain image.
     init_info.PipelineInfoMain.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+    init_info.PipelineInfoMain.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    init_info.PipelineInfoMain.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+    init_info.PipelineInfoMain.PipelineRenderingCreateInfo.pColorAttachmentFormats = &color_format_;
 
-    init_info.UseDynamicRendering = false;
+    init_info.UseDynamicRendering = true;
 
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = pipeline_cache;
     init_info.Allocator = nullptr;
     init_info.CheckVkResultFn = nullptr;
     init_info.MinAllocationSize = 0;
@@ -100,10 +104,9 @@ void ImGuiLayer::new_frame() {
     ImGui::NewFrame();
 }
 
-void ImGuiLayer::render(VkCommandBuffer cmd) {
-    ImGui::Render();
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
-}
+void ImGuiLayer::end_frame() { ImGui::Render(); }
+
+void ImGuiLayer::record(VkCommandBuffer cmd) { ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd); }
 
 void ImGuiLayer::shutdown() {
     if (device_ == VK_NULL_HANDLE) {
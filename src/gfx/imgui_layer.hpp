@@ -18,15 +18,20 @@ public:
               VkDevice device,
               uint32_t queue_family,
               VkQueue queue,
-              VkRenderPass render_pass,
+              VkFormat color_format,
               uint32_t image_count,
-              VkCommandPool upload_cmd_pool);
+              VkCommandPool upload_cmd_pool,
+              VkPipelineCache pipeline_cache);
 
     void new_frame();
-    void render(VkCommandBuffer cmd);
+    // end_frame() finalizes the draw data and must run on the thread that owns the ImGui
+    // context; record() only reads the draw data and may run on a recording thread.
+    void end_frame();
+    void record(VkCommandBuffer cmd);
     void shutdown();
 
 private:
     VkDevice device_{VK_NULL_HANDLE};
     VkDescriptorPool descriptor_pool_{VK_NULL_HANDLE};
+    VkFormat color_format_{VK_FORMAT_UNDEFINED};
 };
@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/render_graph.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "gfx/deletion_queue.hpp"
+#include "gfx/vk_context.hpp"
+#include "util/checks.hpp"
+#include "util/thread_pool.hpp"
+
+namespace {
+
+constexpr VkAccessFlags2 kWriteAccess = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+                                        VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+constexpr VkPipelineStageFlags2 kShaderStages =
+    VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+struct AccessInfo {
+    VkImageLayout layout;
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+};
+
+AccessInfo access_info(RGAccess a) {
+    switch (a) {
+    case RGAccess::ColorWrite:
+        return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT};
+    case RGAccess::ColorReadWrite:
+        return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT};
+    case RGAccess::Sampled:
+        return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, kShaderStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT};
+    case RGAccess::StorageRead:
+        return {VK_IMAGE_LAYOUT_GENERAL, kShaderStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT};
+    case RGAccess::StorageWrite:
+        return {VK_IMAGE_LAYOUT_GENERAL, kShaderStages, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT};
+    case RGAccess::TransferSrc:
+        return {
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT};
+    case RGAccess::TransferDst:
+        return {
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
+    case RGAccess::ShadingRate:
+        return {VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR,
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR,
+                VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR};
+    }
+    throw std::logic_error("Unknown RGAccess");
+}
+
+VkImageUsageFlags usage_for(RGAccess a) {
+    switch (a) {
+    case RGAccess::ColorWrite:
+    case RGAccess::ColorReadWrite:
+        return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    case RGAccess::Sampled:
+        return VK_IMAGE_USAGE_SAMPLED_BIT;
+    case RGAccess::StorageRead:
+    case RGAccess::StorageWrite:
+        return VK_IMAGE_USAGE_STORAGE_BIT;
+    case RGAccess::TransferSrc:
+        return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    case RGAccess::TransferDst:
+        return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    case RGAccess::ShadingRate:
+        return VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+    }
+    return 0;
+}
+
+bool reads_previous(RGAccess a) { return a != RGAccess::ColorWrite && a != RGAccess::TransferDst; }
+
+bool writes(RGAccess a) {
+    return a == RGAccess::ColorWrite || a == RGAccess::ColorReadWrite || a == RGAccess::StorageWrite ||
+           a == RGAccess::TransferDst;
+}
+
+VkImageCreateInfo image_create_info(VkFormat format, VkExtent2D extent, VkImageUsageFlags usage) {
+    VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ici.imageType = VK_IMAGE_TYPE_2D;
+    ici.format = format;
+    ici.extent = {extent.width, extent.height, 1};
+    ici.mipLevels = 1;
+    ici.arrayLayers = 1;
+    ici.samples = VK_SAMPLE_COUNT_1_BIT;
+    ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ici.usage = usage;
+    ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    return ici;
+}
+
+VkImageMemoryBarrier2 image_barrier(VkImage image) {
+    VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    return b;
+}
+
+void cmd_barriers(VkCommandBuffer cmd, const std::vector<VkImageMemoryBarrier2> &barriers) {
+    if (barriers.empty()) {
+        return;
+    }
+    VkDependencyInfo di{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    di.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+    di.pImageMemoryBarriers = barriers.data();
+    vkCmdPipelineBarrier2(cmd, &di);
+}
+
+VkDeviceSize align_up(VkDeviceSize v, VkDeviceSize a) { return (v + a - 1) / a * a; }
+
+double mib(VkDeviceSize bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+} // namespace
+
+RenderGraph::PassBuilder &
+RenderGraph::PassBuilder::color(RGImage img, VkAttachmentLoadOp load_op, VkClearColorValue clear) {
+    const RGAccess a = (load_op == VK_ATTACHMENT_LOAD_OP_LOAD) ? RGAccess::ColorReadWrite : RGAccess::ColorWrite;
+    graph_->add_use(pass_, img, a, load_op, clear);
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::sampled(RGImage img) {
+    graph_->add_use(pass_, img, RGAccess::Sampled, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::storage_read(RGImage img) {
+    graph_->add_use(pass_, img, RGAccess::StorageRead, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::storage_write(RGImage img) {
+    graph_->add_use(pass_, img, RGAccess::StorageWrite, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::transfer_src(RGImage img) {
+    graph_->add_use(pass_, img, RGAccess::TransferSrc, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::transfer_dst(RGImage img) {
+    graph_->add_use(pass_, img, RGAccess::TransferDst, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::shading_rate(RGImage img, VkExtent2D texel_size) {
+    graph_->add_use(pass_, img, RGAccess::ShadingRate, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {});
+    graph_->passes_[pass_].shading_rate = img;
+    graph_->passes_[pass_].shading_rate_texel = texel_size;
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::side_effect() {
+    graph_->passes_[pass_].side_effect = true;
+    return *this;
+}
+
+void RenderGraph::init(VkContext &ctx, DeletionQueue &deferred) {
+    ctx_ = &ctx;
+    deferred_ = &deferred;
+    device_ = ctx.device();
+}
+
+void RenderGraph::shutdown() {
+    if (device_ == VK_NULL_HANDLE) {
+        return;
+    }
+    destroy_physical(device_, physical_, heap_);
+    physical_.clear();
+    heap_ = VK_NULL_HANDLE;
+    reset();
+    device_ = VK_NULL_HANDLE;
+    ctx_ = nullptr;
+    deferred_ = nullptr;
+}
+
+void RenderGraph::reset() {
+    passes_.clear();
+    images_.clear();
+    final_barriers_.clear();
+}
+
+RGImage RenderGraph::import_image(const char *name,
+                                  VkImage image,
+                                  VkImageView view,
+                                  VkFormat format,
+                                  VkExtent2D extent,
+                                  VkImageLayout initial_layout,
+                                  VkImageLayout final_layout) {
+    Image img;
+    img.name = name;
+    img.image = image;
+    img.view = view;
+    img.format = format;
+    img.extent = extent;
+    img.imported = true;
+    img.initial_layout = initial_layout;
+    img.final_layout = final_layout;
+    images_.push_back(img);
+    return static_cast<RGImage>(images_.size() - 1);
+}
+
+RGImage RenderGraph::create_image(const char *name, VkFormat format, VkExtent2D extent) {
+    Image img;
+    img.name = name;
+    img.format = format;
+    img.extent = extent;
+    images_.push_back(img);
+    return static_cast<RGImage>(images_.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(const char *name, RecordFn record) {
+    Pass p;
+    p.name = name;
+    p.record = std::move(record);
+    passes_.push_back(std::move(p));
+    return PassBuilder(this, static_cast<uint32_t>(passes_.size() - 1));
+}
+
+void RenderGraph::add_use(
+    uint32_t pass, RGImage img, RGAccess access, VkAttachmentLoadOp load_op, VkClearColorValue clear) {
+    if (img >= images_.size()) {
+        throw std::runtime_error("Render graph: pass '" + passes_[pass].name + "' uses an unknown image");
+    }
+    passes_[pass].uses.push_back({img, access, load_op, clear});
+}
+
+void RenderGraph::cull() {
+    // Walk backwards tracking which images still have a pending reader. Imported images are
+    // read after the frame; a full overwrite (cleared colour, transfer destination) ends the
+    // dependency on earlier contents.
+    std::vector<bool> needed(images_.size());
+    for (size_t i = 0; i < images_.size(); i++) {
+        needed[i] = images_[i].imported;
+    }
+
+    for (size_t pi = passes_.size(); pi-- > 0;) {
+        Pass &p = passes_[pi];
+        p.live = p.side_effect;
+        for (const Use &u : p.uses) {
+            if (writes(u.access) && needed[u.img]) {
+                p.live = true;
+            }
+        }
+        if (!p.live) {
+            continue;
+        }
+        for (const Use &u : p.uses) {
+            if (!reads_previous(u.access)) {
+                needed[u.img] = false;
+            }
+        }
+        for (const Use &u : p.uses) {
+            if (reads_previous(u.access)) {
+                needed[u.img] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::place_transients(uint64_t retire_value) {
+    // Lifetimes and usage over live passes only.
+    for (uint32_t pi = 0; pi < passes_.size(); pi++) {
+        if (!passes_[pi].live) {
+            continue;
+        }
+        for (const Use &u : passes_[pi].uses) {
+            Image &img = images_[u.img];
+            if (img.imported) {
+                continue;
+            }
+            img.usage |= usage_for(u.access);
+            img.first_pass = std::min(img.first_pass, pi);
+            img.last_pass = std::max(img.last_pass, pi);
+        }
+    }
+
+    struct Item {
+        uint32_t image;
+        VkDeviceSize size;
+        VkDeviceSize alignment;
+        VkDeviceSize offset;
+    };
+    std::vector<Item> items;
+    uint32_t type_bits = ~0u;
+
+    for (uint32_t i = 0; i < images_.size(); i++) {
+        const Image &img = images_[i];
+        if (img.imported || img.first_pass == UINT32_MAX) {
+            continue;
+        }
+
+        const VkImageCreateInfo ici = image_create_info(img.format, img.extent, img.usage);
+        VkDeviceImageMemoryRequirements dimr{VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS};
+        dimr.pCreateInfo = &ici;
+        VkMemoryRequirements2 req{VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+        vkGetDeviceImageMemoryRequirements(device_, &dimr, &req);
+
+        items.push_back({i, req.memoryRequirements.size, req.memoryRequirements.alignment, 0});
+        type_bits &= req.memoryRequirements.memoryTypeBits;
+    }
+
+    // Greedy placement, largest first: each image goes to the lowest offset that does not
+    // overlap an already placed image whose lifetime intersects its own.
+    std::vector<uint32_t> order(items.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return items[a].size > items[b].size; });
+
+    VkDeviceSize heap_size = 0;
+    VkDeviceSize requested = 0;
+    std::vector<uint32_t> placed;
+    for (uint32_t oi : order) {
+        Item &it = items[oi];
+        const Image &img = images_[it.image];
+
+        std::vector<VkDeviceSize> candidates{0};
+        for (uint32_t pi : placed) {
+            candidates.push_back(items[pi].offset + items[pi].size);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (VkDeviceSize c : candidates) {
+            const VkDeviceSize off = align_up(c, it.alignment);
+            bool fits = true;
+            for (uint32_t pi : placed) {
+                const Item &o = items[pi];
+                const Image &oimg = images_[o.image];
+                const bool lifetimes_overlap = img.first_pass <= oimg.last_pass && oimg.first_pass <= img.last_pass;
+                const bool memory_overlaps = off < o.offset + o.size && o.offset < off + it.size;
+                if (lifetimes_overlap && memory_overlaps) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                it.offset = off;
+                break;
+            }
+        }
+
+        placed.push_back(oi);
+        heap_size = std::max(heap_size, it.offset + it.size);
+        requested += it.size;
+    }
+
+    std::vector<Physical> wanted;
+    for (Item &it : items) {
+        Image &img = images_[it.image];
+        img.physical = static_cast<uint32_t>(wanted.size());
+
+        Physical ph;
+        ph.format = img.format;
+        ph.extent = img.extent;
+        ph.usage = img.usage;
+        ph.offset = it.offset;
+        ph.size = it.size;
+        wanted.push_back(ph);
+    }
+
+    stats_.transients = static_cast<uint32_t>(items.size());
+    stats_.transient_bytes = requested;
+
+    const auto same = [](const Physical &a, const Physical &b) {
+        return a.format == b.format && a.extent.width == b.extent.width && a.extent.height == b.extent.height &&
+               a.usage == b.usage && a.offset == b.offset && a.size == b.size;
+    };
+    bool unchanged = wanted.size() == physical_.size();
+    for (size_t i = 0; unchanged && i < wanted.size(); i++) {
+        unchanged = same(wanted[i], physical_[i]);
+    }
+
+    if (!unchanged) {
+        // Placement changed (first frame, resize, new pass setup): the old images may still be in
+        // use by frames in flight, so they are retired rather than destroyed.
+        if (!physical_.empty() || heap_) {
+            VkDevice device = device_;
+            deferred_->push(retire_value, [device, old = std::move(physical_), old_heap = heap_] {
+                destroy_physical(device, old, old_heap);
+            });
+            physical_.clear();
+            heap_ = VK_NULL_HANDLE;
+        }
+        stats_.heap_bytes = 0;
+
+        if (!wanted.empty()) {
+            if (type_bits == 0) {
+                throw std::runtime_error("Render graph: transient images share no memory type");
+            }
+
+            VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+            mai.allocationSize = heap_size;
+            mai.memoryTypeIndex = ctx_->find_memory_type(type_bits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            vk_check(vkAllocateMemory(device_, &mai, nullptr, &heap_), "vkAllocateMemory(render graph)");
+        }
+
+        for (Physical &ph : wanted) {
+            const VkImageCreateInfo ici = image_create_info(ph.format, ph.extent, ph.usage);
+            vk_check(vkCreateImage(device_, &ici, nullptr, &ph.image), "vkCreateImage(transient)");
+            vk_check(vkBindImageMemory(device_, ph.image, heap_, ph.offset), "vkBindImageMemory(transient)");
+
+            VkImageViewCreateInfo vci{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+            vci.image = ph.image;
+            vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            vci.format = ph.format;
+            vci.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            vci.subresourceRange.levelCount = 1;
+            vci.subresourceRange.layerCount = 1;
+            vk_check(vkCreateImageView(device_, &vci, nullptr, &ph.view), "vkCreateImageView(transient)");
+        }
+
+        physical_ = std::move(wanted);
+        stats_.heap_bytes = heap_size;
+        physical_generation_++;
+    }
+
+    for (Image &img : images_) {
+        if (img.physical != UINT32_MAX) {
+            img.image = physical_[img.physical].image;
+            img.view = physical_[img.physical].view;
+        }
+    }
+}
+
+void RenderGraph::build_barriers() {
+    struct State {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+    };
+
+    std::vector<State> states(images_.size());
+    for (size_t i = 0; i < images_.size(); i++) {
+        const Image &img = images_[i];
+        if (img.imported && img.initial_layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+            // Swapchain images: the acquire semaphore is waited on at colour attachment output.
+            states[i] = {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE};
+        } else {
+            // Previous frame's contents, or another transient previously placed in the same memory.
+            states[i] = {img.initial_layout, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT};
+        }
+    }
+
+    stats_.barriers = 0;
+    for (Pass &p : passes_) {
+        p.barriers.clear();
+        if (!p.live) {
+            continue;
+        }
+
+        for (const Use &u : p.uses) {
+            State &st = states[u.img];
+            const AccessInfo need = access_info(u.access);
+
+            const bool layout_change = st.layout != need.layout;
+            const bool hazard = (st.access & kWriteAccess) || (need.access & kWriteAccess);
+            if (!layout_change && !hazard) {
+                // Read after read in the same layout: no barrier, but later writers must wait
+                // for these readers too.
+                st.stages |= need.stages;
+                st.access |= need.access;
+                continue;
+            }
+
+            VkImageMemoryBarrier2 b = image_barrier(images_[u.img].image);
+            b.srcStageMask = st.stages;
+            b.srcAccessMask = st.access & kWriteAccess;
+            b.dstStageMask = need.stages;
+            b.dstAccessMask = need.access;
+            // Contents that are about to be fully overwritten need not be preserved.
+            b.oldLayout = reads_previous(u.access) ? st.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+            b.newLayout = need.layout;
+            p.barriers.push_back(b);
+
+            st = {need.layout, need.stages, need.access};
+        }
+        stats_.barriers += static_cast<uint32_t>(p.barriers.size());
+    }
+
+    final_barriers_.clear();
+    for (size_t i = 0; i < images_.size(); i++) {
+        const Image &img = images_[i];
+        if (!img.imported || img.final_layout == VK_IMAGE_LAYOUT_UNDEFINED || states[i].layout == img.final_layout) {
+            continue;
+        }
+        // Whatever consumes the image next (present, next frame) synchronizes through
+        // semaphores or its own first barrier.
+        VkImageMemoryBarrier2 b = image_barrier(img.image);
+        b.srcStageMask = states[i].stages;
+        b.srcAccessMask = states[i].access & kWriteAccess;
+        b.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        b.dstAccessMask = VK_ACCESS_2_NONE;
+        b.oldLayout = states[i].layout;
+        b.newLayout = img.final_layout;
+        final_barriers_.push_back(b);
+    }
+    stats_.barriers += static_cast<uint32_t>(final_barriers_.size());
+}
+
+void RenderGraph::compile(uint64_t retire_value) {
+    cull();
+    place_transients(retire_value);
+    build_barriers();
+
+    stats_.passes = 0;
+    stats_.culled = 0;
+    for (const Pass &p : passes_) {
+        if (p.live) {
+            stats_.passes++;
+        } else {
+            stats_.culled++;
+        }
+    }
+}
+
+void RenderGraph::record_pass(VkCommandBuffer cmd, const Pass &pass) const {
+    cmd_barriers(cmd, pass.barriers);
+
+    std::vector<VkRenderingAttachmentInfo> colors;
+    VkExtent2D area{};
+    for (const Use &u : pass.uses) {
+        if (u.access != RGAccess::ColorWrite && u.access != RGAccess::ColorReadWrite) {
+            continue;
+        }
+        VkRenderingAttachmentInfo a{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
+        a.imageView = images_[u.img].view;
+        a.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        a.loadOp = u.load_op;
+        a.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        a.clearValue.color = u.clear;
+        colors.push_back(a);
+        area = images_[u.img].extent;
+    }
+
+    if (!colors.empty()) {
+        VkRenderingInfo ri{VK_STRUCTURE_TYPE_RENDERING_INFO};
+        ri.renderArea.extent = area;
+        ri.layerCount = 1;
+        ri.colorAttachmentCount = static_cast<uint32_t>(colors.size());
+        ri.pColorAttachments = colors.data();
+
+        VkRenderingFragmentShadingRateAttachmentInfoKHR sr{
+            VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR};
+        if (pass.shading_rate != kRGNone) {
+            sr.imageView = images_[pass.shading_rate].view;
+            sr.imageLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+            sr.shadingRateAttachmentTexelSize = pass.shading_rate_texel;
+            ri.pNext = &sr;
+        }
+        vkCmdBeginRendering(cmd, &ri);
+    }
+
+    pass.record(cmd);
+
+    if (!colors.empty()) {
+        vkCmdEndRendering(cmd);
+    }
+}
+
+void RenderGraph::execute(VkCommandBuffer primary, ThreadPool *pool, const AcquireFn &acquire) {
+    std::vector<const Pass *> live;
+    for (const Pass &p : passes_) {
+        if (p.live) {
+            live.push_back(&p);
+        }
+    }
+
+    // Barriers were resolved in compile(), so passes can be recorded in any order; the primary
+    // executes them in declaration order.
+    std::vector<VkCommandBuffer> secondaries(live.size());
+    std::vector<std::exception_ptr> errors(live.size());
+
+    const auto record = [&](uint32_t i, uint32_t thread_index) {
+        try {
+            VkCommandBuffer cmd = acquire(thread_index);
+
+            // Passes begin their own rendering, so nothing is inherited.
+            VkCommandBufferInheritanceInfo inh{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+            VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            bi.pInheritanceInfo = &inh;
+            vk_check(vkBeginCommandBuffer(cmd, &bi), "vkBeginCommandBuffer(secondary)");
+
+            record_pass(cmd, *live[i]);
+
+            vk_check(vkEndCommandBuffer(cmd), "vkEndCommandBuffer(secondary)");
+            secondaries[i] = cmd;
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    const uint32_t count = static_cast<uint32_t>(live.size());
+    if (pool) {
+        pool->parallel_for(count, record);
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            record(i, 0);
+        }
+    }
+    for (const auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    if (count > 0) {
+        vkCmdExecuteCommands(primary, count, secondaries.data());
+    }
+    cmd_barriers(primary, final_barriers_);
+}
+
+std::string RenderGraph::summary() const {
+    std::string out = std::format("render graph: {} passes ({} culled), {} barriers, {} transients, "
+                                  "{:.2f} MiB requested / {:.2f} MiB allocated\n",
+                                  stats_.passes,
+                                  stats_.culled,
+                                  stats_.barriers,
+                                  stats_.transients,
+                                  mib(stats_.transient_bytes),
+                                  mib(stats_.heap_bytes));
+    for (const Pass &p : passes_) {
+        if (p.live) {
+            out += std::format("  {:<12} {} barriers\n", p.name, p.barriers.size());
+        } else {
+            out += std::format("  {:<12} culled\n", p.name);
+        }
+    }
+    for (const Image &img : images_) {
+        if (img.physical != UINT32_MAX) {
+            const Physical &ph = physical_[img.physical];
+            out += std::format("  {:<12} {}x{} @ {:.2f} MiB, passes {}-{}\n",
+                               img.name,
+                               img.extent.width,
+                               img.extent.height,
+                               mib(ph.offset),
+                               img.first_pass,
+                               img.last_pass);
+        }
+    }
+    return out;
+}
+
+void RenderGraph::destroy_physical(VkDevice device, const std::vector<Physical> &physical, VkDeviceMemory heap) {
+    for (const Physical &ph : physical) {
+        if (ph.view) {
+            vkDestroyImageView(device, ph.view, nullptr);
+        }
+        if (ph.image) {
+            vkDestroyImage(device, ph.image, nullptr);
+        }
+    }
+    if (heap) {
+        vkFreeMemory(device, heap, nullptr);
+    }
+}
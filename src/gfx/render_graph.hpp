@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class VkContext;
+class ThreadPool;
+class DeletionQueue;
+
+// Handle of an image declared in the current frame's graph.
+using RGImage = uint32_t;
+constexpr RGImage kRGNone = UINT32_MAX;
+
+enum class RGAccess : uint8_t {
+    ColorWrite,     // colour attachment, previous contents cleared or discarded
+    ColorReadWrite, // colour attachment, previous contents loaded (overlays, blending)
+    Sampled,        // sampled in fragment or compute shaders
+    StorageRead,
+    StorageWrite,
+    TransferSrc,
+    TransferDst, // the whole image is overwritten
+    ShadingRate, // fragment shading rate attachment (VK_KHR_fragment_shading_rate)
+};
+
+// Small per-frame render graph.
+//
+// The graph is rebuilt every frame: images are imported (swapchain, history) or created as
+// transients, passes declare how they use them, and compile() then
+//  - culls passes whose results never reach an imported image or a side-effect pass,
+//  - computes image layout transitions and synchronization2 barriers between passes,
+//  - places transient images with disjoint lifetimes at overlapping offsets of one memory
+//    block. The placement is cached and only rebuilt when descriptions change (e.g. resize);
+//    the replaced images go to the deletion queue instead of stalling the device.
+// execute() records each live pass into its own secondary command buffer (in parallel when a
+// thread pool is given), beginning dynamic rendering for passes with colour attachments.
+//
+// Only colour images are supported; the renderer has no depth buffer.
+class RenderGraph {
+public:
+    using RecordFn = std::function<void(VkCommandBuffer cmd)>;
+    using AcquireFn = std::function<VkCommandBuffer(uint32_t thread_index)>;
+
+    class PassBuilder {
+    public:
+        // Colour attachment; LOAD_OP_LOAD reads the previous contents.
+        PassBuilder &color(RGImage img, VkAttachmentLoadOp load_op, VkClearColorValue clear = {});
+        PassBuilder &sampled(RGImage img);
+        PassBuilder &storage_read(RGImage img);
+        PassBuilder &storage_write(RGImage img);
+        PassBuilder &transfer_src(RGImage img);
+        PassBuilder &transfer_dst(RGImage img);
+        // Fragment shading rate attachment of the pass's rendering, one texel per `texel_size`
+        // pixels; the pass's pipelines must be created for it.
+        PassBuilder &shading_rate(RGImage img, VkExtent2D texel_size);
+        // Never culled, even if nothing reads its outputs (readbacks, queries).
+        PassBuilder &side_effect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph *graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+        RenderGraph *graph_;
+        uint32_t pass_;
+    };
+
+    void init(VkContext &ctx, DeletionQueue &deferred);
+    void shutdown();
+
+    // Starts a new frame description; handles from previous frames become invalid.
+    void reset();
+
+    // External image with the layout it has before the frame and must have after it.
+    RGImage import_image(const char *name,
+                         VkImage image,
+                         VkImageView view,
+                         VkFormat format,
+                         VkExtent2D extent,
+                         VkImageLayout initial_layout,
+                         VkImageLayout final_layout);
+
+    // Image that only lives inside the frame; its memory may be shared with other transients.
+    RGImage create_image(const char *name, VkFormat format, VkExtent2D extent);
+
+    PassBuilder add_pass(const char *name, RecordFn record);
+
+    // retire_value: frame timeline value after which images used by earlier frames are free.
+    void compile(uint64_t retire_value);
+
+    // Records all live passes. Secondaries come from acquire(thread_index); pool may be null to
+    // record everything on the calling thread. Final layout transitions go into primary.
+    void execute(VkCommandBuffer primary, ThreadPool *pool, const AcquireFn &acquire);
+
+    VkImage image(RGImage img) const { return images_.at(img).image; }
+    VkImageView view(RGImage img) const { return images_.at(img).view; }
+    VkExtent2D extent(RGImage img) const { return images_.at(img).extent; }
+
+    // Incremented whenever transient images are re-created, so cached descriptors can be
+    // refreshed.
+    uint64_t physical_generation() const { return physical_generation_; }
+
+    struct Stats {
+        uint32_t passes = 0;
+        uint32_t culled = 0;
+        uint32_t barriers = 0;
+        uint32_t transients = 0;
+        VkDeviceSize transient_bytes = 0; // sum of the transient images' sizes
+        VkDeviceSize heap_bytes = 0;      // memory actually allocated after aliasing
+    };
+    const Stats &stats() const { return stats_; }
+    std::string summary() const;
+
+private:
+    struct Use {
+        RGImage img;
+        RGAccess access;
+        VkAttachmentLoadOp load_op;
+        VkClearColorValue clear;
+    };
+    struct Pass {
+        std::string name;
+        RecordFn record;
+        std::vector<Use> uses;
+        bool side_effect = false;
+        bool live = false;
+        RGImage shading_rate = kRGNone;
+        VkExtent2D shading_rate_texel{};
+        std::vector<VkImageMemoryBarrier2> barriers; // emitted before the pass
+    };
+    struct Image {
+        std::string name;
+        VkImage image{};
+        VkImageView view{};
+        VkFormat format{};
+        VkExtent2D extent{};
+        bool imported = false;
+        VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Transients only.
+        VkImageUsageFlags usage = 0;
+        uint32_t first_pass = UINT32_MAX;
+        uint32_t last_pass = 0;
+        uint32_t physical = UINT32_MAX;
+    };
+    struct Physical {
+        VkFormat format{};
+        VkExtent2D extent{};
+        VkImageUsageFlags usage = 0;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        VkImage image{};
+        VkImageView view{};
+    };
+
+    void add_use(uint32_t pass, RGImage img, RGAccess access, VkAttachmentLoadOp load_op, VkClearColorValue clear);
+    void cull();
+    void place_transients(uint64_t retire_value);
+    void build_barriers();
+    static void destroy_physical(VkDevice device, const std::vector<Physical> &physical, VkDeviceMemory heap);
+    void record_pass(VkCommandBuffer cmd, const Pass &pass) const;
+
+    VkDevice device_{};
+    VkContext *ctx_ = nullptr;
+    DeletionQueue *deferred_ = nullptr;
+
+    std::vector<Pass> passes_;
+    std::vector<Image> images_;
+    std::vector<VkImageMemoryBarrier2> final_barriers_;
+
+    // Transient images are kept across frames and rebuilt only when the placement changes.
+    std::vector<Physical> physical_;
+    VkDeviceMemory heap_{};
+    uint64_t physical_generation_ = 0;
+
+    Stats stats_{};
+};
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "gfx/shading_rate.hpp"
+
+#include <vector>
+
+#include "gfx/deletion_queue.hpp"
+#include "gfx/vk_context.hpp"
+
+void ShadingRate::init(VkContext &ctx, DeletionQueue *deferred, uint32_t slots, VkExtent2D tile) {
+    ctx_ = &ctx;
+    deferred_ = deferred;
+    slots_.assign(slots, Slot{});
+    tile_ = tile;
+}
+
+void ShadingRate::shutdown(VkDevice device) {
+    destroy(device, slots_);
+    slots_.clear();
+    extent_ = {};
+    tiles_ = {};
+    size_ = 0;
+}
+
+void ShadingRate::destroy(VkDevice device, const std::vector<Slot> &slots) {
+    for (const Slot &s : slots) {
+        if (s.buffer) {
+            vkDestroyBuffer(device, s.buffer, nullptr);
+        }
+        if (s.memory) {
+            vkFreeMemory(device, s.memory, nullptr);
+        }
+    }
+}
+
+bool ShadingRate::ensure(VkExtent2D extent, uint64_t retire_value) {
+    if (slots_.empty() || (slots_[0].buffer && extent.width == extent_.width && extent.height == extent_.height)) {
+        return false;
+    }
+
+    VkDevice device = ctx_->device();
+    if (slots_[0].buffer) {
+        if (deferred_) {
+            // Frames in flight may still accumulate into or read the old statistics.
+            deferred_->push(retire_value, [device, old = slots_] { destroy(device, old); });
+        } else {
+            destroy(device, slots_);
+        }
+    }
+
+    tiles_ = {(extent.width + tile_.width - 1) / tile_.width, (extent.height + tile_.height - 1) / tile_.height};
+    size_ = static_cast<VkDeviceSize>(tiles_.width) * tiles_.height * sizeof(Tile);
+    for (Slot &s : slots_) {
+        ctx_->create_buffer(size_,
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            s.buffer,
+                            s.memory);
+    }
+
+    extent_ = extent;
+    last_frame_ = 0;
+    generation_++;
+    return true;
+}
+
+void ShadingRate::begin_frame(VkCommandBuffer cmd, uint32_t slot, uint64_t frame) {
+    const uint32_t prev = (slot + 1) % static_cast<uint32_t>(slots_.size());
+    // Without the previous frame's statistics (first frame, resize, rates just enabled) the
+    // other slot holds stale tiles; cleared, they read as "no data".
+    const bool clear_prev = prev != slot && last_frame_ + 1 != frame;
+    last_frame_ = frame;
+
+    std::vector<VkBufferMemoryBarrier2> barriers;
+    const auto barrier = [&](VkBuffer buffer,
+                             VkPipelineStageFlags2 src_stage,
+                             VkAccessFlags2 src_access,
+                             VkPipelineStageFlags2 dst_stage,
+                             VkAccessFlags2 dst_access) {
+        VkBufferMemoryBarrier2 b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+        b.srcStageMask = src_stage;
+        b.srcAccessMask = src_access;
+        b.dstStageMask = dst_stage;
+        b.dstAccessMask = dst_access;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.buffer = buffer;
+        b.size = VK_WHOLE_SIZE;
+        barriers.push_back(b);
+    };
+    const auto flush = [&] {
+        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        dep.bufferMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+        dep.pBufferMemoryBarriers = barriers.data();
+        vkCmdPipelineBarrier2(cmd, &dep);
+        barriers.clear();
+    };
+
+    // The slot was last read as "previous" by the frame before; the other slot was written by it.
+    barrier(slots_[slot].buffer,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            0,
+            VK_PIPELINE_STAGE_2_CLEAR_BIT,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT);
+    if (clear_prev) {
+        barrier(slots_[prev].buffer,
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                VK_PIPELINE_STAGE_2_CLEAR_BIT,
+                VK_ACCESS_2_TRANSFER_WRITE_BIT);
+    }
+    flush();
+
+    vkCmdFillBuffer(cmd, slots_[slot].buffer, 0, VK_WHOLE_SIZE, 0);
+    if (clear_prev) {
+        vkCmdFillBuffer(cmd, slots_[prev].buffer, 0, VK_WHOLE_SIZE, 0);
+    }
+
+    barrier(slots_[slot].buffer,
+            VK_PIPELINE_STAGE_2_CLEAR_BIT,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    if (prev != slot) {
+        barrier(slots_[prev].buffer,
+                clear_prev ? VK_PIPELINE_STAGE_2_CLEAR_BIT : VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                clear_prev ? VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+    }
+    flush();
+}
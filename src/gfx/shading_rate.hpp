@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class VkContext;
+class DeletionQueue;
+
+// Per-tile statistics for variable-rate shading (VK_KHR_fragment_shading_rate).
+//
+// With GpuParams::vrs0[0] set, every fragment of the fractal pass adds itself, whether its ray
+// hit, its march steps and its normal to the statistics of its screen tile in a storage buffer
+// (shaders/tile_stats.glsl). The next frame's shading_rate.frag turns the tiles into a shading
+// rate image, one texel per tile, that the fractal pass uses as its fragment shading rate
+// attachment: background and smooth, cheap surface tiles are shaded at 2x2 or 4x4.
+//
+// Each frame slot owns a buffer; a frame writes its slot's and reads the other slot's, which
+// the previous frame wrote.
+class ShadingRate {
+public:
+    // Mirrors TileStats in shaders/tile_stats.glsl (std430).
+    struct Tile {
+        uint32_t fragments;
+        uint32_t hits;
+        uint32_t max_steps;
+        int32_t normal_sum[3]; // hit normals, scaled by TILE_NORMAL_SCALE
+    };
+    static_assert(sizeof(Tile) == 24);
+
+    // tile: screen tile in pixels, the texel size of the shading rate attachment. Replaced
+    // buffers go to `deferred`, or are destroyed at once when it is null (nothing in flight).
+    void init(VkContext &ctx, DeletionQueue *deferred, uint32_t slots, VkExtent2D tile);
+    void shutdown(VkDevice device);
+
+    // (Re)creates the buffers for a framebuffer of `extent`; returns true when re-created.
+    bool ensure(VkExtent2D extent, uint64_t retire_value);
+
+    // Clears the slot's statistics and makes the previous frame's visible to this frame's
+    // fragment shaders; record before the render graph. `frame` is the frame's timeline value:
+    // when the previous frame did not collect statistics, its slot is cleared as well, which the
+    // rate shader reads as "no data, full rate".
+    void begin_frame(VkCommandBuffer cmd, uint32_t slot, uint64_t frame);
+
+    VkBuffer buffer(uint32_t slot) const { return slots_[slot].buffer; }
+    VkDeviceSize buffer_size() const { return size_; }
+    VkExtent2D tile() const { return tile_; }
+    // Shading rate image size: the framebuffer in tiles, rounded up.
+    VkExtent2D tiles() const { return tiles_; }
+    // Incremented whenever the buffers are re-created, so cached descriptors can be refreshed.
+    uint64_t generation() const { return generation_; }
+
+private:
+    struct Slot {
+        VkBuffer buffer{};
+        VkDeviceMemory memory{};
+    };
+
+    static void destroy(VkDevice device, const std::vector<Slot> &slots);
+
+    VkContext *ctx_ = nullptr;
+    DeletionQueue *deferred_ = nullptr;
+    std::vector<Slot> slots_;
+    VkExtent2D tile_{};
+    VkExtent2D extent_{};
+    VkExtent2D tiles_{};
+    VkDeviceSize size_ = 0;
+    uint64_t generation_ = 0;
+    uint64_t last_frame_ = 0; // frame of the last begin_frame()
+};
@@ -8,8 +8,11 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "gfx/deletion_queue.hpp"
+#include "gfx/frame_resources.hpp"
 #include "gfx/vk_context.hpp"
 #include "util/checks.hpp"
 
@@ -41,7 +44,7 @@ static VkExtent2D choose_extent(const VkSurfaceCapabilitiesKHR &caps, uint32_t w
     return e;
 }
 
-void Swapchain::create(VkContext &ctx, uint32_t w, uint32_t h) {
+void Swapchain::create(VkContext &ctx, uint32_t w, uint32_t h, VkSwapchainKHR old_swapchain) {
     VkSurfaceCapabilitiesKHR caps{};
     vk_check(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(ctx.phys(), ctx.surface(), &caps),
              "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
@@ -82,6 +85,7 @@ void Swapchain::create(VkContext &ctx, uint32_t w, uint32_t h) {
     ci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     ci.presentMode = chosen_pm;
     ci.clipped = VK_TRUE;
+    ci.oldSwapchain = old_swapchain;
 
     uint32_t qfs[] = {ctx.graphics_qf(), ctx.present_qf()};
     if (ctx.graphics_qf() != ctx.present_qf()) {
@@ -111,13 +115,9 @@ void Swapchain::create(VkContext &ctx, uint32_t w, uint32_t h) {
         vci.subresourceRange.layerCount = 1;
         vk_check(vkCreateImageView(ctx.device(), &vci, nullptr, &views_[i]), "vkCreateImageView");
     }
-
-    create_render_pass(ctx.device());
 }
 
 void Swapchain::destroy(VkDevice device) {
-    destroy_render_pass(device);
-
     for (auto v : views_) {
         vkDestroyImageView(device, v, nullptr);
     }
@@ -129,58 +129,104 @@ void Swapchain::destroy(VkDevice device) {
     swapchain_ = VK_NULL_HANDLE;
 }
 
-void Swapchain::init(VkContext &ctx, uint32_t w, uint32_t h) { create(ctx, w, h); }
+void Swapchain::init(VkContext &ctx, uint32_t w, uint32_t h) {
+    device_ = ctx.device();
+    present_fences_ = ctx.present_fences_supported();
+    create(ctx, w, h, VK_NULL_HANDLE);
+}
 
-void Swapchain::shutdown(VkDevice device) { destroy(device); }
+void Swapchain::shutdown(VkDevice device) {
+    for (const Retired &r : retired_) {
+        for (auto v : r.views) {
+            vkDestroyImageView(device, v, nullptr);
+        }
+        vkDestroySwapchainKHR(device, r.swapchain, nullptr);
+    }
+    retired_.clear();
+    for (const Present &p : presents_) {
+        vkDestroyFence(device, p.fence, nullptr);
+    }
+    presents_.clear();
+    for (VkFence f : free_fences_) {
+        vkDestroyFence(device, f, nullptr);
+    }
+    free_fences_.clear();
 
-void Swapchain::recreate(VkContext &ctx, uint32_t w, uint32_t h) {
-    destroy(ctx.device());
-    create(ctx, w, h);
+    destroy(device);
 }
 
-void Swapchain::create_render_pass(VkDevice device) {
-    VkAttachmentDescription color{};
-    color.format = format_;
-    color.samples = VK_SAMPLE_COUNT_1_BIT;
-    color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference color_ref{};
-    color_ref.attachment = 0;
-    color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &color_ref;
-
-    // Basic dependency for layout transition / sync
-    VkSubpassDependency dep{};
-    dep.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dep.dstSubpass = 0;
-    dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep.srcAccessMask = 0;
-    dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo rpci{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
-    rpci.attachmentCount = 1;
-    rpci.pAttachments = &color;
-    rpci.subpassCount = 1;
-    rpci.pSubpasses = &subpass;
-    rpci.dependencyCount = 1;
-    rpci.pDependencies = &dep;
-
-    vk_check(vkCreateRenderPass(device, &rpci, nullptr, &render_pass_), "vkCreateRenderPass");
+void Swapchain::recreate(VkContext &ctx, uint32_t w, uint32_t h, DeletionQueue &deferred, uint64_t last_submitted) {
+    const VkSwapchainKHR old = swapchain_;
+    std::vector<VkImageView> old_views = std::move(views_);
+    views_.clear();
+    images_.clear();
+    swapchain_ = VK_NULL_HANDLE;
+
+    create(ctx, w, h, old);
+
+    if (present_fences_) {
+        retired_.push_back({old, std::move(old_views), last_submitted});
+        return;
+    }
+
+    // Every frame after last_submitted presents to the new swapchain. Once kMaxFrames of them
+    // have completed, the presentation engine has images of the new swapchain to show and has
+    // released the old ones.
+    VkDevice device = ctx.device();
+    deferred.push(last_submitted + FrameRing::kMaxFrames, [device, old, old_views] {
+        for (auto v : old_views) {
+            vkDestroyImageView(device, v, nullptr);
+        }
+        vkDestroySwapchainKHR(device, old, nullptr);
+    });
+}
+
+VkFence Swapchain::present_fence() {
+    if (!present_fences_) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkFence fence{};
+    if (!free_fences_.empty()) {
+        fence = free_fences_.back();
+        free_fences_.pop_back();
+        vk_check(vkResetFences(device_, 1, &fence), "vkResetFences(present)");
+    } else {
+        VkFenceCreateInfo fci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        vk_check(vkCreateFence(device_, &fci, nullptr, &fence), "vkCreateFence(present)");
+    }
+    presents_.push_back({fence, swapchain_});
+    return fence;
 }
 
-void Swapchain::destroy_render_pass(VkDevice device) {
-    if (render_pass_ != VK_NULL_HANDLE) {
-        vkDestroyRenderPass(device, render_pass_, nullptr);
-        render_pass_ = VK_NULL_HANDLE;
+void Swapchain::collect(uint64_t completed_value) {
+    for (auto it = presents_.begin(); it != presents_.end();) {
+        const VkResult r = vkGetFenceStatus(device_, it->fence);
+        if (r == VK_NOT_READY) {
+            ++it;
+            continue;
+        }
+        vk_check(r, "vkGetFenceStatus(present)");
+        free_fences_.push_back(it->fence);
+        it = presents_.erase(it);
+    }
+
+    auto in_use = [&](const Retired &r) {
+        if (r.retire_value > completed_value) {
+            return true;
+        }
+        return std::any_of(
+            presents_.begin(), presents_.end(), [&](const Present &p) { return p.swapchain == r.swapchain; });
+    };
+    for (auto it = retired_.begin(); it != retired_.end();) {
+        if (in_use(*it)) {
+            ++it;
+            continue;
+        }
+        for (auto v : it->views) {
+            vkDestroyImageView(device_, v, nullptr);
+        }
+        vkDestroySwapchainKHR(device_, it->swapchain, nullptr);
+        it = retired_.erase(it);
     }
 }
@@ -8,31 +8,63 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <vector>
 
 class VkContext;
+class DeletionQueue;
 
 class Swapchain {
 public:
     void init(VkContext &ctx, uint32_t w, uint32_t h);
+    // The device must be idle.
     void shutdown(VkDevice device);
-    void recreate(VkContext &ctx, uint32_t w, uint32_t h);
+
+    // Creates the new swapchain from the old one and defers destroying the old one, so no
+    // device-wide wait is needed. Frames up to last_submitted may still render into the old
+    // images, and the presentation engine may still read the ones they presented:
+    //  - with present fences, the old swapchain is destroyed once those frames have completed
+    //    and every present to it has signalled its fence;
+    //  - otherwise presentation is not observable, so it is destroyed only after
+    //    FrameRing::kMaxFrames more frames, presented on the new swapchain, have completed.
+    void recreate(VkContext &ctx, uint32_t w, uint32_t h, DeletionQueue &deferred, uint64_t last_submitted);
+
+    // Fence to chain into the next vkQueuePresentKHR of handle() with
+    // VkSwapchainPresentFenceInfoEXT; VK_NULL_HANDLE without present fences.
+    VkFence present_fence();
+
+    // Recycles signalled present fences and destroys replaced swapchains that are no longer in
+    // use. Call once per frame with the completed frame timeline value.
+    void collect(uint64_t completed_value);
 
     VkSwapchainKHR handle() const { return swapchain_; }
     VkFormat format() const { return format_; }
     VkExtent2D extent() const { return extent_; }
 
     uint32_t image_count() const { return static_cast<uint32_t>(images_.size()); }
-    VkRenderPass render_pass() const { return render_pass_; }
-
+    const std::vector<VkImage> &images() const { return images_; }
     const std::vector<VkImageView> &image_views() const { return views_; }
 
 private:
-    void create(VkContext &ctx, uint32_t w, uint32_t h);
+    struct Present {
+        VkFence fence;
+        VkSwapchainKHR swapchain;
+    };
+
+    struct Retired {
+        VkSwapchainKHR swapchain;
+        std::vector<VkImageView> views;
+        uint64_t retire_value; // frame timeline value after which no frame renders into it
+    };
+
+    void create(VkContext &ctx, uint32_t w, uint32_t h, VkSwapchainKHR old_swapchain);
     void destroy(VkDevice device);
 
-    void create_render_pass(VkDevice device);
-    void destroy_render_pass(VkDevice device);
+    VkDevice device_{};
+    bool present_fences_ = false;
+    std::vector<Present> presents_; // fenced presents in flight
+    std::vector<VkFence> free_fences_;
+    std::vector<Retired> retired_; // present fences only; otherwise in the DeletionQueue
 
     VkSwapchainKHR swapchain_{};
 
@@ -40,6 +72,4 @@ private:
     VkExtent2D extent_{};
     std::vector<VkImage> images_;
     std::vector<VkImageView> views_;
-
-    VkRenderPass render_pass_{VK_NULL_HANDLE};
 };
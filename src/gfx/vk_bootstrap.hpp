@@ -11,5 +11,6 @@
 struct QueueFamilyIndices {
     uint32_t graphics = UINT32_MAX;
     uint32_t present = UINT32_MAX;
+    uint32_t compute = UINT32_MAX; // dedicated compute family, or graphics when there is none
     bool complete() const { return graphics != UINT32_MAX && present != UINT32_MAX; }
 };
@@ -4,13 +4,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cstring>
+#include <filesystem>
 #include <format>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "gfx/vk_context.hpp"
 #include "util/checks.hpp"
+#include "util/read_file.hpp"
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL dbg_cb(VkDebugUtilsMessageSeverityFlagBitsEXT,
                                              VkDebugUtilsMessageTypeFlagsEXT,
@@ -48,6 +53,11 @@ static void destroy_debug(VkInstance inst) {
     g_dbg_messenger = VK_NULL_HANDLE;
 }
 
+// File name prefix of the pipeline caches of one device; the bundle hash follows it.
+static std::string pipeline_cache_prefix(const VkPhysicalDeviceProperties &props) {
+    return std::format("pipelines-{:08x}-{:08x}-", props.vendorID, props.deviceID);
+}
+
 QueueFamilyIndices VkContext::find_queue_families(VkPhysicalDevice dev) {
     QueueFamilyIndices out{};
     uint32_t count = 0;
@@ -60,9 +70,14 @@ QueueFamilyIndices VkContext::find_queue_families(VkPhysicalDevice dev) {
             out.graphics = i;
         }
 
+        // Headless: nothing is presented, the graphics family stands in.
         VkBool32 present = VK_FALSE;
-        vk_check(vkGetPhysicalDeviceSurfaceSupportKHR(dev, i, surface_, &present),
-                 "vkGetPhysicalDeviceSurfaceSupportKHR");
+        if (surface_) {
+            vk_check(vkGetPhysicalDeviceSurfaceSupportKHR(dev, i, surface_, &present),
+                     "vkGetPhysicalDeviceSurfaceSupportKHR");
+        } else {
+            present = (props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+        }
         if (present) {
             out.present = i;
         }
@@ -71,12 +86,235 @@ QueueFamilyIndices VkContext::find_queue_families(VkPhysicalDevice dev) {
             break;
         }
     }
+
+    // Background compute prefers a family without graphics so it runs on a separate hardware
+    // queue; otherwise it shares the graphics family.
+    out.compute = out.graphics;
+    for (uint32_t i = 0; i < count; i++) {
+        if ((props[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+            out.compute = i;
+            break;
+        }
+    }
     return out;
 }
 
 bool VkContext::is_device_suitable(VkPhysicalDevice dev) {
     auto q = find_queue_families(dev);
-    return q.complete();
+    if (!q.complete()) {
+        return false;
+    }
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(dev, &props);
+    if (props.apiVersion < VK_API_VERSION_1_3) {
+        return false;
+    }
+
+    // The render graph records dynamic rendering and synchronization2 barriers; async compute
+    // synchronizes with timeline semaphores.
+    VkPhysicalDeviceVulkan12Features f12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    VkPhysicalDeviceVulkan13Features f13{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+    f13.pNext = &f12;
+    VkPhysicalDeviceFeatures2 f2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+    f2.pNext = &f13;
+    vkGetPhysicalDeviceFeatures2(dev, &f2);
+    // The cost statistics debug mode accumulates counters from the fragment shader.
+    return f13.dynamicRendering && f13.synchronization2 && f12.timelineSemaphore &&
+           f2.features.fragmentStoresAndAtomics;
+}
+
+void VkContext::query_shading_rate() {
+    shading_rate_texel_ = {};
+
+    uint32_t count = 0;
+    vk_check(vkEnumerateDeviceExtensionProperties(phys_, nullptr, &count, nullptr),
+             "vkEnumerateDeviceExtensionProperties(count)");
+    std::vector<VkExtensionProperties> exts(count);
+    vk_check(vkEnumerateDeviceExtensionProperties(phys_, nullptr, &count, exts.data()),
+             "vkEnumerateDeviceExtensionProperties(list)");
+    bool found = false;
+    for (const VkExtensionProperties &e : exts) {
+        found = found || std::strcmp(e.extensionName, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME) == 0;
+    }
+    if (!found) {
+        return;
+    }
+
+    VkPhysicalDeviceFragmentShadingRateFeaturesKHR fsr{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR};
+    VkPhysicalDeviceFeatures2 f2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+    f2.pNext = &fsr;
+    vkGetPhysicalDeviceFeatures2(phys_, &f2);
+    if (!fsr.pipelineFragmentShadingRate || !fsr.attachmentFragmentShadingRate) {
+        return;
+    }
+
+    VkPhysicalDeviceFragmentShadingRatePropertiesKHR props{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR};
+    VkPhysicalDeviceProperties2 p2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    p2.pNext = &props;
+    vkGetPhysicalDeviceProperties2(phys_, &p2);
+    shading_rate_texel_ = props.minFragmentShadingRateAttachmentTexelSize;
+}
+
+bool VkContext::query_swapchain_maintenance1() const {
+    if (!surface_ || !surface_maintenance1_) {
+        return false;
+    }
+
+    uint32_t count = 0;
+    vk_check(vkEnumerateDeviceExtensionProperties(phys_, nullptr, &count, nullptr),
+             "vkEnumerateDeviceExtensionProperties(count)");
+    std::vector<VkExtensionProperties> exts(count);
+    vk_check(vkEnumerateDeviceExtensionProperties(phys_, nullptr, &count, exts.data()),
+             "vkEnumerateDeviceExtensionProperties(list)");
+    bool found = false;
+    for (const VkExtensionProperties &e : exts) {
+        found = found || std::strcmp(e.extensionName, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) == 0;
+    }
+    if (!found) {
+        return false;
+    }
+
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT sm1{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT};
+    VkPhysicalDeviceFeatures2 f2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+    f2.pNext = &sm1;
+    vkGetPhysicalDeviceFeatures2(phys_, &f2);
+    return sm1.swapchainMaintenance1 == VK_TRUE;
+}
+
+void VkContext::create_buffer(VkDeviceSize size,
+                              VkBufferUsageFlags usage,
+                              VkMemoryPropertyFlags mem_flags,
+                              VkBuffer &buf,
+                              VkDeviceMemory &mem,
+                              bool share_with_compute) const {
+    const uint32_t families[2] = {qf_.graphics, qf_.compute};
+
+    VkBufferCreateInfo bci{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bci.size = size;
+    bci.usage = usage;
+    bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (share_with_compute && qf_.compute != qf_.graphics) {
+        bci.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bci.queueFamilyIndexCount = 2;
+        bci.pQueueFamilyIndices = families;
+    }
+    vk_check(vkCreateBuffer(device_, &bci, nullptr, &buf), "vkCreateBuffer");
+
+    VkMemoryRequirements req{};
+    vkGetBufferMemoryRequirements(device_, buf, &req);
+
+    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mai.allocationSize = req.size;
+    mai.memoryTypeIndex = find_memory_type(req.memoryTypeBits, mem_flags);
+
+    vk_check(vkAllocateMemory(device_, &mai, nullptr, &mem), "vkAllocateMemory");
+    vk_check(vkBindBufferMemory(device_, buf, mem, 0), "vkBindBufferMemory");
+}
+
+void VkContext::init_shaders(const std::string &bundle_path) {
+    shaders_.open(bundle_path);
+
+    // Cache data is only valid for the shaders and the device (and driver) it was created with.
+    // The file name covers both, so devices sharing the cache directory keep their own files;
+    // the header check still rejects data from another driver version.
+    std::vector<uint8_t> data;
+    if (const std::string dir = user_cache_dir(); !dir.empty()) {
+        std::string uuid;
+        for (uint8_t b : props_.pipelineCacheUUID) {
+            uuid += std::format("{:02x}", b);
+        }
+        pipeline_cache_path_ =
+            std::format("{}/{}{}-{:016x}.bin", dir, pipeline_cache_prefix(props_), uuid, shaders_.hash());
+        if (std::filesystem::exists(pipeline_cache_path_)) {
+            data = read_file_binary(pipeline_cache_path_);
+        }
+    }
+    VkPipelineCacheHeaderVersionOne hdr{};
+    if (data.size() >= sizeof(hdr)) {
+        std::memcpy(&hdr, data.data(), sizeof(hdr));
+    }
+    if (hdr.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || hdr.vendorID != props_.vendorID ||
+        hdr.deviceID != props_.deviceID ||
+        std::memcmp(hdr.pipelineCacheUUID, props_.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo pcci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    pcci.initialDataSize = data.size();
+    pcci.pInitialData = data.empty() ? nullptr : data.data();
+    vk_check(vkCreatePipelineCache(device_, &pcci, nullptr, &pipeline_cache_), "vkCreatePipelineCache");
+
+    std::cout << std::format("Shaders: {} in {} ({} KiB), pipeline cache {}\n",
+                             shaders_.count(),
+                             bundle_path,
+                             shaders_.size_bytes() / 1024,
+                             data.empty() ? std::string("empty") : std::format("{} KiB", data.size() / 1024));
+}
+
+void VkContext::save_pipeline_cache() {
+    if (!pipeline_cache_ || pipeline_cache_path_.empty()) {
+        return;
+    }
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, pipeline_cache_, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return;
+    }
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device_, pipeline_cache_, &size, data.data()) != VK_SUCCESS) {
+        return;
+    }
+
+    // A failed save only costs the next startup its cache; it is not an error.
+    const std::filesystem::path path = pipeline_cache_path_;
+    const std::filesystem::path tmp = pipeline_cache_path_ + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(size));
+        if (!f) {
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+
+    // This device's caches of earlier shader builds or drivers can never be hit again. Other
+    // devices' caches are left alone.
+    const std::string prefix = pipeline_cache_prefix(props_);
+    std::filesystem::directory_iterator it(path.parent_path(), ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        if (it->path() != path && name.starts_with(prefix) && name.ends_with(".bin")) {
+            std::error_code rm_ec;
+            std::filesystem::remove(it->path(), rm_ec);
+        }
+    }
+}
+
+VkShaderModule VkContext::load_shader(std::string_view name) const {
+    const ShaderBundle::Blob blob = shaders_.find(name);
+
+    VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    ci.codeSize = blob.size;
+    ci.pCode = blob.code;
+
+    VkShaderModule mod{};
+    vk_check(vkCreateShaderModule(device_, &ci, nullptr, &mod), "vkCreateShaderModule");
+    return mod;
+}
+
+uint32_t VkContext::find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags flags) const {
+    VkPhysicalDeviceMemoryProperties mp{};
+    vkGetPhysicalDeviceMemoryProperties(phys_, &mp);
+    for (uint32_t i = 0; i < mp.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) && (mp.memoryTypes[i].propertyFlags & flags) == flags) {
+            return i;
+        }
+    }
+    throw std::runtime_error("No suitable memory type");
 }
 
 void VkContext::init(GLFWwindow *window) {
@@ -88,10 +326,32 @@ void VkContext::init(GLFWwindow *window) {
     app.engineVersion = VK_MAKE_VERSION(0, 1, 0);
     app.apiVersion = VK_API_VERSION_1_3;
 
-    uint32_t glfw_ext_count = 0;
-    const char **glfw_exts = glfwGetRequiredInstanceExtensions(&glfw_ext_count);
-
-    std::vector<const char *> exts(glfw_exts, glfw_exts + glfw_ext_count);
+    std::vector<const char *> exts;
+    if (window) {
+        uint32_t glfw_ext_count = 0;
+        const char **glfw_exts = glfwGetRequiredInstanceExtensions(&glfw_ext_count);
+        exts.assign(glfw_exts, glfw_exts + glfw_ext_count);
+
+        // Optional: VK_EXT_swapchain_maintenance1 (present fences) depends on these.
+        uint32_t count = 0;
+        vk_check(vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr),
+                 "vkEnumerateInstanceExtensionProperties(count)");
+        std::vector<VkExtensionProperties> available(count);
+        vk_check(vkEnumerateInstanceExtensionProperties(nullptr, &count, available.data()),
+                 "vkEnumerateInstanceExtensionProperties(list)");
+        bool caps2 = false;
+        bool surface_maintenance1 = false;
+        for (const VkExtensionProperties &e : available) {
+            caps2 = caps2 || std::strcmp(e.extensionName, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) == 0;
+            surface_maintenance1 =
+                surface_maintenance1 || std::strcmp(e.extensionName, VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) == 0;
+        }
+        surface_maintenance1_ = caps2 && surface_maintenance1;
+        if (surface_maintenance1_) {
+            exts.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+            exts.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+        }
+    }
     exts.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
     std::vector<const char *> layers;
@@ -111,8 +371,10 @@ void VkContext::init(GLFWwindow *window) {
     create_debug(instance_);
 #endif
 
-    // Surface
-    vk_check(glfwCreateWindowSurface(instance_, window, nullptr, &surface_), "glfwCreateWindowSurface");
+    // Surface (none when headless)
+    if (window) {
+        vk_check(glfwCreateWindowSurface(instance_, window, nullptr, &surface_), "glfwCreateWindowSurface");
+    }
 
     // Pick physical device
     uint32_t dev_count = 0;
@@ -136,6 +398,8 @@ void VkContext::init(GLFWwindow *window) {
 
     vkGetPhysicalDeviceProperties(phys_, &props_);
     qf_ = find_queue_families(phys_);
+    query_shading_rate();
+    swapchain_maintenance1_ = query_swapchain_maintenance1();
 
     // Logical device
     float prio = 1.0f;
@@ -153,12 +417,49 @@ void VkContext::init(GLFWwindow *window) {
     if (qf_.present != qf_.graphics) {
         qcis.push_back(make_qci(qf_.present));
     }
+    if (qf_.compute != qf_.graphics && qf_.compute != qf_.present) {
+        qcis.push_back(make_qci(qf_.compute));
+    }
 
-    std::vector<const char *> dev_exts = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    std::vector<const char *> dev_exts;
+    if (surface_) {
+        dev_exts.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     VkPhysicalDeviceFeatures feats{}; // keep minimal
+    feats.fragmentStoresAndAtomics = VK_TRUE;
+
+    VkPhysicalDeviceVulkan13Features feats13{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+    feats13.dynamicRendering = VK_TRUE;
+    feats13.synchronization2 = VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features feats12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    feats12.timelineSemaphore = VK_TRUE;
+    feats13.pNext = &feats12;
+
+    // Optional: variable-rate shading of the fractal pass from a shading rate image.
+    VkPhysicalDeviceFragmentShadingRateFeaturesKHR fsr{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR};
+    if (shading_rate_supported()) {
+        dev_exts.push_back(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+        fsr.pipelineFragmentShadingRate = VK_TRUE;
+        fsr.attachmentFragmentShadingRate = VK_TRUE;
+        feats12.pNext = &fsr;
+    }
+
+    // Optional: present fences, so a replaced swapchain is destroyed exactly when its last
+    // present has completed.
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT sm1{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT};
+    if (swapchain_maintenance1_) {
+        dev_exts.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+        sm1.swapchainMaintenance1 = VK_TRUE;
+        sm1.pNext = feats13.pNext;
+        feats13.pNext = &sm1;
+    }
 
     VkDeviceCreateInfo dci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+    dci.pNext = &feats13;
     dci.queueCreateInfoCount = static_cast<uint32_t>(qcis.size());
     dci.pQueueCreateInfos = qcis.data();
     dci.enabledExtensionCount = static_cast<uint32_t>(dev_exts.size());
@@ -169,6 +470,7 @@ void VkContext::init(GLFWwindow *window) {
 
     vkGetDeviceQueue(device_, qf_.graphics, 0, &graphics_queue_);
     vkGetDeviceQueue(device_, qf_.present, 0, &present_queue_);
+    vkGetDeviceQueue(device_, qf_.compute, 0, &compute_queue_);
 
     // Command pool (graphics)
     VkCommandPoolCreateInfo cpci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
@@ -177,21 +479,26 @@ void VkContext::init(GLFWwindow *window) {
     vk_check(vkCreateCommandPool(device_, &cpci, nullptr, &cmd_pool_), "vkCreateCommandPool");
 }
 
-void VkContext::init_imgui(GLFWwindow *window, VkRenderPass render_pass, uint32_t swapchain_image_count) {
+void VkContext::init_imgui(GLFWwindow *window, VkFormat color_format, uint32_t swapchain_image_count) {
     imgui_.init(window,
                 instance_,
                 phys_,
                 device_,
                 qf_.graphics,
                 graphics_queue_,
-                render_pass,
+                color_format,
                 swapchain_image_count,
-                cmd_pool_);
+                cmd_pool_,
+                pipeline_cache_);
 }
 
 void VkContext::shutdown() {
     if (device_) {
         vkDeviceWaitIdle(device_);
+        if (pipeline_cache_) {
+            save_pipeline_cache();
+            vkDestroyPipelineCache(device_, pipeline_cache_, nullptr);
+        }
         if (cmd_pool_) {
             vkDestroyCommandPool(device_, cmd_pool_, nullptr);
         }
@@ -209,6 +516,10 @@ void VkContext::shutdown() {
         vkDestroyInstance(instance_, nullptr);
     }
 
+    shaders_.close();
+
+    pipeline_cache_ = VK_NULL_HANDLE;
+    pipeline_cache_path_.clear();
     cmd_pool_ = VK_NULL_HANDLE;
     device_ = VK_NULL_HANDLE;
     surface_ = VK_NULL_HANDLE;
@@ -10,18 +10,24 @@
 
 #include <GLFW/glfw3.h>
 
+#include <string>
+#include <string_view>
+
 #include "gfx/imgui_layer.hpp"
 #include "gfx/vk_bootstrap.hpp"
+#include "util/shader_bundle.hpp"
 
 class VkContext {
 public:
+    // window == nullptr creates a headless context: no surface, no swapchain extension.
     void init(GLFWwindow *window);
     void shutdown();
-    void init_imgui(GLFWwindow *window, VkRenderPass render_pass, uint32_t swapchain_image_count);
+    void init_imgui(GLFWwindow *window, VkFormat color_format, uint32_t swapchain_image_count);
     void shutdown_imgui();
 
     void imgui_new_frame() { imgui_.new_frame(); }
-    void imgui_render(VkCommandBuffer cmd) { imgui_.render(cmd); }
+    void imgui_end_frame() { imgui_.end_frame(); }
+    void imgui_record(VkCommandBuffer cmd) { imgui_.record(cmd); }
 
     VkInstance instance() const { return instance_; }
     VkPhysicalDevice phys() const { return phys_; }
@@ -33,13 +39,50 @@ public:
     uint32_t graphics_qf() const { return qf_.graphics; }
     uint32_t present_qf() const { return qf_.present; }
 
+    // Same queue as graphics_queue() when the device has no separate compute family.
+    VkQueue compute_queue() const { return compute_queue_; }
+    uint32_t compute_qf() const { return qf_.compute; }
+
     VkCommandPool command_pool() const { return cmd_pool_; }
 
     VkPhysicalDeviceProperties properties() const { return props_; }
 
+    // VK_KHR_fragment_shading_rate with pipeline and attachment rates; enabled when available.
+    bool shading_rate_supported() const { return shading_rate_texel_.width != 0; }
+    // Screen pixels covered by one texel of a shading rate attachment; {0, 0} when unsupported.
+    VkExtent2D shading_rate_texel_size() const { return shading_rate_texel_; }
+
+    // VK_EXT_swapchain_maintenance1: presents can signal a fence once the presentation engine is
+    // done with their resources (VkSwapchainPresentFenceInfoEXT). Enabled when available.
+    bool present_fences_supported() const { return swapchain_maintenance1_; }
+
+    uint32_t find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags flags) const;
+    // With share_with_compute, a separate compute family may use the buffer without ownership
+    // transfers (VK_SHARING_MODE_CONCURRENT).
+    void create_buffer(VkDeviceSize size,
+                       VkBufferUsageFlags usage,
+                       VkMemoryPropertyFlags mem_flags,
+                       VkBuffer &buf,
+                       VkDeviceMemory &mem,
+                       bool share_with_compute = false) const;
+
+    // Maps the shader bundle and creates the pipeline cache. The cache is keyed by the device
+    // (vendor, device and pipeline cache UUID) and the bundle's content hash: it is loaded from
+    // the user cache directory when one was saved for the same shaders and device, and saved
+    // back on shutdown().
+    void init_shaders(const std::string &bundle_path);
+    // Shader module from a SPIR-V file in the bundle, e.g. "fullscreen.vert.spv"; the code is
+    // passed to the driver straight from the mapping. The caller destroys the module.
+    VkShaderModule load_shader(std::string_view name) const;
+    VkPipelineCache pipeline_cache() const { return pipeline_cache_; }
+    const ShaderBundle &shaders() const { return shaders_; }
+
 private:
     QueueFamilyIndices find_queue_families(VkPhysicalDevice dev);
     bool is_device_suitable(VkPhysicalDevice dev);
+    void query_shading_rate();
+    bool query_swapchain_maintenance1() const;
+    void save_pipeline_cache();
 
     VkInstance instance_{};
     VkPhysicalDevice phys_{};
@@ -48,11 +91,19 @@ private:
 
     VkQueue graphics_queue_{};
     VkQueue present_queue_{};
+    VkQueue compute_queue_{};
     QueueFamilyIndices qf_{};
 
     VkCommandPool cmd_pool_{};
 
     VkPhysicalDeviceProperties props_{};
+    VkExtent2D shading_rate_texel_{};
+    bool surface_maintenance1_ = false; // instance extensions VK_EXT_swapchain_maintenance1 needs
+    bool swapchain_maintenance1_ = false;
+
+    ShaderBundle shaders_;
+    VkPipelineCache pipeline_cache_{};
+    std::string pipeline_cache_path_; // empty: not persisted
 
     ImGuiLayer imgui_;
 };
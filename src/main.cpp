@@ -5,12 +5,59 @@
  */
 
 #include <iostream>
+#include <string>
 
 #include "app/app.hpp"
+#include "app/golden.hpp"
 
-int main() {
+namespace {
+
+void usage() {
+    std::cerr << "Usage: vk_fractal [--play FILE [--play-fps N]]\n"
+                 "       vk_fractal --golden DIR [--update] [--max-slowdown PCT] [--normals] [--stats] [--stereo]\n"
+                 "                               [--baseline FILE]\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
     try {
+        GoldenOptions golden;
+        std::string play_path;
+        int play_fps = 60;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg == "--golden" && i + 1 < argc) {
+                golden.dir = argv[++i];
+            } else if (arg == "--update") {
+                golden.update = true;
+            } else if (arg == "--max-slowdown" && i + 1 < argc) {
+                golden.max_slowdown_pct = std::stof(argv[++i]);
+            } else if (arg == "--normals") {
+                golden.compare_normals = true;
+            } else if (arg == "--stats") {
+                golden.stats = true;
+            } else if (arg == "--stereo") {
+                golden.compare_stereo = true;
+            } else if (arg == "--baseline" && i + 1 < argc) {
+                golden.baseline = argv[++i];
+            } else if (arg == "--play" && i + 1 < argc) {
+                play_path = argv[++i];
+            } else if (arg == "--play-fps" && i + 1 < argc) {
+                play_fps = std::stoi(argv[++i]);
+            } else {
+                usage();
+                return 2;
+            }
+        }
+        if (!golden.dir.empty()) {
+            return run_golden(golden);
+        }
+
         App app;
+        if (!play_path.empty()) {
+            app.play_on_start(play_path, play_fps);
+        }
         app.run();
         return 0;
     } catch (const std::exception &e) {
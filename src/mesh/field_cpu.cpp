@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mesh/field_cpu.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float sdf_sphere(glm::vec3 p, float r) { return glm::length(p) - r; }
+
+float sdf_box(glm::vec3 p, glm::vec3 b) {
+    const glm::vec3 q = glm::abs(p) - b;
+    return glm::length(glm::max(q, 0.0f)) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f);
+}
+
+// Shared power-N triplex iteration of the Mandelbulb and Julia fields; only the additive
+// constant differs (p for the Mandelbulb, c for Julia).
+float triplex_de(glm::vec3 z, glm::vec3 add, int iterations, float power, float bailout) {
+    float dr = 1.0f;
+    float r = 0.0f;
+
+    for (int i = 0; i < iterations; ++i) {
+        r = glm::length(z);
+        if (r > bailout) {
+            break;
+        }
+
+        const float r_safe = std::max(r, 1e-8f);
+
+        const float theta = std::acos(std::clamp(z.z / r_safe, -1.0f, 1.0f));
+        const float phi = std::atan2(z.y, z.x);
+
+        const float rp1 = std::pow(r_safe, power - 1.0f);
+        const float zr = rp1 * r_safe;
+
+        dr = rp1 * power * dr + 1.0f;
+
+        const float theta_p = theta * power;
+        const float phi_p = phi * power;
+
+        z = zr * glm::vec3(std::sin(theta_p) * std::cos(phi_p), std::sin(theta_p) * std::sin(phi_p), std::cos(theta_p)) +
+            add;
+    }
+
+    const float r_safe = std::max(r, 1e-6f);
+    const float dr_safe = std::max(std::abs(dr), 1e-6f);
+
+    return 0.5f * std::log(r_safe) * r_safe / dr_safe;
+}
+
+} // namespace
+
+float field_mandelbulb(glm::vec3 p, int iterations, float power, float bailout) {
+    return triplex_de(p, p, iterations, power, bailout);
+}
+
+float field_julia(glm::vec3 p, glm::vec3 c, int iterations, float power, float bailout) {
+    return triplex_de(p, c, iterations, power, bailout);
+}
+
+float field_mandelbox(glm::vec3 p, int iterations, float bailout) {
+    constexpr float global_scale = 1.0f / 6.0f;
+    constexpr float scale = 2.0f;
+    constexpr float fold_limit = 1.0f;
+    constexpr float min_r2 = 0.5f * 0.5f;
+    constexpr float fix_r2 = 1.0f * 1.0f;
+
+    p /= global_scale;
+
+    glm::vec3 z = p;
+    float dr = 1.0f;
+
+    for (int i = 0; i < iterations; ++i) {
+        z = glm::clamp(z, -fold_limit, fold_limit) * 2.0f - z;
+
+        const float r2 = glm::dot(z, z);
+        if (r2 < min_r2) {
+            const float t = fix_r2 / min_r2;
+            z *= t;
+            dr *= t;
+        } else if (r2 < fix_r2) {
+            const float t = fix_r2 / r2;
+            z *= t;
+            dr *= t;
+        }
+
+        z = z * scale + p;
+        dr = dr * std::abs(scale) + 1.0f;
+
+        if (glm::dot(z, z) > bailout * bailout) {
+            break;
+        }
+    }
+
+    return glm::length(z) / std::abs(dr) * global_scale;
+}
+
+float field_distance(const FieldParams &fp, glm::vec3 p) {
+    const int iters = std::max(fp.iterations, 1);
+    const float bailout = std::max(fp.bailout, 2.0f);
+    const float power = std::max(fp.power, 2.0f);
+
+    switch (fp.field_id) {
+    case 0:
+        return sdf_sphere(p, 1.0f);
+    case 1:
+        return sdf_box(p, glm::vec3(1.0f));
+    case 2:
+        return field_mandelbulb(p, iters, power, bailout);
+    case 3:
+        return field_mandelbox(p, iters, bailout);
+    case 4:
+        return field_julia(p, fp.julia_c, iters, power, bailout);
+    }
+    return 1e9f;
+}
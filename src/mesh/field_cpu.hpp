@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// CPU ports of the distance estimators in shaders/fields/*.glsl. They mirror the GLSL code
+// line by line so meshes extracted on the CPU match what the raymarcher shows.
+
+struct FieldParams {
+    int field_id = 2;
+    int iterations = 12;
+    float bailout = 8.0f;
+    float power = 8.0f;
+    glm::vec3 julia_c{0.3f, 0.5f, -0.2f};
+};
+
+float field_mandelbulb(glm::vec3 p, int iterations, float power, float bailout);
+float field_mandelbox(glm::vec3 p, int iterations, float bailout);
+float field_julia(glm::vec3 p, glm::vec3 c, int iterations, float power, float bailout);
+
+// Same dispatch as the per-field field_eval() generated by cmake/field_registry.cmake.
+float field_distance(const FieldParams &fp, glm::vec3 p);
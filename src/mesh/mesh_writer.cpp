@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mesh/mesh_writer.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Counts in the PLY header are zero-padded to a fixed width so the header can be rewritten in
+// place once the final counts are known.
+constexpr const char *kPlyHeaderFmt = "ply\n"
+                                      "format binary_little_endian 1.0\n"
+                                      "comment vk-fractal dual contouring export\n"
+                                      "element vertex %010llu\n"
+                                      "property float x\n"
+                                      "property float y\n"
+                                      "property float z\n"
+                                      "element face %010llu\n"
+                                      "property list uchar uint vertex_indices\n"
+                                      "end_header\n";
+
+void write_or_throw(std::FILE *f, const void *data, size_t size, const std::string &path) {
+    if (size != 0 && std::fwrite(data, 1, size, f) != size) {
+        throw std::runtime_error("Failed to write mesh file: " + path);
+    }
+}
+
+} // namespace
+
+MeshWriter::~MeshWriter() {
+    if (file_) {
+        std::fclose(file_);
+    }
+    if (faces_) {
+        std::fclose(faces_);
+        std::remove(faces_path_.c_str());
+    }
+}
+
+void MeshWriter::write_ply_header() {
+    char header[512];
+    const int n = std::snprintf(header,
+                                sizeof(header),
+                                kPlyHeaderFmt,
+                                static_cast<unsigned long long>(vertex_count_),   // NOLINT(runtime/int)
+                                static_cast<unsigned long long>(triangle_count_)); // NOLINT(runtime/int)
+    write_or_throw(file_, header, static_cast<size_t>(n), path_);
+}
+
+void MeshWriter::open(const std::string &path, MeshFormat format) {
+    path_ = path;
+    format_ = format;
+    vertex_count_ = 0;
+    triangle_count_ = 0;
+    welded_.clear();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open mesh file: " + path);
+    }
+
+    if (format_ == MeshFormat::Stl) {
+        std::array<char, 80> header{};
+        std::snprintf(header.data(), header.size(), "vk-fractal dual contouring export");
+        const uint32_t count = 0;
+        write_or_throw(file_, header.data(), header.size(), path_);
+        write_or_throw(file_, &count, sizeof(count), path_);
+    } else {
+        write_ply_header();
+
+        faces_path_ = path + ".faces.tmp";
+        faces_ = std::fopen(faces_path_.c_str(), "w+b");
+        if (!faces_) {
+            throw std::runtime_error("Failed to open temporary file: " + faces_path_);
+        }
+    }
+}
+
+void MeshWriter::append(const std::vector<glm::vec3> &vertices,
+                        const std::vector<uint64_t> &weld_keys,
+                        const std::vector<uint32_t> &indices) {
+    if (indices.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const size_t tri_count = indices.size() / 3;
+    constexpr uint64_t kMaxCount = std::numeric_limits<uint32_t>::max();
+
+    if (format_ == MeshFormat::Stl) {
+        if (triangle_count_ + tri_count > kMaxCount) {
+            throw std::runtime_error("Mesh has more triangles than binary STL can count: " + path_);
+        }
+
+        // 50 bytes per triangle: normal, 3 vertices, 16-bit attribute count.
+        std::vector<uint8_t> buf(tri_count * 50);
+        uint8_t *dst = buf.data();
+        for (size_t t = 0; t < tri_count; t++) {
+            const glm::vec3 &a = vertices[indices[3 * t + 0]];
+            const glm::vec3 &b = vertices[indices[3 * t + 1]];
+            const glm::vec3 &c = vertices[indices[3 * t + 2]];
+
+            glm::vec3 n = glm::cross(b - a, c - a);
+            const float len = glm::length(n);
+            n = (len > 0.0f) ? n / len : glm::vec3(0.0f);
+
+            const float rec[12] = {n.x, n.y, n.z, a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z};
+            std::memcpy(dst, rec, sizeof(rec));
+            std::memset(dst + sizeof(rec), 0, 2);
+            dst += 50;
+        }
+        write_or_throw(file_, buf.data(), buf.size(), path_);
+        vertex_count_ += vertices.size();
+    } else {
+        // Map the chunk's vertices onto the global vertex list, writing only the ones whose
+        // weld key has not been seen before.
+        remap_.resize(vertices.size());
+        new_vertices_.clear();
+        for (size_t v = 0; v < vertices.size(); v++) {
+            if (vertex_count_ + new_vertices_.size() > kMaxCount) {
+                throw std::runtime_error("Mesh exceeds the 32-bit vertex indices of the PLY export: " + path_);
+            }
+            const uint32_t next = static_cast<uint32_t>(vertex_count_ + new_vertices_.size());
+            if (weld_keys[v] != kNoWeld) {
+                const auto [it, inserted] = welded_.try_emplace(weld_keys[v], next);
+                if (!inserted) {
+                    remap_[v] = it->second;
+                    continue;
+                }
+            }
+            remap_[v] = next;
+            new_vertices_.push_back(vertices[v]);
+        }
+
+        static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+        write_or_throw(file_, new_vertices_.data(), new_vertices_.size() * sizeof(glm::vec3), path_);
+
+        // 13 bytes per face: uchar count + 3 uint indices into the global vertex list.
+        std::vector<uint8_t> buf(tri_count * 13);
+        uint8_t *dst = buf.data();
+        for (size_t t = 0; t < tri_count; t++) {
+            const uint32_t idx[3] = {
+                remap_[indices[3 * t + 0]], remap_[indices[3 * t + 1]], remap_[indices[3 * t + 2]]};
+            dst[0] = 3;
+            std::memcpy(dst + 1, idx, sizeof(idx));
+            dst += 13;
+        }
+        write_or_throw(faces_, buf.data(), buf.size(), faces_path_);
+        vertex_count_ += new_vertices_.size();
+    }
+
+    triangle_count_ += tri_count;
+}
+
+void MeshWriter::forget_welds_below(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    welded_.erase(welded_.begin(), welded_.lower_bound(key));
+}
+
+void MeshWriter::discard() {
+    if (faces_) {
+        std::fclose(faces_);
+        faces_ = nullptr;
+        std::remove(faces_path_.c_str());
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+        std::remove(path_.c_str());
+    }
+    welded_.clear();
+}
+
+void MeshWriter::close() {
+    if (!file_) {
+        return;
+    }
+
+    if (format_ == MeshFormat::Stl) {
+        const uint32_t count = static_cast<uint32_t>(triangle_count_);
+        std::fseek(file_, 80, SEEK_SET);
+        write_or_throw(file_, &count, sizeof(count), path_);
+    } else {
+        std::rewind(faces_);
+        std::vector<uint8_t> buf(1 << 20);
+        size_t n = 0;
+        while ((n = std::fread(buf.data(), 1, buf.size(), faces_)) > 0) {
+            write_or_throw(file_, buf.data(), n, path_);
+        }
+        std::fclose(faces_);
+        faces_ = nullptr;
+        std::remove(faces_path_.c_str());
+
+        std::fseek(file_, 0, SEEK_SET);
+        write_ply_header();
+    }
+
+    if (std::fclose(file_) != 0) {
+        file_ = nullptr;
+        throw std::runtime_error("Failed to close mesh file: " + path_);
+    }
+    file_ = nullptr;
+}
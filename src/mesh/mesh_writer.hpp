@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+enum class MeshFormat { Stl, Ply };
+
+// Streams indexed triangle chunks to a binary STL or PLY file. Chunks are written as soon as
+// they are appended, so only the chunk being appended and the index of the shared (welded)
+// vertices not yet released by forget_welds_below() are held in memory. Element counts are
+// patched into the header on close(). append() may be called from several threads.
+//
+// Both formats count in 32 bits (STL triangles, PLY vertex indices); append() throws rather
+// than write a file whose counts have wrapped.
+class MeshWriter {
+public:
+    static constexpr uint64_t kNoWeld = ~uint64_t{0};
+
+    ~MeshWriter();
+
+    void open(const std::string &path, MeshFormat format);
+
+    // weld_keys has one entry per vertex. A vertex whose key is not kNoWeld is written by the
+    // first chunk that appends the key; later chunks with the same key index that vertex, so
+    // chunks that share a border share its vertices in the PLY output. STL has no shared
+    // vertices and ignores the keys.
+    void append(const std::vector<glm::vec3> &vertices,
+                const std::vector<uint64_t> &weld_keys,
+                const std::vector<uint32_t> &indices);
+    // Promises that no weld key below `key` is appended again and drops those keys from the
+    // index, which otherwise grows with every seam of the mesh.
+    void forget_welds_below(uint64_t key);
+    void close();
+    // Closes and deletes the partly written file, e.g. after a failed or cancelled export.
+    void discard();
+
+    uint64_t vertex_count() const { return vertex_count_; }
+    uint64_t triangle_count() const { return triangle_count_; }
+
+private:
+    void write_ply_header();
+
+    std::mutex mutex_;
+
+    MeshFormat format_ = MeshFormat::Stl;
+    std::string path_;
+    std::string faces_path_;
+
+    std::FILE *file_ = nullptr;
+    std::FILE *faces_ = nullptr; // PLY only: faces are spooled here and appended on close()
+
+    uint64_t vertex_count_ = 0;
+    uint64_t triangle_count_ = 0;
+
+    // PLY only: global vertex index of every weld key written and not yet forgotten. Ordered,
+    // so forget_welds_below() erases a prefix.
+    std::map<uint64_t, uint32_t> welded_;
+    std::vector<uint32_t> remap_; // chunk vertex -> global vertex, reused across append() calls
+    std::vector<glm::vec3> new_vertices_;
+};
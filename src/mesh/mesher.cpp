@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mesh/mesher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "util/thread_pool.hpp"
+
+namespace {
+
+constexpr int32_t kNoVertex = -1;
+
+// A block is skipped when its centre is farther from the surface than kCullSafety times its
+// bounding radius. Fractal estimators are not exact bounds, so leave a generous margin.
+constexpr float kCullSafety = 2.0f;
+constexpr int kLeafBlock = 4;
+
+struct Grid {
+    glm::vec3 origin{};
+    float h = 0.0f;
+    glm::ivec3 cells{}; // grid points are [0, cells]
+    float iso = 0.0f;
+};
+
+// Per-thread working set for one tile. Everything is indexed relative to the tile origin
+// minus one, because the cells on the low side of the tile's edges belong to the neighbour.
+//
+// The grids are sized once per thread. An entry is only valid when its stamp equals the
+// current tile's generation, so starting a tile costs nothing however few of its blocks
+// survive the cull.
+struct TileScratch {
+    int dim = 0; // tile_size + 2 grid points per axis
+    glm::ivec3 base{};
+    uint32_t generation = 0;
+
+    std::vector<float> samples;
+    std::vector<uint32_t> sample_stamp;
+    std::vector<int32_t> cell_vertex;
+    std::vector<uint32_t> vertex_stamp;
+    std::vector<uint32_t> scan_stamp; // == generation: the cell's block survived the cull
+
+    std::vector<glm::vec3> vertices;
+    std::vector<uint64_t> weld_keys; // per vertex, see MeshWriter::append()
+    std::vector<uint32_t> indices;
+
+    void init(int tile_size) {
+        dim = tile_size + 2;
+        const size_t pts = static_cast<size_t>(dim) * dim * dim;
+        const size_t cells = static_cast<size_t>(dim - 1) * (dim - 1) * (dim - 1);
+        samples.resize(pts);
+        sample_stamp.assign(pts, 0);
+        cell_vertex.resize(cells);
+        vertex_stamp.assign(cells, 0);
+        scan_stamp.assign(cells, 0);
+        generation = 0;
+    }
+
+    void begin_tile(glm::ivec3 tile_origin) {
+        base = tile_origin - glm::ivec3(1);
+        if (++generation == 0) {
+            // Wrapped: stamps of 4 billion tiles ago would look current again.
+            std::fill(sample_stamp.begin(), sample_stamp.end(), 0);
+            std::fill(vertex_stamp.begin(), vertex_stamp.end(), 0);
+            std::fill(scan_stamp.begin(), scan_stamp.end(), 0);
+            generation = 1;
+        }
+        vertices.clear();
+        weld_keys.clear();
+        indices.clear();
+    }
+
+    size_t point_index(glm::ivec3 g) const {
+        const glm::ivec3 l = g - base;
+        return (static_cast<size_t>(l.z) * dim + l.y) * dim + l.x;
+    }
+
+    size_t cell_index(glm::ivec3 c) const {
+        const glm::ivec3 l = c - base;
+        return (static_cast<size_t>(l.z) * (dim - 1) + l.y) * (dim - 1) + l.x;
+    }
+};
+
+class TileMesher {
+public:
+    TileMesher(const FieldParams &field, const Grid &grid, TileScratch &s) : field_(field), grid_(grid), s_(s) {}
+
+    void run(glm::ivec3 lo, glm::ivec3 hi) {
+        lo_ = lo;
+        hi_ = hi;
+        cull(lo, hi);
+
+        for (int k = lo.z; k < hi.z; k++) {
+            for (int j = lo.y; j < hi.y; j++) {
+                for (int i = lo.x; i < hi.x; i++) {
+                    if (s_.scan_stamp[s_.cell_index({i, j, k})] == s_.generation) {
+                        emit_edges({i, j, k});
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    glm::vec3 position(glm::vec3 g) const { return grid_.origin + g * grid_.h; }
+
+    float sample(glm::ivec3 g) {
+        const size_t idx = s_.point_index(g);
+        float &v = s_.samples[idx];
+        if (s_.sample_stamp[idx] != s_.generation) {
+            s_.sample_stamp[idx] = s_.generation;
+            const bool boundary = glm::any(glm::equal(g, glm::ivec3(0))) || glm::any(glm::equal(g, grid_.cells));
+            if (boundary) {
+                v = grid_.h; // force outside so the mesh closes at the domain boundary
+            } else {
+                v = field_distance(field_, position(glm::vec3(g))) - grid_.iso;
+                if (std::isnan(v)) {
+                    v = grid_.h;
+                }
+            }
+        }
+        return v;
+    }
+
+    // Marks leaf blocks that may contain the surface.
+    void cull(glm::ivec3 lo, glm::ivec3 hi) {
+        const glm::ivec3 size = hi - lo;
+        if (size.x <= 0 || size.y <= 0 || size.z <= 0) {
+            return;
+        }
+
+        const glm::vec3 centre = position(glm::vec3(lo + hi) * 0.5f);
+        const float radius = 0.5f * glm::length(glm::vec3(size)) * grid_.h;
+        const float d = field_distance(field_, centre) - grid_.iso;
+        if (!std::isnan(d) && std::abs(d) > kCullSafety * radius) {
+            return;
+        }
+
+        if (glm::all(glm::lessThanEqual(size, glm::ivec3(kLeafBlock)))) {
+            for (int k = lo.z; k < hi.z; k++) {
+                for (int j = lo.y; j < hi.y; j++) {
+                    for (int i = lo.x; i < hi.x; i++) {
+                        s_.scan_stamp[s_.cell_index({i, j, k})] = s_.generation;
+                    }
+                }
+            }
+            return;
+        }
+
+        const glm::ivec3 mid = lo + glm::max(size / 2, glm::ivec3(1));
+        for (int oct = 0; oct < 8; oct++) {
+            const glm::ivec3 a{(oct & 1) ? mid.x : lo.x, (oct & 2) ? mid.y : lo.y, (oct & 4) ? mid.z : lo.z};
+            const glm::ivec3 b{(oct & 1) ? hi.x : mid.x, (oct & 2) ? hi.y : mid.y, (oct & 4) ? hi.z : mid.z};
+            cull(a, b);
+        }
+    }
+
+    glm::vec3 gradient(glm::vec3 p) const {
+        const float e = std::max(grid_.h * 0.1f, 1e-6f);
+        const glm::vec2 k{1.0f, -1.0f};
+        const glm::vec3 kxyy{k.x, k.y, k.y};
+        const glm::vec3 kyyx{k.y, k.y, k.x};
+        const glm::vec3 kyxy{k.y, k.x, k.y};
+        const glm::vec3 kxxx{k.x, k.x, k.x};
+        const glm::vec3 n = kxyy * field_distance(field_, p + kxyy * e) + kyyx * field_distance(field_, p + kyyx * e) +
+                            kyxy * field_distance(field_, p + kyxy * e) + kxxx * field_distance(field_, p + kxxx * e);
+        const float len = glm::length(n);
+        return (len > 0.0f) ? n / len : glm::vec3(0.0f);
+    }
+
+    // Dual contouring vertex of a cell: minimiser of the QEF built from the edge crossings and
+    // their normals, regularised towards the mass point and clamped to the cell.
+    int32_t vertex(glm::ivec3 c) {
+        const size_t idx = s_.cell_index(c);
+        int32_t &slot = s_.cell_vertex[idx];
+        if (s_.vertex_stamp[idx] == s_.generation) {
+            return slot;
+        }
+        s_.vertex_stamp[idx] = s_.generation;
+
+        float f[8];
+        for (int n = 0; n < 8; n++) {
+            f[n] = sample(c + glm::ivec3(n & 1, (n >> 1) & 1, (n >> 2) & 1));
+        }
+
+        static constexpr int kEdges[12][2] = {
+            {0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+        glm::mat3 ata(0.0f);
+        glm::vec3 atb(0.0f);
+        glm::vec3 mass(0.0f);
+        int count = 0;
+
+        for (const auto &e : kEdges) {
+            const float fa = f[e[0]];
+            const float fb = f[e[1]];
+            if ((fa < 0.0f) == (fb < 0.0f)) {
+                continue;
+            }
+            const glm::vec3 ga = glm::vec3(c + glm::ivec3(e[0] & 1, (e[0] >> 1) & 1, (e[0] >> 2) & 1));
+            const glm::vec3 gb = glm::vec3(c + glm::ivec3(e[1] & 1, (e[1] >> 1) & 1, (e[1] >> 2) & 1));
+            const float t = std::clamp(fa / (fa - fb), 0.0f, 1.0f);
+            const glm::vec3 p = position(glm::mix(ga, gb, t));
+            const glm::vec3 n = gradient(p);
+
+            ata += glm::outerProduct(n, n);
+            atb += n * glm::dot(n, p);
+            mass += p;
+            count++;
+        }
+
+        if (count == 0) {
+            slot = kNoVertex;
+            return slot;
+        }
+
+        mass /= static_cast<float>(count);
+
+        constexpr float lambda = 0.05f;
+        const glm::mat3 a = ata + glm::mat3(lambda);
+        const glm::vec3 b = atb + lambda * mass;
+
+        glm::vec3 x = mass;
+        if (std::abs(glm::determinant(a)) > 1e-12f) {
+            x = glm::inverse(a) * b;
+        }
+
+        const glm::vec3 cmin = position(glm::vec3(c));
+        const glm::vec3 cmax = cmin + glm::vec3(grid_.h);
+        if (!glm::all(glm::greaterThanEqual(x, cmin)) || !glm::all(glm::lessThanEqual(x, cmax))) {
+            x = mass;
+        }
+
+        slot = static_cast<int32_t>(s_.vertices.size());
+        s_.vertices.push_back(x);
+        s_.weld_keys.push_back(weld_key(c));
+        return slot;
+    }
+
+    // Cells in the outer layer of the tile's range are also used by a neighbouring tile, which
+    // computes the identical vertex; key those by their global cell so the writer shares them.
+    uint64_t weld_key(glm::ivec3 c) const {
+        const bool seam = glm::any(glm::lessThan(c, lo_)) || glm::any(glm::greaterThanEqual(c, hi_ - glm::ivec3(1)));
+        if (!seam) {
+            return MeshWriter::kNoWeld;
+        }
+        const auto nx = static_cast<uint64_t>(grid_.cells.x);
+        const auto ny = static_cast<uint64_t>(grid_.cells.y);
+        return (static_cast<uint64_t>(c.z) * ny + static_cast<uint64_t>(c.y)) * nx + static_cast<uint64_t>(c.x);
+    }
+
+    void emit_quad(glm::ivec3 c0, glm::ivec3 c1, glm::ivec3 c2, glm::ivec3 c3, bool flip) {
+        const int32_t vi[4] = {vertex(c0), vertex(c1), vertex(c2), vertex(c3)};
+        if (vi[0] < 0 || vi[1] < 0 || vi[2] < 0 || vi[3] < 0) {
+            return; // only possible with a non-finite field; leave the hole rather than guess
+        }
+
+        uint32_t v[4];
+        for (int n = 0; n < 4; n++) {
+            v[n] = static_cast<uint32_t>(vi[n]);
+        }
+
+        auto &out = s_.indices;
+        if (!flip) {
+            out.insert(out.end(), {v[0], v[1], v[2], v[0], v[2], v[3]});
+        } else {
+            out.insert(out.end(), {v[0], v[2], v[1], v[0], v[3], v[2]});
+        }
+    }
+
+    // Emits the quads of the three edges leaving the cell's minimum corner. Each interior edge
+    // has exactly one such owner, so no quad is emitted twice across tiles.
+    void emit_edges(glm::ivec3 g) {
+        const float f0 = sample(g);
+        const bool inside = f0 < 0.0f;
+
+        // Quads are wound counter-clockwise around the +axis; flip when the outside is at the low end.
+        if (g.y > 0 && g.z > 0 && (sample(g + glm::ivec3(1, 0, 0)) < 0.0f) != inside) {
+            const int i = g.x, j = g.y, k = g.z;
+            emit_quad({i, j - 1, k - 1}, {i, j, k - 1}, {i, j, k}, {i, j - 1, k}, !inside);
+        }
+        if (g.x > 0 && g.z > 0 && (sample(g + glm::ivec3(0, 1, 0)) < 0.0f) != inside) {
+            const int i = g.x, j = g.y, k = g.z;
+            emit_quad({i - 1, j, k - 1}, {i - 1, j, k}, {i, j, k}, {i, j, k - 1}, !inside);
+        }
+        if (g.x > 0 && g.y > 0 && (sample(g + glm::ivec3(0, 0, 1)) < 0.0f) != inside) {
+            const int i = g.x, j = g.y, k = g.z;
+            emit_quad({i - 1, j - 1, k}, {i, j - 1, k}, {i, j, k}, {i - 1, j, k}, !inside);
+        }
+    }
+
+    const FieldParams &field_;
+    const Grid &grid_;
+    TileScratch &s_;
+    glm::ivec3 lo_{};
+    glm::ivec3 hi_{};
+};
+
+} // namespace
+
+MeshStats extract_mesh(const FieldParams &field, const MeshOptions &opts, MeshProgress *progress) {
+    const auto t0 = std::chrono::steady_clock::now();
+
+    const glm::vec3 extent = opts.bounds_max - opts.bounds_min;
+    const float longest = std::max(extent.x, std::max(extent.y, extent.z));
+    if (!(longest > 0.0f) || opts.resolution < 2 || opts.tile_size < 2) {
+        throw std::runtime_error("extract_mesh: invalid bounds or resolution");
+    }
+
+    Grid grid;
+    grid.origin = opts.bounds_min;
+    grid.h = longest / static_cast<float>(opts.resolution);
+    grid.cells = glm::max(glm::ivec3(glm::ceil(extent / grid.h)), glm::ivec3(2));
+    grid.iso = (opts.iso > 0.0f) ? opts.iso : 0.5f * grid.h;
+
+    const int ts = static_cast<int>(opts.tile_size);
+    const glm::ivec3 tiles = (grid.cells + glm::ivec3(ts - 1)) / ts;
+    const uint32_t tile_count = static_cast<uint32_t>(tiles.x) * tiles.y * tiles.z;
+
+    if (progress) {
+        progress->tiles_total = tile_count;
+        progress->tiles_done = 0;
+    }
+
+    MeshWriter writer;
+    writer.open(opts.path, opts.format);
+
+    ThreadPool pool;
+    std::vector<TileScratch> scratch(pool.thread_count());
+    for (TileScratch &s : scratch) {
+        s.init(ts);
+    }
+    std::atomic<uint32_t> skipped{0};
+
+    // Tiles are handed out in index order, so layers of tiles along z complete roughly in order.
+    // Once layers [0, layers_complete) are all written, no later tile can reference their seam
+    // cells below the next layer's lower seam, and the writer forgets their weld keys.
+    const uint32_t tiles_per_layer = static_cast<uint32_t>(tiles.x) * tiles.y;
+    std::mutex layers_mutex;
+    std::vector<uint32_t> layer_tiles_done(static_cast<size_t>(tiles.z), 0);
+    int layers_complete = 0;
+
+    // failed lets the other tiles stop early without taking the lock; the exception itself is
+    // only touched under error_mutex.
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    pool.parallel_for(tile_count, [&](uint32_t t, uint32_t thread_index) {
+        if ((progress && progress->cancel) || failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const glm::ivec3 tc{static_cast<int>(t % tiles.x),
+                            static_cast<int>((t / tiles.x) % tiles.y),
+                            static_cast<int>(t / tiles_per_layer)};
+        const glm::ivec3 lo = tc * ts;
+        const glm::ivec3 hi = glm::min(lo + glm::ivec3(ts), grid.cells);
+
+        TileScratch &s = scratch[thread_index];
+        s.begin_tile(lo);
+
+        try {
+            TileMesher(field, grid, s).run(lo, hi);
+
+            if (s.indices.empty()) {
+                skipped++;
+            } else {
+                writer.append(s.vertices, s.weld_keys, s.indices);
+            }
+
+            std::lock_guard<std::mutex> lock(layers_mutex);
+            const int first = layers_complete;
+            layer_tiles_done[static_cast<size_t>(tc.z)]++;
+            while (layers_complete < tiles.z &&
+                   layer_tiles_done[static_cast<size_t>(layers_complete)] == tiles_per_layer) {
+                layers_complete++;
+            }
+            if (layers_complete != first && layers_complete < tiles.z) {
+                // Cells up to z = layers_complete * ts - 2 are only used by completed layers;
+                // weld keys are z-major, so they are exactly the keys below the next z slice.
+                const auto z = static_cast<uint64_t>(layers_complete * ts - 1);
+                writer.forget_welds_below(z * static_cast<uint64_t>(grid.cells.y) *
+                                          static_cast<uint64_t>(grid.cells.x));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+
+        if (progress) {
+            progress->tiles_done++;
+        }
+    });
+
+    // parallel_for has joined every worker, so the exception is no longer written concurrently.
+    // Neither a failed nor a cancelled export leaves a partial file behind.
+    if (failed) {
+        writer.discard();
+        std::rethrow_exception(error);
+    }
+
+    if (progress && progress->cancel) {
+        writer.discard();
+    } else {
+        writer.close();
+    }
+
+    MeshStats stats;
+    stats.vertices = writer.vertex_count();
+    stats.triangles = writer.triangle_count();
+    stats.tiles_skipped = skipped;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return stats;
+}
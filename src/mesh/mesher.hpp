@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "mesh/field_cpu.hpp"
+#include "mesh/mesh_writer.hpp"
+
+struct MeshOptions {
+    glm::vec3 bounds_min{-1.5f};
+    glm::vec3 bounds_max{1.5f};
+
+    uint32_t resolution = 512; // cells along the longest axis
+    uint32_t tile_size = 64;   // cells per tile edge; bounds the per-thread working set
+
+    // Iso level of the extracted surface. Mandelbox-style estimators never go negative, so the
+    // surface is taken at a small positive distance. 0 = half a cell.
+    float iso = 0.0f;
+
+    std::string path = "fractal.stl";
+    MeshFormat format = MeshFormat::Stl;
+};
+
+struct MeshProgress {
+    std::atomic<uint32_t> tiles_done{0};
+    std::atomic<uint32_t> tiles_total{0};
+    std::atomic<bool> cancel{false};
+};
+
+struct MeshStats {
+    uint64_t vertices = 0;
+    uint64_t triangles = 0;
+    uint32_t tiles_skipped = 0;
+    double seconds = 0.0;
+};
+
+// Extracts the iso surface of the field with dual contouring and streams it to opts.path.
+//
+// The grid is split into tiles that are meshed independently on a thread pool. Each thread
+// holds O(tile_size^3) of scratch; the only state shared across tiles is the index of welded
+// seam vertices, which is dropped one layer of tiles at a time once every tile that can use it
+// is written, so it spans about two layers of tiles (O(resolution^2) cells, of which only
+// those on the surface hold a vertex) rather than the whole grid. Inside a tile an octree of blocks is
+// culled with the distance estimator itself: a block whose centre is farther from the surface
+// than its bounding radius cannot contain the surface and is never sampled. Vertices on tile
+// seams are computed from the same global grid samples by both tiles, so the seams close
+// exactly, and are written once and shared by both tiles in indexed formats. Grid samples on
+// the domain boundary are forced outside so the mesh is watertight.
+MeshStats extract_mesh(const FieldParams &field, const MeshOptions &opts, MeshProgress *progress = nullptr);
@@ -4,6 +4,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <stdexcept>
 #include <string>
@@ -26,3 +30,30 @@ std::vector<std::uint8_t> read_file_binary(const std::string &path) {
     }
     return data;
 }
+
+std::string shader_dir_from_exe() {
+    std::vector<char> buf(4096);
+    ssize_t n = readlink("/proc/self/exe", buf.data(), buf.size() - 1);
+    if (n > 0) {
+        buf[n] = '\0';
+        std::filesystem::path exe_path(buf.data());
+        return (exe_path.parent_path() / "shaders").string();
+    }
+    return (std::filesystem::current_path() / "shaders").string();
+}
+
+std::string user_cache_dir() {
+    std::filesystem::path dir;
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        dir = xdg;
+    } else if (const char *home = std::getenv("HOME"); home && *home) {
+        dir = std::filesystem::path(home) / ".cache";
+    } else {
+        return {};
+    }
+    dir /= "vk-fractal";
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return ec ? std::string{} : dir.string();
+}
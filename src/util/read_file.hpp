@@ -10,3 +10,10 @@
 #include <vector>
 
 std::vector<std::uint8_t> read_file_binary(const std::string &path);
+
+// Directory with the compiled shaders: "shaders" next to the executable.
+std::string shader_dir_from_exe();
+
+// Per-user cache directory ($XDG_CACHE_HOME/vk-fractal or ~/.cache/vk-fractal), created on
+// demand. Empty when there is no home directory or it cannot be created.
+std::string user_cache_dir();
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "util/shader_bundle.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+uint64_t fnv1a64(const void *data, size_t size, uint64_t seed) {
+    const auto *p = static_cast<const uint8_t *>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void ShaderBundle::open(const std::string &path) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open shader bundle: " + path);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BundleHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Shader bundle too small: " + path);
+    }
+    const auto size = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shader bundle: " + path);
+    }
+
+    path_ = path;
+    data_ = static_cast<const uint8_t *>(map);
+    size_ = size;
+
+    const auto *hdr = reinterpret_cast<const BundleHeader *>(data_);
+    const size_t index_end = sizeof(BundleHeader) + static_cast<size_t>(hdr->count) * sizeof(BundleEntry);
+    if (hdr->magic != kBundleMagic || hdr->version != kBundleVersion || index_end > size_) {
+        close();
+        throw std::runtime_error("Not a shader bundle (or built by another version): " + path);
+    }
+
+    const auto *entries = reinterpret_cast<const BundleEntry *>(data_ + sizeof(BundleHeader));
+    entries_.reserve(hdr->count);
+    for (uint32_t i = 0; i < hdr->count; i++) {
+        const BundleEntry &e = entries[i];
+        if (e.offset % 4 != 0 || e.size % 4 != 0 || e.offset > size_ || e.size > size_ - e.offset ||
+            std::memchr(e.name, '\0', sizeof(e.name)) == nullptr) {
+            close();
+            throw std::runtime_error("Corrupt shader bundle index: " + path);
+        }
+        entries_.push_back(&e);
+    }
+    hash_ = hdr->hash;
+}
+
+void ShaderBundle::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    hash_ = 0;
+    entries_.clear();
+}
+
+ShaderBundle::Blob ShaderBundle::find(std::string_view name) const {
+    // The packer writes the index sorted by name.
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), name, [](const BundleEntry *e, std::string_view n) {
+        return std::string_view(e->name) < n;
+    });
+    if (it == entries_.end() || std::string_view((*it)->name) != name) {
+        throw std::runtime_error("Shader not in bundle " + path_ + ": " + std::string(name));
+    }
+
+    const BundleEntry &e = **it;
+    Blob b;
+    b.code = reinterpret_cast<const uint32_t *>(data_ + e.offset);
+    b.size = static_cast<size_t>(e.size);
+    b.hash = e.hash;
+    return b;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Packed SPIR-V shaders, written at build time by tools/pack_shaders.cpp.
+//
+// Layout: BundleHeader, `count` BundleEntry records sorted by name, then the SPIR-V blobs at
+// 16-byte aligned offsets. The file is memory-mapped and the blobs are handed to
+// vkCreateShaderModule in place.
+
+constexpr uint32_t kBundleMagic = 0x42535646; // "FVSB"
+constexpr uint32_t kBundleVersion = 1;
+
+struct BundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t pad0;
+    uint64_t hash; // fnv1a64 over the entry hashes in index order
+};
+
+struct BundleEntry {
+    char name[48]; // NUL-terminated file name, e.g. "fullscreen.vert.spv"
+    uint64_t offset;
+    uint64_t size; // bytes, a multiple of 4
+    uint64_t hash; // fnv1a64 of the blob
+};
+static_assert(sizeof(BundleHeader) == 24 && sizeof(BundleEntry) == 72);
+
+uint64_t fnv1a64(const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+class ShaderBundle {
+public:
+    struct Blob {
+        const uint32_t *code = nullptr;
+        size_t size = 0; // bytes
+        uint64_t hash = 0;
+    };
+
+    ShaderBundle() = default;
+    ShaderBundle(const ShaderBundle &) = delete;
+    ShaderBundle &operator=(const ShaderBundle &) = delete;
+    ~ShaderBundle() { close(); }
+
+    // Maps the bundle and validates its index; throws on a missing or malformed file.
+    void open(const std::string &path);
+    void close();
+    bool is_open() const { return data_ != nullptr; }
+
+    // Throws when the bundle has no shader `name`.
+    Blob find(std::string_view name) const;
+
+    uint32_t count() const { return static_cast<uint32_t>(entries_.size()); }
+    size_t size_bytes() const { return size_; }
+    // Changes whenever any shader in the bundle changes.
+    uint64_t hash() const { return hash_; }
+
+private:
+    std::string path_;
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t hash_ = 0;
+    std::vector<const BundleEntry *> entries_;
+};
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "util/thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t worker_count) {
+    if (worker_count == 0) {
+        const uint32_t hw = std::max(std::thread::hardware_concurrency(), 1u);
+        worker_count = hw - 1;
+    }
+
+    workers_.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; i++) {
+        workers_.emplace_back([this, i] { worker_main(i + 1); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &w : workers_) {
+        w.join();
+    }
+}
+
+void ThreadPool::run_items(uint32_t thread_index,
+                           const std::function<void(uint32_t, uint32_t)> &job,
+                           uint32_t count) {
+    for (;;) {
+        const uint32_t i = next_index_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count) {
+            break;
+        }
+        job(i, thread_index);
+    }
+}
+
+void ThreadPool::worker_main(uint32_t thread_index) {
+    uint64_t seen_generation = 0;
+
+    for (;;) {
+        const std::function<void(uint32_t, uint32_t)> *job = nullptr;
+        uint32_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || job_generation_ != seen_generation; });
+            if (stop_) {
+                return;
+            }
+            seen_generation = job_generation_;
+            if (!job_) {
+                // Woke up after the job had already finished; nothing to do until the next one.
+                continue;
+            }
+            job = job_;
+            count = job_count_;
+            busy_workers_++;
+        }
+
+        run_items(thread_index, *job, count);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_workers_--;
+        }
+        done_.notify_one();
+    }
+}
+
+void ThreadPool::parallel_for(uint32_t count, const std::function<void(uint32_t, uint32_t)> &fn) {
+    if (count == 0) {
+        return;
+    }
+    if (workers_.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        job_count_ = count;
+        next_index_.store(0, std::memory_order_relaxed);
+        job_generation_++;
+    }
+    wake_.notify_all();
+
+    run_items(0, fn, count);
+
+    // A worker that joins the job before job_ is cleared below is counted in busy_workers_, so
+    // waiting for it to drain is enough to know fn is no longer referenced. Workers that wake up
+    // later see no job and go back to sleep.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_workers_ == 0 && next_index_.load() >= count; });
+    job_ = nullptr;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that execute index ranges. parallel_for() blocks the calling
+// thread until every index has been processed; the caller participates in the work.
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t worker_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of threads that may run fn concurrently (workers + caller).
+    uint32_t thread_count() const { return static_cast<uint32_t>(workers_.size()) + 1; }
+
+    // Calls fn(index, thread_index) for every index in [0, count). thread_index is in
+    // [0, thread_count()), 0 being the calling thread.
+    void parallel_for(uint32_t count, const std::function<void(uint32_t, uint32_t)> &fn);
+
+private:
+    void worker_main(uint32_t thread_index);
+    void run_items(uint32_t thread_index, const std::function<void(uint32_t, uint32_t)> &job, uint32_t count);
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // Only accessed under mutex_; workers take a copy when they join a job.
+    const std::function<void(uint32_t, uint32_t)> *job_ = nullptr; // null between jobs
+    uint32_t job_count_ = 0;
+    uint64_t job_generation_ = 0;
+    uint32_t busy_workers_ = 0;
+    bool stop_ = false;
+
+    std::atomic<uint32_t> next_index_{0};
+};
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer. The producer always has a back
+// buffer to write into and the consumer always has a consistent front buffer to read; the
+// third buffer is exchanged atomically between them, so neither side ever waits.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer: fill back() and publish() it.
+    T &back() { return buffers_[back_]; }
+    void publish() { back_ = state_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+
+    // Consumer: pick up the most recent published buffer if there is one. Returns false when
+    // nothing new was published since the last call; front() stays valid either way.
+    bool update() {
+        if ((state_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        front_ = state_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T &front() const { return buffers_[front_]; }
+
+    // Not thread safe: only for initialisation before both sides start.
+    void fill(const T &v) {
+        for (auto &b : buffers_) {
+            b = v;
+        }
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T buffers_[3]{};
+    std::atomic<uint8_t> state_{1}; // index of the shared buffer + kFresh when unread
+    uint8_t back_ = 0;
+    uint8_t front_ = 2;
+};
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Saves a camera path, loads it back and checks that every key survived bit for bit.
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "app/camera_path.hpp"
+
+namespace {
+
+bool same_frame(const SimFrame &a, const SimFrame &b) {
+    return a.position == b.position && a.orientation == b.orientation && a.julia_c == b.julia_c &&
+           a.julia_mask == b.julia_mask;
+}
+
+} // namespace
+
+int main() {
+    const std::string file = (std::filesystem::temp_directory_path() / "vk_fractal_camera_path_test.bin").string();
+    int failures = 0;
+    try {
+        CameraPath saved;
+        for (int i = 0; i < 5; ++i) {
+            SimFrame f;
+            f.position = glm::vec3(0.5f * i, -1.25f, 3.0f + i);
+            f.orientation = glm::angleAxis(0.3f * i, glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f)));
+            f.julia_c = glm::vec3(-0.2f, 0.6f * i, 0.1f);
+            f.julia_mask = static_cast<uint32_t>(i) & 7u;
+            saved.record(i / 30.0, f);
+        }
+        saved.save(file);
+
+        CameraPath loaded;
+        loaded.load(file);
+        if (loaded.size() != saved.size() || loaded.duration() != saved.duration()) {
+            std::cerr << "camera path: " << loaded.size() << " keys loaded, " << saved.size() << " saved\n";
+            ++failures;
+        } else {
+            for (size_t i = 0; i < saved.size(); ++i) {
+                const double t = i / 30.0;
+                if (!same_frame(saved.sample(t), loaded.sample(t))) {
+                    std::cerr << "camera path: key " << i << " differs after the round trip\n";
+                    ++failures;
+                }
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "camera path: " << e.what() << "\n";
+        ++failures;
+    }
+    std::remove(file.c_str());
+    return failures == 0 ? 0 : 1;
+}
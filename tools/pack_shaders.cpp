@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Maciej Torhan <https://github.com/m-torhan>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Build-time tool: packs SPIR-V files into one shader bundle (src/util/shader_bundle.hpp).
+//
+//   pack_shaders OUT.bundle IN.spv...
+//
+// Shaders are indexed by file name.
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/read_file.hpp"
+#include "util/shader_bundle.hpp"
+
+namespace {
+
+constexpr size_t kBlobAlign = 16;
+
+struct Input {
+    std::string name;
+    std::vector<uint8_t> code;
+};
+
+std::vector<uint8_t> pack(std::vector<Input> &inputs) {
+    std::sort(inputs.begin(), inputs.end(), [](const Input &a, const Input &b) { return a.name < b.name; });
+
+    BundleHeader hdr{};
+    hdr.magic = kBundleMagic;
+    hdr.version = kBundleVersion;
+    hdr.count = static_cast<uint32_t>(inputs.size());
+    hdr.hash = fnv1a64(nullptr, 0);
+
+    std::vector<BundleEntry> entries(inputs.size());
+    size_t offset = sizeof(BundleHeader) + entries.size() * sizeof(BundleEntry);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const Input &in = inputs[i];
+        if (in.name.size() >= sizeof(entries[i].name)) {
+            throw std::runtime_error("Shader file name too long for the bundle index: " + in.name);
+        }
+        if (i > 0 && in.name == inputs[i - 1].name) {
+            throw std::runtime_error("Duplicate shader name: " + in.name);
+        }
+        if (in.code.empty() || in.code.size() % 4 != 0) {
+            throw std::runtime_error("Not a SPIR-V module: " + in.name);
+        }
+
+        offset = (offset + kBlobAlign - 1) / kBlobAlign * kBlobAlign;
+        BundleEntry &e = entries[i];
+        std::memcpy(e.name, in.name.c_str(), in.name.size() + 1);
+        e.offset = offset;
+        e.size = in.code.size();
+        e.hash = fnv1a64(in.code.data(), in.code.size());
+        hdr.hash = fnv1a64(&e.hash, sizeof(e.hash), hdr.hash);
+        offset += in.code.size();
+    }
+
+    std::vector<uint8_t> out(offset, 0);
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    std::memcpy(out.data() + sizeof(hdr), entries.data(), entries.size() * sizeof(BundleEntry));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::memcpy(out.data() + entries[i].offset, inputs[i].code.data(), inputs[i].code.size());
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: pack_shaders OUT.bundle IN.spv...\n";
+        return 2;
+    }
+
+    try {
+        const std::filesystem::path out_path = argv[1];
+
+        std::vector<Input> inputs;
+        for (int i = 2; i < argc; i++) {
+            const std::filesystem::path p = argv[i];
+            inputs.push_back({p.filename().string(), read_file_binary(p.string())});
+        }
+        const std::vector<uint8_t> bundle = pack(inputs);
+
+        const std::filesystem::path tmp = out_path.string() + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            f.write(reinterpret_cast<const char *>(bundle.data()), static_cast<std::streamsize>(bundle.size()));
+            if (!f) {
+                throw std::runtime_error("Failed to write " + tmp.string());
+            }
+        }
+        std::filesystem::rename(tmp, out_path);
+    } catch (const std::exception &e) {
+        std::cerr << "pack_shaders: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}